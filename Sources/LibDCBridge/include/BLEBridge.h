@@ -52,9 +52,10 @@ void freeBLEObject(ble_object_t* obj);
 dc_status_t ble_set_timeout(ble_object_t *io, int timeout);
 dc_status_t ble_ioctl(ble_object_t *io, unsigned int request, void *data, size_t size);
 dc_status_t ble_sleep(ble_object_t *io, unsigned int milliseconds);
-dc_status_t ble_read(ble_object_t *io, void *data, size_t size, size_t *actual);
 dc_status_t ble_write(ble_object_t *io, const void *data, size_t size, size_t *actual);
 dc_status_t ble_close(ble_object_t *io);
+size_t ble_get_mtu(ble_object_t *io);
+bool ble_run_events(ble_object_t *io, unsigned int milliseconds);
 
 // BLE setup functions
 void initializeBLEManager(void);
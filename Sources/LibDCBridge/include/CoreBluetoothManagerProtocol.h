@@ -10,7 +10,7 @@
 - (BOOL)discoverServices;
 - (BOOL)enableNotifications;
 - (BOOL)writeData:(NSData *)data;
-- (NSData *)readDataPartial:(int)requested;
+- (NSInteger)maximumWriteLength;
 - (void)close;
 @end
 
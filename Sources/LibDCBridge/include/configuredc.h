@@ -13,6 +13,7 @@
 #include <libdivecomputer/device.h>
 #include <libdivecomputer/parser.h>
 #include <libdivecomputer/iterator.h>
+#include <libdivecomputer/fingerprint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -43,15 +44,39 @@ typedef struct {
     // fingerprints
     unsigned char *fingerprint;  
     unsigned int fsize;         
+    dc_fingerprint_store_t *fingerprint_store;  // Store keyed by family, model and serial (preferred)
     void *fingerprint_context;  // Context to pass to lookup function
     unsigned char *(*lookup_fingerprint)(void *context, const char *device_type, const char *serial, size_t *size);
     
+    // per device state, restored once the serial number is known
+    void *devinfo_context;      // Context to pass to the devinfo callback
+    void (*devinfo_callback)(void *context, dc_device_t *device, const dc_event_devinfo_t *devinfo);
+    
     // device identification
     const char *model;     // Model string (from descriptor)
     uint32_t fdeviceid;   // Device ID associated with fingerprint
     uint32_t fdiveid;     // Dive ID associated with fingerprint
 } device_data_t;
 
+/**
+ * Backend performing the actual BLE operations for a BLE iostream.
+ * Every function receives the handle passed to ble_iostream_open.
+ * Only write is mandatory, get_mtu may return 0 when the negotiated
+ * MTU is unknown. Received data is not pulled from the backend, it is
+ * pushed into the stream with ble_stream_receive. When run_events
+ * returns non-zero, it has processed pending events for up to the given
+ * time and the stream does not block on its own while waiting for data.
+ */
+typedef struct ble_backend_t {
+    dc_status_t (*set_timeout)(void *handle, int timeout);
+    dc_status_t (*ioctl)(void *handle, unsigned int request, void *data, size_t size);
+    dc_status_t (*sleep)(void *handle, unsigned int milliseconds);
+    dc_status_t (*write)(void *handle, const void *data, size_t size, size_t *actual);
+    size_t (*get_mtu)(void *handle);
+    int (*run_events)(void *handle, unsigned int milliseconds);
+    dc_status_t (*close)(void *handle);
+} ble_backend_t;
+
 typedef void (*dc_sample_callback_t)(dc_sample_type_t type, 
                                    const dc_sample_value_t *value, 
                                    void *userdata);
@@ -133,6 +158,50 @@ dc_status_t open_ble_device_with_identification(device_data_t **out_data,
     const char *name, const char *address,
     dc_family_t stored_family, unsigned int stored_model);
 
+/**
+ * Creates a BLE iostream on top of a backend
+ * @param out: Output parameter for created iostream
+ * @param context: Dive computer context
+ * @param backend: Backend performing the BLE operations
+ * @param handle: Backend specific handle, released by backend->close
+ * @return DC_STATUS_SUCCESS on success
+ * @note Writes larger than the backend MTU are split into MTU sized frames
+ */
+dc_status_t ble_iostream_open(dc_iostream_t **out, dc_context_t *context,
+    const ble_backend_t *backend, void *handle);
+
+/**
+ * Queues received data in the receive buffer of a BLE iostream
+ * @param iostream: BLE iostream created by ble_iostream_open
+ * @param data: Received notification payload
+ * @param size: Size of the payload
+ * @return DC_STATUS_SUCCESS on success, DC_STATUS_IO if the buffer is full
+ * @note Safe to call from any thread, wakes up a blocked reader
+ */
+dc_status_t ble_stream_receive(dc_iostream_t *iostream, const void *data, size_t size);
+
+/**
+ * Marks the connection of a BLE iostream as lost
+ * @param iostream: BLE iostream created by ble_iostream_open
+ * @return DC_STATUS_SUCCESS on success
+ * @note Wakes up a blocked reader, reads fail with DC_STATUS_IO once
+ *       the received data is consumed
+ */
+dc_status_t ble_stream_disconnect(dc_iostream_t *iostream);
+
+/**
+ * Queues a notification received by the CoreBluetooth manager in the
+ * stream opened by ble_packet_open, if any
+ * @param data: Received notification payload
+ * @param size: Size of the payload
+ */
+void ble_packet_received(const void *data, size_t size);
+
+/**
+ * Marks the stream opened by ble_packet_open, if any, as disconnected
+ */
+void ble_packet_disconnected(void);
+
 /*--------------------------------------------------------------------
  * Parser Functions
  *------------------------------------------------------------------*/
@@ -79,45 +79,12 @@ dc_status_t ble_ioctl(ble_object_t *io, unsigned int request, void *data, size_t
 }
 
 dc_status_t ble_sleep(ble_object_t *io, unsigned int milliseconds) {
-    [NSThread sleepForTimeInterval:milliseconds / 1000.0];
-    return DC_STATUS_SUCCESS;
-}
-
-dc_status_t ble_read(ble_object_t *io, void *buffer, size_t requested, size_t *actual)
-{
-    if (!io || !buffer || !actual) {
-        return DC_STATUS_INVALIDARGS;
-    }
-    
-    Class CoreBluetoothManagerClass = NSClassFromString(@"CoreBluetoothManager");
-    id<CoreBluetoothManagerProtocol> manager = [CoreBluetoothManagerClass shared];
-    uint8_t *outPtr = (uint8_t *)buffer;
-    size_t total = 0;
-    
-    // Keep reading until we've gathered 'requested' bytes or no more data is arriving
-    while (total < requested) {
-        size_t needed = requested - total;
-        // readDataPartial returns up to 'needed' bytes but might return fewer
-        NSData *partialData = [manager readDataPartial:(int)needed];
-        
-        // If no data arrived this iteration, break out
-        if (!partialData || partialData.length == 0) {
-            break;
-        }
-        
-        // Copy new data into our output buffer
-        memcpy(outPtr + total, partialData.bytes, partialData.length);
-        total += partialData.length;
-    }
-    
-    // If we received no data at all, treat it as an I/O error
-    if (total == 0) {
-        *actual = 0;
-        return DC_STATUS_IO;
+    if ([NSThread isMainThread]) {
+        // Keep delivering the CoreBluetooth callbacks scheduled on the main queue
+        [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:milliseconds / 1000.0]];
+    } else {
+        [NSThread sleepForTimeInterval:milliseconds / 1000.0];
     }
-    
-    // Otherwise, we successfully read some or all requested bytes
-    *actual = total;
     return DC_STATUS_SUCCESS;
 }
 
@@ -135,6 +102,23 @@ dc_status_t ble_write(ble_object_t *io, const void *data, size_t size, size_t *a
     }
 }
 
+size_t ble_get_mtu(ble_object_t *io) {
+    Class CoreBluetoothManagerClass = NSClassFromString(@"CoreBluetoothManager");
+    id<CoreBluetoothManagerProtocol> manager = [CoreBluetoothManagerClass shared];
+    NSInteger length = [manager maximumWriteLength];
+    return length > 0 ? (size_t)length : 0;
+}
+
+bool ble_run_events(ble_object_t *io, unsigned int milliseconds) {
+    // Only the main thread has to keep delivering the CoreBluetooth
+    // callbacks itself, any other thread can block until woken up.
+    if (![NSThread isMainThread]) {
+        return false;
+    }
+    [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:milliseconds / 1000.0]];
+    return true;
+}
+
 dc_status_t ble_close(ble_object_t *io) {
     Class CoreBluetoothManagerClass = NSClassFromString(@"CoreBluetoothManager");
     id<CoreBluetoothManagerProtocol> manager = [CoreBluetoothManagerClass shared];
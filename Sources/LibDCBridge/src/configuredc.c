@@ -4,23 +4,58 @@
 #include <libdivecomputer/descriptor.h>
 #include <libdivecomputer/iostream.h>
 #include <libdivecomputer/parser.h>
+#include <libdivecomputer/ble.h>
 #include "iostream-private.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+
+#define BLE_DEFAULT_MTU 20
+
+// Receive buffer capacity, must be a power of two
+#define BLE_RX_CAPACITY (64 * 1024)
+// Size of the length prefix stored in front of every notification
+#define BLE_RX_HEADER   2
+#define BLE_RX_MAXSIZE  0xFFFF
+// Slice of a wait handed to the backend event loop
+#define BLE_RX_INTERVAL 5
 
 /*--------------------------------------------------------------------
  * BLE stream structures
  *------------------------------------------------------------------*/
+typedef struct ble_rx_t {
+    pthread_mutex_t lock;
+    pthread_cond_t ready;    // Signalled whenever a notification is queued
+    size_t head;             // Total bytes ever written, indexes modulo capacity
+    size_t tail;             // Total bytes ever read
+    size_t pending;          // Unread bytes of the current notification
+    size_t available;        // Unread payload bytes, excluding length prefixes
+    int overflow;            // Notifications were dropped since the last read
+    int closed;              // The connection was closed or lost
+    unsigned char data[BLE_RX_CAPACITY];
+} ble_rx_t;
+
 typedef struct ble_stream_t {
-    dc_iostream_t base;      
-    ble_object_t *ble_object; 
+    dc_iostream_t base;
+    const ble_backend_t *backend;
+    void *handle;
+    size_t mtu;              // Maximum payload of a single BLE write
+    int timeout;             // Read timeout in milliseconds, negative blocks forever
+    ble_rx_t rx;             // Incoming notifications
 } ble_stream_t;
 
+// Stream receiving the CoreBluetooth notifications
+static pthread_mutex_t ble_active_lock = PTHREAD_MUTEX_INITIALIZER;
+static ble_stream_t *ble_active = NULL;
+
 /*--------------------------------------------------------------------
  * Forward declarations for our custom vtable
  *------------------------------------------------------------------*/
 static dc_status_t ble_stream_set_timeout   (dc_iostream_t *iostream, int timeout);
+static dc_status_t ble_stream_get_available (dc_iostream_t *iostream, size_t *value);
+static dc_status_t ble_stream_poll          (dc_iostream_t *iostream, int timeout);
 static dc_status_t ble_stream_read          (dc_iostream_t *iostream, void *data, size_t size, size_t *actual);
 static dc_status_t ble_stream_write         (dc_iostream_t *iostream, const void *data, size_t size, size_t *actual);
 static dc_status_t ble_stream_ioctl         (dc_iostream_t *iostream, unsigned int request, void *data_, size_t size_);
@@ -37,9 +72,9 @@ static const dc_iostream_vtable_t ble_iostream_vtable = {
     .set_dtr       = NULL,
     .set_rts       = NULL,
     .get_lines     = NULL,
-    .get_available = NULL,
+    .get_available = ble_stream_get_available,
     .configure     = NULL,
-    .poll          = NULL,
+    .poll          = ble_stream_poll,
     .read          = ble_stream_read,
     .write         = ble_stream_write,
     .ioctl         = ble_stream_ioctl,
@@ -50,21 +85,210 @@ static const dc_iostream_vtable_t ble_iostream_vtable = {
 };
 
 /*--------------------------------------------------------------------
- * Creates a BLE iostream instance
+ * Receive ring buffer
+ *
+ * Every notification is stored with a two byte length prefix, so reads
+ * return one notification at a time just like the other BLE transports
+ * of libdivecomputer. The head and tail counters only ever increase,
+ * their difference is the number of buffered bytes. Data is copied in
+ * and out with at most two memcpy calls and never shifted.
+ *------------------------------------------------------------------*/
+static void ble_rx_copyin(ble_rx_t *rx, const unsigned char *data, size_t size)
+{
+    size_t offset = rx->head & (BLE_RX_CAPACITY - 1);
+    size_t first = BLE_RX_CAPACITY - offset;
+    if (first > size) {
+        first = size;
+    }
+    memcpy(rx->data + offset, data, first);
+    memcpy(rx->data, data + first, size - first);
+    rx->head += size;
+}
+
+static void ble_rx_copyout(ble_rx_t *rx, unsigned char *data, size_t size)
+{
+    size_t offset = rx->tail & (BLE_RX_CAPACITY - 1);
+    size_t first = BLE_RX_CAPACITY - offset;
+    if (first > size) {
+        first = size;
+    }
+    memcpy(data, rx->data + offset, first);
+    memcpy(data + first, rx->data, size - first);
+    rx->tail += size;
+}
+
+static int ble_rx_put(ble_rx_t *rx, const unsigned char *data, size_t size)
+{
+    if (BLE_RX_HEADER + size > BLE_RX_CAPACITY - (rx->head - rx->tail)) {
+        rx->overflow = 1;
+        return 0;
+    }
+
+    unsigned char header[BLE_RX_HEADER] = {size & 0xFF, (size >> 8) & 0xFF};
+    ble_rx_copyin(rx, header, sizeof(header));
+    ble_rx_copyin(rx, data, size);
+    rx->available += size;
+
+    return 1;
+}
+
+static size_t ble_rx_get(ble_rx_t *rx, unsigned char *data, size_t size)
+{
+    if (rx->pending == 0) {
+        if (rx->head == rx->tail)
+            return 0;
+
+        unsigned char header[BLE_RX_HEADER];
+        ble_rx_copyout(rx, header, sizeof(header));
+        rx->pending = header[0] | (header[1] << 8);
+    }
+
+    // A notification larger than the buffer is returned in pieces.
+    if (size > rx->pending) {
+        size = rx->pending;
+    }
+    ble_rx_copyout(rx, data, size);
+    rx->pending -= size;
+    rx->available -= size;
+
+    return size;
+}
+
+/*--------------------------------------------------------------------
+ * Waits until a notification is queued or the timeout expires
+ * 
+ * Called with the receive lock held. The CoreBluetooth callbacks are
+ * delivered on the main queue, so a caller on the main thread can not
+ * simply block. The backend run_events hook keeps the event loop going
+ * in short slices in that case.
+ * 
+ * @param s:       The stream instance
+ * @param timeout: Timeout in milliseconds, negative blocks forever
+ * 
+ * @return: DC_STATUS_SUCCESS when data is available, DC_STATUS_IO when
+ *          the connection is gone, DC_STATUS_TIMEOUT otherwise
+ *------------------------------------------------------------------*/
+static dc_status_t ble_rx_wait(ble_stream_t *s, int timeout)
+{
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    if (timeout > 0) {
+        deadline.tv_sec += timeout / 1000;
+        deadline.tv_nsec += (long) (timeout % 1000) * 1000000;
+        if (deadline.tv_nsec >= 1000000000) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000;
+        }
+    }
+
+    while (s->rx.pending == 0 && s->rx.head == s->rx.tail) {
+        // Nothing will arrive anymore once the connection is gone.
+        if (s->rx.closed)
+            return DC_STATUS_IO;
+
+        struct timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+        long long remaining = -1;
+        if (timeout >= 0) {
+            remaining = (long long) (deadline.tv_sec - now.tv_sec) * 1000 +
+                (deadline.tv_nsec - now.tv_nsec) / 1000000;
+            if (remaining <= 0)
+                return DC_STATUS_TIMEOUT;
+        }
+
+        if (s->backend->run_events) {
+            unsigned int slice = BLE_RX_INTERVAL;
+            if (remaining >= 0 && remaining < slice) {
+                slice = (unsigned int) remaining;
+            }
+            pthread_mutex_unlock(&s->rx.lock);
+            int handled = s->backend->run_events(s->handle, slice);
+            pthread_mutex_lock(&s->rx.lock);
+            if (handled)
+                continue;
+        }
+
+        if (timeout < 0) {
+            pthread_cond_wait(&s->rx.ready, &s->rx.lock);
+        } else {
+            pthread_cond_timedwait(&s->rx.ready, &s->rx.lock, &deadline);
+        }
+    }
+
+    return DC_STATUS_SUCCESS;
+}
+
+/*--------------------------------------------------------------------
+ * Default backend, forwarding to the CoreBluetooth bridge
+ *------------------------------------------------------------------*/
+static dc_status_t corebluetooth_set_timeout(void *handle, int timeout)
+{
+    return ble_set_timeout((ble_object_t *) handle, timeout);
+}
+
+static dc_status_t corebluetooth_ioctl(void *handle, unsigned int request, void *data, size_t size)
+{
+    return ble_ioctl((ble_object_t *) handle, request, data, size);
+}
+
+static dc_status_t corebluetooth_sleep(void *handle, unsigned int milliseconds)
+{
+    return ble_sleep((ble_object_t *) handle, milliseconds);
+}
+
+static dc_status_t corebluetooth_write(void *handle, const void *data, size_t size, size_t *actual)
+{
+    return ble_write((ble_object_t *) handle, data, size, actual);
+}
+
+static size_t corebluetooth_get_mtu(void *handle)
+{
+    return ble_get_mtu((ble_object_t *) handle);
+}
+
+static int corebluetooth_run_events(void *handle, unsigned int milliseconds)
+{
+    return ble_run_events((ble_object_t *) handle, milliseconds);
+}
+
+static dc_status_t corebluetooth_close(void *handle)
+{
+    dc_status_t rc = ble_close((ble_object_t *) handle);
+    freeBLEObject((ble_object_t *) handle);
+    return rc;
+}
+
+static const ble_backend_t corebluetooth_backend = {
+    .set_timeout = corebluetooth_set_timeout,
+    .ioctl       = corebluetooth_ioctl,
+    .sleep       = corebluetooth_sleep,
+    .write       = corebluetooth_write,
+    .get_mtu     = corebluetooth_get_mtu,
+    .run_events  = corebluetooth_run_events,
+    .close       = corebluetooth_close,
+};
+
+/*--------------------------------------------------------------------
+ * Creates a BLE iostream instance on top of a backend
  * 
  * @param out:     Output parameter for created iostream
  * @param context: Dive computer context
- * @param bleobj:  BLE object to associate with the stream
+ * @param backend: Backend performing the actual BLE operations
+ * @param handle:  Backend specific handle passed to every operation
  * 
  * @return: DC_STATUS_SUCCESS on success, error code otherwise
- * @note: Takes ownership of the bleobj
+ * @note: Takes ownership of the handle, which is released through
+ *        the backend close function
  *------------------------------------------------------------------*/
-static dc_status_t ble_iostream_create(dc_iostream_t **out, dc_context_t *context, ble_object_t *bleobj)
+dc_status_t ble_iostream_open(dc_iostream_t **out, dc_context_t *context, const ble_backend_t *backend, void *handle)
 {
+    if (out == NULL || backend == NULL || backend->write == NULL)
+        return DC_STATUS_INVALIDARGS;
+
     ble_stream_t *stream = (ble_stream_t *) malloc(sizeof(ble_stream_t));
     if (!stream) {
         if (context) {
-            printf("ble_iostream_create: no memory");
+            printf("ble_iostream_open: no memory");
         }
         return DC_STATUS_NOMEMORY;
     }
@@ -73,12 +297,108 @@ static dc_status_t ble_iostream_create(dc_iostream_t **out, dc_context_t *contex
     stream->base.vtable = &ble_iostream_vtable;
     stream->base.context = context;
     stream->base.transport = DC_TRANSPORT_BLE;
-    stream->ble_object = bleobj;
+    stream->backend = backend;
+    stream->handle = handle;
+    stream->timeout = -1;
+    pthread_mutex_init(&stream->rx.lock, NULL);
+    pthread_cond_init(&stream->rx.ready, NULL);
+
+    // The negotiated MTU is fixed for the lifetime of the connection.
+    stream->mtu = backend->get_mtu ? backend->get_mtu(handle) : 0;
+    if (stream->mtu == 0) {
+        stream->mtu = BLE_DEFAULT_MTU;
+    }
 
     *out = (dc_iostream_t *)stream;
     return DC_STATUS_SUCCESS;
 }
 
+/*--------------------------------------------------------------------
+ * Queues received data for reading
+ * 
+ * @param iostream: BLE iostream created by ble_iostream_open
+ * @param data:     Received notification payload
+ * @param size:     Size of the payload
+ * 
+ * @return: DC_STATUS_SUCCESS on success, error code otherwise
+ *------------------------------------------------------------------*/
+dc_status_t ble_stream_receive(dc_iostream_t *iostream, const void *data, size_t size)
+{
+    ble_stream_t *s = (ble_stream_t *) iostream;
+    if (s == NULL || s->base.vtable != &ble_iostream_vtable || (data == NULL && size))
+        return DC_STATUS_INVALIDARGS;
+
+    if (size > BLE_RX_MAXSIZE)
+        return DC_STATUS_INVALIDARGS;
+
+    if (size == 0)
+        return DC_STATUS_SUCCESS;
+
+    pthread_mutex_lock(&s->rx.lock);
+    int queued = ble_rx_put(&s->rx, (const unsigned char *) data, size);
+    pthread_cond_signal(&s->rx.ready);
+    pthread_mutex_unlock(&s->rx.lock);
+
+    if (!queued) {
+        printf("ble_stream_receive: receive buffer full, dropped %zu bytes\n", size);
+        return DC_STATUS_IO;
+    }
+
+    return DC_STATUS_SUCCESS;
+}
+
+/*--------------------------------------------------------------------
+ * Marks the connection of a BLE stream as lost
+ * 
+ * Data that was already received can still be read, after that every
+ * read fails immediately instead of waiting for the timeout.
+ * 
+ * @param iostream: BLE iostream created by ble_iostream_open
+ * 
+ * @return: DC_STATUS_SUCCESS on success, error code otherwise
+ *------------------------------------------------------------------*/
+dc_status_t ble_stream_disconnect(dc_iostream_t *iostream)
+{
+    ble_stream_t *s = (ble_stream_t *) iostream;
+    if (s == NULL || s->base.vtable != &ble_iostream_vtable)
+        return DC_STATUS_INVALIDARGS;
+
+    pthread_mutex_lock(&s->rx.lock);
+    s->rx.closed = 1;
+    pthread_cond_broadcast(&s->rx.ready);
+    pthread_mutex_unlock(&s->rx.lock);
+
+    return DC_STATUS_SUCCESS;
+}
+
+/*--------------------------------------------------------------------
+ * Queues a notification received by the CoreBluetooth manager
+ * 
+ * @param data: Received notification payload
+ * @param size: Size of the payload
+ *------------------------------------------------------------------*/
+void ble_packet_received(const void *data, size_t size)
+{
+    pthread_mutex_lock(&ble_active_lock);
+    if (ble_active) {
+        ble_stream_receive((dc_iostream_t *) ble_active, data, size);
+    }
+    pthread_mutex_unlock(&ble_active_lock);
+}
+
+/*--------------------------------------------------------------------
+ * Marks the stream opened by ble_packet_open, if any, as disconnected
+ * when the CoreBluetooth manager loses the peripheral
+ *------------------------------------------------------------------*/
+void ble_packet_disconnected(void)
+{
+    pthread_mutex_lock(&ble_active_lock);
+    if (ble_active) {
+        ble_stream_disconnect((dc_iostream_t *) ble_active);
+    }
+    pthread_mutex_unlock(&ble_active_lock);
+}
+
 /*--------------------------------------------------------------------
  * Sets the timeout for BLE operations
  * 
@@ -90,12 +410,61 @@ static dc_status_t ble_iostream_create(dc_iostream_t **out, dc_context_t *contex
 static dc_status_t ble_stream_set_timeout(dc_iostream_t *iostream, int timeout)
 {
     ble_stream_t *s = (ble_stream_t *) iostream;
-    return ble_set_timeout(s->ble_object, timeout);
+
+    pthread_mutex_lock(&s->rx.lock);
+    s->timeout = timeout;
+    pthread_mutex_unlock(&s->rx.lock);
+
+    if (s->backend->set_timeout == NULL)
+        return DC_STATUS_SUCCESS;
+    return s->backend->set_timeout(s->handle, timeout);
+}
+
+/*--------------------------------------------------------------------
+ * Gets the number of received bytes not read yet
+ * 
+ * @param iostream: The iostream instance
+ * @param value:    Output parameter for the number of bytes
+ * 
+ * @return: DC_STATUS_SUCCESS on success, error code otherwise
+ *------------------------------------------------------------------*/
+static dc_status_t ble_stream_get_available(dc_iostream_t *iostream, size_t *value)
+{
+    ble_stream_t *s = (ble_stream_t *) iostream;
+
+    pthread_mutex_lock(&s->rx.lock);
+    *value = s->rx.available;
+    pthread_mutex_unlock(&s->rx.lock);
+
+    return DC_STATUS_SUCCESS;
+}
+
+/*--------------------------------------------------------------------
+ * Waits until received data is available
+ * 
+ * @param iostream: The iostream instance
+ * @param timeout:  Timeout in milliseconds, negative blocks forever
+ * 
+ * @return: DC_STATUS_SUCCESS when data is available, DC_STATUS_TIMEOUT
+ *          otherwise
+ *------------------------------------------------------------------*/
+static dc_status_t ble_stream_poll(dc_iostream_t *iostream, int timeout)
+{
+    ble_stream_t *s = (ble_stream_t *) iostream;
+
+    pthread_mutex_lock(&s->rx.lock);
+    dc_status_t rc = ble_rx_wait(s, timeout);
+    pthread_mutex_unlock(&s->rx.lock);
+
+    return rc;
 }
 
 /*--------------------------------------------------------------------
  * Reads data from the BLE device
  * 
+ * Blocks until a notification is received or the timeout set with
+ * ble_stream_set_timeout expires, and returns that one notification.
+ * 
  * @param iostream: The iostream instance
  * @param data:     Buffer to store read data
  * @param size:     Size of the buffer
@@ -106,12 +475,39 @@ static dc_status_t ble_stream_set_timeout(dc_iostream_t *iostream, int timeout)
 static dc_status_t ble_stream_read(dc_iostream_t *iostream, void *data, size_t size, size_t *actual)
 {
     ble_stream_t *s = (ble_stream_t *) iostream;
-    return ble_read(s->ble_object, data, size, actual);
+    size_t nbytes = 0;
+
+    pthread_mutex_lock(&s->rx.lock);
+
+    dc_status_t rc = DC_STATUS_SUCCESS;
+    if (s->rx.overflow) {
+        printf("ble_stream_read: notifications were lost\n");
+        s->rx.overflow = 0;
+        rc = DC_STATUS_IO;
+    } else if (size) {
+        rc = ble_rx_wait(s, s->timeout);
+        if (rc == DC_STATUS_SUCCESS) {
+            nbytes = ble_rx_get(&s->rx, (unsigned char *) data, size);
+        }
+    }
+
+    pthread_mutex_unlock(&s->rx.lock);
+
+    if (actual)
+        *actual = nbytes;
+
+    return rc;
 }
 
 /*--------------------------------------------------------------------
  * Writes data to the BLE device
  * 
+ * Every write without response carries at most one MTU worth of
+ * payload, anything beyond that is silently dropped by the stack.
+ * Larger writes are therefore split into full MTU sized frames. The
+ * boundaries between separate writes are preserved, because most BLE
+ * protocols treat each write as one self-contained packet.
+ * 
  * @param iostream: The iostream instance
  * @param data:     Data to write
  * @param size:     Size of the data
@@ -122,7 +518,32 @@ static dc_status_t ble_stream_read(dc_iostream_t *iostream, void *data, size_t s
 static dc_status_t ble_stream_write(dc_iostream_t *iostream, const void *data, size_t size, size_t *actual)
 {
     ble_stream_t *s = (ble_stream_t *) iostream;
-    return ble_write(s->ble_object, data, size, actual);
+    const unsigned char *p = (const unsigned char *) data;
+    dc_status_t rc = DC_STATUS_SUCCESS;
+
+    size_t nbytes = 0;
+    while (nbytes < size) {
+        size_t length = size - nbytes;
+        if (length > s->mtu) {
+            length = s->mtu;
+        }
+
+        size_t transferred = 0;
+        rc = s->backend->write(s->handle, p + nbytes, length, &transferred);
+        nbytes += transferred;
+        if (rc != DC_STATUS_SUCCESS)
+            break;
+
+        if (transferred != length) {
+            rc = DC_STATUS_IO;
+            break;
+        }
+    }
+
+    if (actual)
+        *actual = nbytes;
+
+    return rc;
 }
 
 /*--------------------------------------------------------------------
@@ -138,7 +559,17 @@ static dc_status_t ble_stream_write(dc_iostream_t *iostream, const void *data, s
 static dc_status_t ble_stream_ioctl(dc_iostream_t *iostream, unsigned int request, void *data_, size_t size_)
 {
     ble_stream_t *s = (ble_stream_t *) iostream;
-    return ble_ioctl(s->ble_object, request, data_, size_);
+
+    if (request == DC_IOCTL_BLE_GET_MTU) {
+        if (size_ < sizeof(unsigned int))
+            return DC_STATUS_INVALIDARGS;
+        *(unsigned int *) data_ = (unsigned int) s->mtu;
+        return DC_STATUS_SUCCESS;
+    }
+
+    if (s->backend->ioctl == NULL)
+        return DC_STATUS_UNSUPPORTED;
+    return s->backend->ioctl(s->handle, request, data_, size_);
 }
 
 /*--------------------------------------------------------------------
@@ -152,7 +583,9 @@ static dc_status_t ble_stream_ioctl(dc_iostream_t *iostream, unsigned int reques
 static dc_status_t ble_stream_sleep(dc_iostream_t *iostream, unsigned int milliseconds)
 {
     ble_stream_t *s = (ble_stream_t *) iostream;
-    return ble_sleep(s->ble_object, milliseconds);
+    if (s->backend->sleep == NULL)
+        return DC_STATUS_UNSUPPORTED;
+    return s->backend->sleep(s->handle, milliseconds);
 }
 
 /*--------------------------------------------------------------------
@@ -165,9 +598,23 @@ static dc_status_t ble_stream_sleep(dc_iostream_t *iostream, unsigned int millis
 static dc_status_t ble_stream_close(dc_iostream_t *iostream)
 {
     ble_stream_t *s = (ble_stream_t *) iostream;
-    dc_status_t rc = ble_close(s->ble_object);
-    freeBLEObject(s->ble_object);
-    free(s);
+    dc_status_t rc = DC_STATUS_SUCCESS;
+
+    pthread_mutex_lock(&ble_active_lock);
+    if (ble_active == s) {
+        ble_active = NULL;
+    }
+    pthread_mutex_unlock(&ble_active_lock);
+
+    // Wake up any reader still waiting for data.
+    ble_stream_disconnect(iostream);
+
+    if (s->backend->close) {
+        rc = s->backend->close(s->handle);
+    }
+    pthread_cond_destroy(&s->rx.ready);
+    pthread_mutex_destroy(&s->rx.lock);
+    // The stream itself is released by dc_iostream_close.
     return rc;
 }
 
@@ -200,16 +647,50 @@ dc_status_t ble_packet_open(dc_iostream_t **iostream, dc_context_t *context, con
     }
 
     // Create a custom BLE iostream
-    dc_status_t status = ble_iostream_create(iostream, context, io);
+    dc_status_t status = ble_iostream_open(iostream, context, &corebluetooth_backend, io);
     if (status != DC_STATUS_SUCCESS) {
         printf("ble_packet_open: Failed to create iostream\n");
         freeBLEObject(io);
         return status;
     }
 
+    // Route the notifications of the manager into the new stream
+    pthread_mutex_lock(&ble_active_lock);
+    ble_active = (ble_stream_t *) *iostream;
+    pthread_mutex_unlock(&ble_active_lock);
+
     return DC_STATUS_SUCCESS;
 }
 
+/*--------------------------------------------------------------------
+ * Copies the fingerprint of a device out of the fingerprint store
+ * 
+ * @param store:  Fingerprint store
+ * @param family: Device family
+ * @param model:  Device model
+ * @param serial: Device serial number
+ * @param size:   Output parameter for the fingerprint size
+ * @return Fingerprint (caller must free) or NULL if none is stored
+ *------------------------------------------------------------------*/
+static unsigned char *lookup_stored_fingerprint(dc_fingerprint_store_t *store,
+    dc_family_t family, unsigned int model, unsigned int serial, size_t *size)
+{
+    unsigned char *fingerprint = NULL;
+    dc_buffer_t *buffer = dc_buffer_new(0);
+    if (!buffer) return NULL;
+
+    if (dc_fingerprint_store_get(store, family, model, serial, buffer, NULL) == DC_STATUS_SUCCESS) {
+        fingerprint = malloc(dc_buffer_get_size(buffer));
+        if (fingerprint) {
+            memcpy(fingerprint, dc_buffer_get_data(buffer), dc_buffer_get_size(buffer));
+            *size = dc_buffer_get_size(buffer);
+        }
+    }
+
+    dc_buffer_free(buffer);
+    return fingerprint;
+}
+
 /*--------------------------------------------------------------------
  * Event callback wrapper
  * 
@@ -230,24 +711,38 @@ static void event_cb(dc_device_t *device, dc_event_type_t event, const void *dat
             devdata->devinfo = *devinfo;
             devdata->have_devinfo = 1;
             
-            // Look up fingerprint using callback if available
-            if (devdata->lookup_fingerprint && devdata->model) {
+            // Look up fingerprint in the store, or using the callback if available
+            unsigned char *fingerprint = NULL;
+            size_t fsize = 0;
+            if (devdata->fingerprint_store && devdata->descriptor) {
+                fingerprint = lookup_stored_fingerprint(devdata->fingerprint_store,
+                    dc_descriptor_get_type(devdata->descriptor),
+                    dc_descriptor_get_model(devdata->descriptor),
+                    devinfo->serial, &fsize);
+            } else if (devdata->lookup_fingerprint && devdata->model) {
                 char serial[16];
                 snprintf(serial, sizeof(serial), "%08x", devinfo->serial);
                 
-                size_t fsize = 0;
-                unsigned char *fingerprint = devdata->lookup_fingerprint(
+                fingerprint = devdata->lookup_fingerprint(
                     devdata->fingerprint_context,
                     devdata->model,
                     serial,
                     &fsize
                 );
-                
-                if (fingerprint && fsize > 0) {
-                    dc_device_set_fingerprint(device, fingerprint, fsize);
-                    devdata->fingerprint = fingerprint;
-                    devdata->fsize = fsize;
-                } 
+            }
+            
+            if (fingerprint && fsize > 0) {
+                dc_device_set_fingerprint(device, fingerprint, fsize);
+                free(devdata->fingerprint);
+                devdata->fingerprint = fingerprint;
+                devdata->fsize = fsize;
+            } else {
+                free(fingerprint);
+            }
+            
+            // Let the application restore the rest of its per device state
+            if (devdata->devinfo_callback) {
+                devdata->devinfo_callback(devdata->devinfo_context, device, devinfo);
             }
         }
         break;
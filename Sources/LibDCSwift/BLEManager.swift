@@ -70,9 +70,6 @@ public class CoreBluetoothManager: NSObject, CoreBluetoothManagerProtocol, Obser
     @objc private var timeout: Int = -1 // default to no timeout
     private var writeCharacteristic: CBCharacteristic?
     private var notifyCharacteristic: CBCharacteristic?
-    private var receivedData: Data = Data()
-    private let queue = DispatchQueue(label: "com.blemanager.queue")
-    private let frameMarker: UInt8 = 0x7E
     private var _deviceDataPtr: UnsafeMutablePointer<device_data_t>?
     private var connectionCompletion: ((Bool) -> Void)?
     private var totalBytesReceived: Int = 0
@@ -152,60 +149,16 @@ public class CoreBluetoothManager: NSObject, CoreBluetoothManagerProtocol, Obser
     }
     
     // MARK: - Data Handling
-    private func findNextCompleteFrame() -> Data? {
-        var frameToReturn: Data? = nil
-        
-        queue.sync {
-            guard let startIndex = receivedData.firstIndex(of: frameMarker) else {
-                return
-            }
-            
-            let afterStart = receivedData.index(after: startIndex)
-            guard afterStart < receivedData.count,
-                  let endIndex = receivedData[afterStart...].firstIndex(of: frameMarker) else {
-                return
-            }
-            
-            let frameEndIndex = receivedData.index(after: endIndex)
-            let frame = receivedData[startIndex..<frameEndIndex]
-            
-            receivedData.removeSubrange(startIndex..<frameEndIndex)
-            frameToReturn = Data(frame)
-        }
-        
-        return frameToReturn
-    }
-    
     @objc public func write(_ data: Data!) -> Bool {
         guard let peripheral = self.peripheral,
               let characteristic = self.writeCharacteristic else { return false }
         peripheral.writeValue(data, for: characteristic, type: .withoutResponse)
         return true
     }
-    
-    @objc public func readDataPartial(_ requested: Int32) -> Data! {
-        let startTime = Date()
-        let partialTimeout: TimeInterval = 0.5
-        
-        while true {
-            var outData: Data?
-            queue.sync {
-                if receivedData.count > 0 {
-                    let amount = min(Int(requested), receivedData.count)
-                    outData = receivedData.prefix(amount)
-                    receivedData.removeSubrange(0..<amount)
-                }
-            }
-            
-            if let data = outData {
-                return data
-            }
-            
-            if Date().timeIntervalSince(startTime) > partialTimeout {
-                return nil
-            }
-            RunLoop.current.run(until: Date(timeIntervalSinceNow: 0.005))
-        }
+
+    @objc public func maximumWriteLength() -> Int {
+        guard let peripheral = self.peripheral else { return 0 }
+        return peripheral.maximumWriteValueLength(for: .withoutResponse)
     }
     
     // MARK: - Device Management
@@ -215,12 +168,6 @@ public class CoreBluetoothManager: NSObject, CoreBluetoothManagerProtocol, Obser
             self.isPeripheralReady = false
             self.connectedDevice = nil
         }
-        queue.sync {
-            if !receivedData.isEmpty {
-                logInfo("Clearing \(receivedData.count) bytes from receive buffer")
-                receivedData.removeAll()
-            }
-        }
         
         if clearDevicePtr {
             if let devicePtr = self.openedDeviceDataPtr {
@@ -416,6 +363,9 @@ public class CoreBluetoothManager: NSObject, CoreBluetoothManagerProtocol, Obser
             logError("Disconnect error: \(error.localizedDescription)")
         }
         
+        // Fail pending reads right away instead of waiting for their timeout
+        ble_packet_disconnected()
+        
         DispatchQueue.main.async {
             self.isPeripheralReady = false
             self.connectedDevice = nil
@@ -521,12 +471,9 @@ public class CoreBluetoothManager: NSObject, CoreBluetoothManagerProtocol, Obser
             logDebug("Received data: \(preview)... (\(data.count) bytes)")
         }
         
-        queue.sync {
-            // Append new data to our buffer immediately
-            receivedData.append(data)
-            if Logger.shared.shouldShowRawData {
-                logDebug("Buffer: \(receivedData.hexEncodedString())")
-            }
+        // Hand the notification to the receive buffer of the open stream
+        data.withUnsafeBytes { buffer in
+            ble_packet_received(buffer.baseAddress, buffer.count)
         }
         
         updateTransferStats(data.count)
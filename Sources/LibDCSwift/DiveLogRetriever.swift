@@ -15,6 +15,8 @@ public class DiveLogRetriever {
         var lastFingerprint: Data?
         let deviceName: String
         var deviceSerial: String?
+        var deviceKey: (family: dc_family_t, model: UInt32)?
+        var serialNumber: UInt32?
         var hasNewDives: Bool = false
         weak var bluetoothManager: CoreBluetoothManager?
         var devicePtr: UnsafeMutablePointer<device_data_t>?
@@ -30,6 +32,48 @@ public class DiveLogRetriever {
         }
     }
 
+    /// C-compatible callback closure called once the device info is known.
+    /// Restores the inter-packet delay learned in the last session with the device.
+    /// - Parameters:
+    ///   - userdata: Context data for the callback
+    ///   - device: The open device
+    ///   - devinfo: Device info, with the serial number
+    private static let devinfoCallbackClosure: @convention(c) (
+        UnsafeMutableRawPointer?,
+        OpaquePointer?,
+        UnsafePointer<dc_event_devinfo_t>?
+    ) -> Void = { userdata, device, devinfo in
+        guard let userdata = userdata,
+              let device = device,
+              let devinfo = devinfo else {
+            return
+        }
+        
+        let context = Unmanaged<CallbackContext>.fromOpaque(userdata).takeUnretainedValue()
+        if let key = context.deviceKey {
+            DiveLogRetriever.restorePacing(device, family: key.family, model: key.model, serial: devinfo.pointee.serial)
+        }
+    }
+    
+    /// Seeds the inter-packet delay of the device with the one stored for it, if any
+    private static func restorePacing(_ device: OpaquePointer, family: dc_family_t, model: UInt32, serial: UInt32) {
+        guard let delay = DeviceFingerprintStorage.shared.getPacing(family: family, model: model, serial: serial) else {
+            return
+        }
+        if dc_device_set_pacing(device, delay) == DC_STATUS_SUCCESS {
+            logInfo("⏱️ Restored inter-packet delay of \(delay) ms")
+        }
+    }
+    
+    /// Stores the inter-packet delay learned during this session, for the next one
+    private static func savePacing(_ device: OpaquePointer, family: dc_family_t, model: UInt32, serial: UInt32) {
+        var delay: UInt32 = 0
+        guard dc_device_get_pacing(device, &delay) == DC_STATUS_SUCCESS else {
+            return
+        }
+        DeviceFingerprintStorage.shared.savePacing(delay, family: family, model: model, serial: serial)
+    }
+    
     /// C-compatible callback closure for processing individual dive logs.
     /// This is called by libdivecomputer for each dive found on the device.
     /// - Parameters:
@@ -67,6 +111,7 @@ public class DiveLogRetriever {
            devicePtr.pointee.have_devinfo != 0 {
             let deviceSerial = String(format: "%08x", devicePtr.pointee.devinfo.serial)
             context.deviceSerial = deviceSerial
+            context.serialNumber = devicePtr.pointee.devinfo.serial
             context.hasDeviceInfo = true
         }
         
@@ -117,44 +162,6 @@ public class DiveLogRetriever {
     private static var backgroundTask: UIBackgroundTaskIdentifier = .invalid
     #endif
     
-    /// C callback for fingerprint lookup
-    private static let fingerprintLookup: @convention(c) (
-        UnsafeMutableRawPointer?, 
-        UnsafePointer<CChar>?, 
-        UnsafePointer<CChar>?, 
-        UnsafeMutablePointer<Int>?
-    ) -> UnsafeMutablePointer<UInt8>? = { context, deviceType, serial, size in
-        guard let context = context,
-              let deviceType = deviceType,
-              let serial = serial,
-              let size = size else {
-            logError("❌ Fingerprint lookup failed: Missing parameters")
-            return nil
-        }
-        
-        let viewModel = Unmanaged<DiveDataViewModel>.fromOpaque(context).takeUnretainedValue()
-        let deviceTypeStr = String(cString: deviceType)
-        var descriptor: OpaquePointer?
-        if find_descriptor_by_name(&descriptor, deviceTypeStr) == DC_STATUS_SUCCESS,
-           let desc = descriptor,
-           let product = dc_descriptor_get_product(desc) {
-            let normalizedDeviceType = String(cString: product)
-            dc_descriptor_free(desc)
-            if let fingerprint = viewModel.getFingerprint(
-                forDeviceType: normalizedDeviceType,
-                serial: String(cString: serial)
-            ) {
-                logInfo("✅ Found stored fingerprint: \(fingerprint.hexString)")
-                size.pointee = fingerprint.count
-                let buffer = UnsafeMutablePointer<UInt8>.allocate(capacity: fingerprint.count)
-                fingerprint.copyBytes(to: buffer, count: fingerprint.count)
-                return buffer
-            }
-        }
-        logInfo("❌ No stored fingerprint found for \(deviceTypeStr) (\(String(cString: serial)))")
-        return nil
-    }
-    
     private static var currentContext: CallbackContext?
     
     /// Retrieves dive logs from a connected dive computer.
@@ -190,17 +197,24 @@ public class DiveLogRetriever {
             }
 
             // Get device info for fingerprint lookup
+            // Fingerprints are keyed by the family and model of the descriptor, like in the event handler
             let deviceName = device.name ?? "Unknown Device"
-            let deviceSerial: String? = if devicePtr.pointee.have_devinfo != 0 {
-                String(format: "%08x", devicePtr.pointee.devinfo.serial)
+            let deviceKey: (family: dc_family_t, model: UInt32)? = if let descriptor = devicePtr.pointee.descriptor {
+                (dc_descriptor_get_type(descriptor), dc_descriptor_get_model(descriptor))
+            } else {
+                nil
+            }
+            let serialNumber: UInt32? = if devicePtr.pointee.have_devinfo != 0 {
+                devicePtr.pointee.devinfo.serial
             } else {
                 nil
             }
             
             // Only pass stored fingerprint if we want to use it (toggle is ON)
-            let storedFingerprint: Data? = if let serial = deviceSerial {
+            let storedFingerprint: Data? = if let key = deviceKey, let serial = serialNumber {
                 viewModel.getFingerprint(
-                    forDeviceType: deviceName,
+                    family: key.family,
+                    model: key.model,
                     serial: serial
                 )
             } else {
@@ -220,6 +234,7 @@ public class DiveLogRetriever {
                 bluetoothManager: bluetoothManager
             )
             context.devicePtr = devicePtr
+            context.deviceKey = deviceKey
             context.logCount = 1  
             
             let contextPtr = UnsafeMutableRawPointer(Unmanaged.passRetained(context).toOpaque())
@@ -233,12 +248,25 @@ public class DiveLogRetriever {
                 }
             }
             
-            devicePtr.pointee.fingerprint_context = Unmanaged.passUnretained(viewModel).toOpaque()
-            devicePtr.pointee.lookup_fingerprint = fingerprintLookup
+            // The event handler looks up the fingerprint and the pacing once the serial number is known
+            devicePtr.pointee.fingerprint_store = DeviceFingerprintStorage.shared.fingerprintStore
+            devicePtr.pointee.devinfo_context = contextPtr
+            devicePtr.pointee.devinfo_callback = devinfoCallbackClosure
+            if let key = deviceKey, let serial = serialNumber {
+                restorePacing(dcDevice, family: key.family, model: key.model, serial: serial)
+            }
             
             logInfo("🔄 Starting dive enumeration...")
             let enumStatus = dc_device_foreach(dcDevice, diveCallbackClosure, contextPtr)
             
+            devicePtr.pointee.devinfo_callback = nil
+            devicePtr.pointee.devinfo_context = nil
+            
+            // Keep the learned delay, also after a failed download
+            if let key = deviceKey, devicePtr.pointee.have_devinfo != 0 {
+                savePacing(dcDevice, family: key.family, model: key.model, serial: devicePtr.pointee.devinfo.serial)
+            }
+            
             progressTimer.invalidate()
             DispatchQueue.main.async {
                 if enumStatus != DC_STATUS_SUCCESS {
@@ -247,11 +275,13 @@ public class DiveLogRetriever {
                 } else {
                     if context.hasNewDives {
                         if let lastFingerprint = context.lastFingerprint,
-                           let deviceSerial = context.deviceSerial {
+                           let deviceKey = context.deviceKey,
+                           let serialNumber = context.serialNumber {
                             viewModel.saveFingerprint(
                                 lastFingerprint,
-                                deviceType: context.deviceName,
-                                serial: deviceSerial
+                                family: deviceKey.family,
+                                model: deviceKey.model,
+                                serial: serialNumber
                             )
                             logInfo("💾 Updated fingerprint in persistent storage")
                             viewModel.updateProgress(.completed)
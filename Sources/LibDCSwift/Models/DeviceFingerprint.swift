@@ -3,145 +3,422 @@ import Clibdivecomputer
 import LibDCBridge
 
 /// Represents a stored device fingerprint with associated metadata
+/// The fingerprint is identified by family, model and serial; deviceType is the product name, for display only
 public struct DeviceFingerprint: Codable, Identifiable {
     public let id: UUID
+    /// Raw value of the dc_family_t of the device
+    public let family: UInt32
+    public let model: UInt32
     public let deviceType: String
     public let serial: String
     public let fingerprint: Data
     public let timestamp: Date
-    
+
+    /// Family of the device, as used by libdivecomputer
+    public var dcFamily: dc_family_t {
+        dc_family_t(rawValue: family)
+    }
+
+    private enum CodingKeys: String, CodingKey {
+        case id
+        case family
+        case model
+        case deviceType
+        case serial
+        case fingerprint
+        case timestamp
+    }
+
+    public init(family: dc_family_t, model: UInt32, deviceType: String, serial: String, fingerprint: Data) {
+        self.init(family: family, model: model, deviceType: deviceType, serial: serial, fingerprint: fingerprint, timestamp: Date())
+    }
+
+    /// Creates a fingerprint for a device identified by its name
+    /// The family and model are resolved from the name, and are zero when the device is unknown
+    /// - Parameters:
+    ///   - deviceType: Device name, as advertised over BLE
+    ///   - serial: Serial number of the device
+    ///   - fingerprint: Fingerprint data
     public init(deviceType: String, serial: String, fingerprint: Data) {
+        let key = DeviceFingerprintStorage.deviceKey(forDeviceType: deviceType)
+        self.init(
+            family: key?.family ?? DC_FAMILY_NULL,
+            model: key?.model ?? 0,
+            deviceType: deviceType,
+            serial: serial,
+            fingerprint: fingerprint,
+            timestamp: Date()
+        )
+    }
+
+    init(family: dc_family_t, model: UInt32, deviceType: String, serial: String, fingerprint: Data, timestamp: Date) {
         self.id = UUID()
+        self.family = family.rawValue
+        self.model = model
         self.deviceType = deviceType
         self.serial = serial
         self.fingerprint = fingerprint
-        self.timestamp = Date()
+        self.timestamp = timestamp
+    }
+
+    /// Fingerprints encoded by earlier versions have no family and model, those decode as zero
+    public init(from decoder: Decoder) throws {
+        let container = try decoder.container(keyedBy: CodingKeys.self)
+        id = try container.decode(UUID.self, forKey: .id)
+        family = try container.decodeIfPresent(UInt32.self, forKey: .family) ?? DC_FAMILY_NULL.rawValue
+        model = try container.decodeIfPresent(UInt32.self, forKey: .model) ?? 0
+        deviceType = try container.decode(String.self, forKey: .deviceType)
+        serial = try container.decode(String.self, forKey: .serial)
+        fingerprint = try container.decode(Data.self, forKey: .fingerprint)
+        timestamp = try container.decode(Date.self, forKey: .timestamp)
     }
 }
 
 /// Manages persistent storage of device fingerprints
+/// Fingerprints are kept in libdivecomputer's fingerprint store, keyed by device family, model and serial number
 public class DeviceFingerprintStorage {
     public static let shared = DeviceFingerprintStorage()
-    private let fingerprintKey = "DeviceFingerprints"
-    
-    private init() {}
-    
-    /// Normalizes a device type string for consistent comparison
-    /// Uses libdivecomputer's descriptor system when possible, falls back to string parsing
-    /// - Parameter deviceType: The device type string to normalize
-    /// - Returns: Normalized device type string
-    private func normalizeDeviceType(_ deviceType: String) -> String {
-        // Try to find matching descriptor from libdivecomputer
+
+    /// Key of the JSON array used by earlier versions, migrated on first use
+    private let legacyFingerprintKey = "DeviceFingerprints"
+    /// Legacy fingerprints that could not be migrated, kept aside instead of being retried on every launch
+    private let unmigratedFingerprintKey = "DeviceFingerprints.unmigrated"
+    /// Inter-packet delays learned per device, keyed like the fingerprints
+    private let pacingKey = "DevicePacing"
+    private let storeFileName = "fingerprints.dcfp"
+
+    /// Underlying dc_fingerprint_store_t, to assign to device_data_t.fingerprint_store
+    public private(set) var fingerprintStore: OpaquePointer?
+
+    private struct LegacyFingerprint: Codable {
+        let deviceType: String
+        let serial: String
+        let fingerprint: Data
+    }
+
+    private struct StoredEntry {
+        let family: dc_family_t
+        let model: UInt32
+        let serial: UInt32
+        let fingerprint: Data
+        let timestamp: dc_ticks_t
+    }
+
+    private struct Key: Hashable {
+        let family: UInt32
+        let model: UInt32
+        let serial: UInt32
+    }
+
+    private init() {
+        let fileManager = FileManager.default
+        guard let directory = fileManager.urls(for: .applicationSupportDirectory, in: .userDomainMask).first?
+            .appendingPathComponent("LibDCSwift", isDirectory: true) else {
+            logError("❌ No application support directory for the fingerprint store")
+            return
+        }
+        try? fileManager.createDirectory(at: directory, withIntermediateDirectories: true)
+
+        let path = directory.appendingPathComponent(storeFileName).path
+        var store: OpaquePointer?
+        var status = dc_fingerprint_store_open(&store, nil, path)
+        if status == DC_STATUS_DATAFORMAT {
+            // A damaged store only costs a full download
+            logWarning("⚠️ Fingerprint store is damaged - starting with an empty store")
+            try? fileManager.removeItem(atPath: path)
+            status = dc_fingerprint_store_open(&store, nil, path)
+        }
+        guard status == DC_STATUS_SUCCESS else {
+            logError("❌ Failed to open the fingerprint store (\(status))")
+            return
+        }
+        fingerprintStore = store
+        migrateLegacyFingerprints()
+    }
+
+    deinit {
+        dc_fingerprint_store_close(fingerprintStore)
+    }
+
+    /// Imports the fingerprints stored as JSON in UserDefaults by earlier versions
+    /// Fingerprints that can not be migrated are moved aside, so the migration runs only once
+    private func migrateLegacyFingerprints() {
+        guard fingerprintStore != nil,
+              let data = UserDefaults.standard.data(forKey: legacyFingerprintKey) else {
+            return
+        }
+        guard let fingerprints = try? JSONDecoder().decode([LegacyFingerprint].self, from: data) else {
+            logError("❌ Failed to decode the legacy fingerprints - moved aside")
+            UserDefaults.standard.set(data, forKey: unmigratedFingerprintKey)
+            UserDefaults.standard.removeObject(forKey: legacyFingerprintKey)
+            return
+        }
+
+        var unmigrated: [LegacyFingerprint] = []
+        for stored in fingerprints where !stored.fingerprint.isEmpty {
+            // Earlier versions stored the device name, as used for the connection
+            guard let key = Self.deviceKey(forDeviceType: stored.deviceType),
+                  let serial = UInt32(stored.serial, radix: 16) else {
+                logWarning("⚠️ Unknown device \(stored.deviceType) (\(stored.serial)) - fingerprint not migrated")
+                unmigrated.append(stored)
+                continue
+            }
+            // A fingerprint imported by an earlier attempt may have been updated since
+            if getFingerprint(family: key.family, model: key.model, serial: serial) != nil {
+                continue
+            }
+            if !saveFingerprint(stored.fingerprint, family: key.family, model: key.model, serial: serial) {
+                unmigrated.append(stored)
+            }
+        }
+
+        if !unmigrated.isEmpty {
+            logWarning("⚠️ \(unmigrated.count) fingerprints not migrated - moved aside")
+            if let data = try? JSONEncoder().encode(unmigrated) {
+                UserDefaults.standard.set(data, forKey: unmigratedFingerprintKey)
+            }
+        }
+        UserDefaults.standard.removeObject(forKey: legacyFingerprintKey)
+        logInfo("✅ Migrated \(fingerprints.count - unmigrated.count) fingerprints to the fingerprint store")
+    }
+
+    /// Resolves a device name to the family and model used as key
+    /// - Parameter deviceType: The device name, as advertised over BLE
+    /// - Returns: Family and model of the matching descriptor, or nil if unknown
+    static func deviceKey(forDeviceType deviceType: String) -> (family: dc_family_t, model: UInt32)? {
         var descriptor: OpaquePointer?
-        let status = find_descriptor_by_name(&descriptor, deviceType)
-        
-        // If we found a matching descriptor, use its product name
-        if status == DC_STATUS_SUCCESS,
-           let desc = descriptor,
-           let product = dc_descriptor_get_product(desc) {
-            let normalizedName = String(cString: product)
-            dc_descriptor_free(desc)
-            return normalizedName
-        }
-        
-        // If no match found, fall back to basic string parsing
-        let components = deviceType.split(separator: " ")
-        if components.count == 1 {
-            return String(components[0])
-        }
-        
-        // Remove any serial numbers or identifiers (typically numeric)
-        let nonNumericComponents = components.filter { !$0.allSatisfy { $0.isNumber } }
-        if let modelName = nonNumericComponents.last {
-            return String(modelName)
-        }
-        return deviceType
-    }
-    
+        guard find_descriptor_by_name(&descriptor, deviceType) == DC_STATUS_SUCCESS,
+              let desc = descriptor else {
+            return nil
+        }
+        defer { dc_descriptor_free(desc) }
+        return (dc_descriptor_get_type(desc), dc_descriptor_get_model(desc))
+    }
+
+    /// Returns the product name of a device, for display
+    static func deviceType(family: dc_family_t, model: UInt32) -> String {
+        var descriptor: OpaquePointer?
+        if find_descriptor_by_model(&descriptor, family, model) == DC_STATUS_SUCCESS,
+           let desc = descriptor {
+            defer { dc_descriptor_free(desc) }
+            if let product = dc_descriptor_get_product(desc) {
+                return String(cString: product)
+            }
+        }
+        return "Unknown (\(family.rawValue), \(model))"
+    }
+
+    /// Copies all entries out of the store
+    private func storedEntries() -> [StoredEntry] {
+        var entries: [StoredEntry] = []
+
+        let callback: dc_fingerprint_callback_t = { family, model, serial, fingerprint, fsize, timestamp, userdata in
+            guard let userdata = userdata, let fingerprint = fingerprint else { return 1 }
+            let entries = userdata.assumingMemoryBound(to: [StoredEntry].self)
+            entries.pointee.append(StoredEntry(
+                family: family,
+                model: model,
+                serial: serial,
+                fingerprint: Data(bytes: fingerprint, count: Int(fsize)),
+                timestamp: timestamp
+            ))
+            return 1
+        }
+        _ = withUnsafeMutablePointer(to: &entries) { pointer in
+            dc_fingerprint_store_foreach(fingerprintStore, callback, pointer)
+        }
+        return entries
+    }
+
     /// Loads all stored device fingerprints from persistent storage
     /// - Returns: Array of DeviceFingerprint objects
     public func loadFingerprints() -> [DeviceFingerprint] {
-        guard let data = UserDefaults.standard.data(forKey: fingerprintKey),
-              let fingerprints = try? JSONDecoder().decode([DeviceFingerprint].self, from: data) else {
-            return []
+        // Resolve the names once the store is unlocked
+        return storedEntries().map { entry in
+            DeviceFingerprint(
+                family: entry.family,
+                model: entry.model,
+                deviceType: Self.deviceType(family: entry.family, model: entry.model),
+                serial: String(format: "%08x", entry.serial),
+                fingerprint: entry.fingerprint,
+                timestamp: Date(timeIntervalSince1970: TimeInterval(entry.timestamp))
+            )
         }
-        return fingerprints
     }
-    
-    /// Saves fingerprints to persistent storage
+
+    /// Replaces all stored fingerprints
+    /// The new fingerprints are written first, and the other entries are only removed once all of them are stored
     /// - Parameter fingerprints: Array of DeviceFingerprint objects to save
     public func saveFingerprints(_ fingerprints: [DeviceFingerprint]) {
-        if let data = try? JSONEncoder().encode(fingerprints) {
-            UserDefaults.standard.set(data, forKey: fingerprintKey)
+        var keep = Set<Key>()
+        for fingerprint in fingerprints where !fingerprint.fingerprint.isEmpty {
+            // Fingerprints created from a device name alone carry no family
+            let key: (family: dc_family_t, model: UInt32)? = fingerprint.dcFamily != DC_FAMILY_NULL ?
+                (family: fingerprint.dcFamily, model: fingerprint.model) :
+                Self.deviceKey(forDeviceType: fingerprint.deviceType)
+            guard let key = key,
+                  let serial = UInt32(fingerprint.serial, radix: 16),
+                  saveFingerprint(fingerprint.fingerprint, family: key.family, model: key.model, serial: serial) else {
+                logError("❌ Failed to save fingerprint for \(fingerprint.deviceType) (\(fingerprint.serial)) - keeping the stored fingerprints")
+                return
+            }
+            keep.insert(Key(family: key.family.rawValue, model: key.model, serial: serial))
         }
+
+        for entry in storedEntries() where !keep.contains(Key(family: entry.family.rawValue, model: entry.model, serial: entry.serial)) {
+            _ = dc_fingerprint_store_remove(fingerprintStore, entry.family, entry.model, entry.serial)
+        }
+    }
+
+    /// Gets fingerprint for specific device
+    /// - Parameters:
+    ///   - family: Device family
+    ///   - model: Device model
+    ///   - serial: Serial number of the device
+    /// - Returns: Matching DeviceFingerprint if found
+    public func getFingerprint(family: dc_family_t, model: UInt32, serial: UInt32) -> DeviceFingerprint? {
+        guard let buffer = dc_buffer_new(0) else { return nil }
+        defer { dc_buffer_free(buffer) }
+
+        var timestamp: dc_ticks_t = 0
+        guard dc_fingerprint_store_get(fingerprintStore, family, model, serial, buffer, &timestamp) == DC_STATUS_SUCCESS,
+              let bytes = dc_buffer_get_data(buffer) else {
+            return nil
+        }
+
+        logInfo("✅ Found stored fingerprint")
+        return DeviceFingerprint(
+            family: family,
+            model: model,
+            deviceType: Self.deviceType(family: family, model: model),
+            serial: String(format: "%08x", serial),
+            fingerprint: Data(bytes: bytes, count: dc_buffer_get_size(buffer)),
+            timestamp: Date(timeIntervalSince1970: TimeInterval(timestamp))
+        )
     }
-    
+
     /// Gets fingerprint for specific device
     /// - Parameters:
-    ///   - deviceType: Type/model of the device
+    ///   - deviceType: Device name, as advertised over BLE
     ///   - serial: Serial number of the device
     /// - Returns: Matching DeviceFingerprint if found
     public func getFingerprint(forDeviceType deviceType: String, serial: String) -> DeviceFingerprint? {
-        let fingerprints = loadFingerprints()
-        let normalizedType = normalizeDeviceType(deviceType)
-        let matches = fingerprints.filter { 
-            normalizeDeviceType($0.deviceType) == normalizedType && 
-            $0.serial == serial 
-        }
-        
-        let found = matches
-            .filter { !$0.fingerprint.isEmpty }
-            .sorted { $0.timestamp > $1.timestamp }
-            .first
-            
-        if found != nil {
-            logInfo("✅ Found stored fingerprint")
-        }
-        
-        return found
-    }
-    
+        guard let key = Self.deviceKey(forDeviceType: deviceType),
+              let serialNumber = UInt32(serial, radix: 16) else {
+            return nil
+        }
+        return getFingerprint(family: key.family, model: key.model, serial: serialNumber)
+    }
+
     /// Saves new fingerprint for device
     /// - Parameters:
     ///   - fingerprint: Fingerprint data to save
-    ///   - deviceType: Type/model of device
+    ///   - family: Device family
+    ///   - model: Device model
+    ///   - serial: Serial number of the device
+    /// - Returns: Whether the fingerprint was stored
+    @discardableResult
+    public func saveFingerprint(_ fingerprint: Data, family: dc_family_t, model: UInt32, serial: UInt32) -> Bool {
+        guard !fingerprint.isEmpty else { return false }
+        let status = fingerprint.withUnsafeBytes { bytes in
+            dc_fingerprint_store_set(
+                fingerprintStore, family, model, serial,
+                bytes.bindMemory(to: UInt8.self).baseAddress, UInt32(fingerprint.count)
+            )
+        }
+        guard status == DC_STATUS_SUCCESS else {
+            logError("❌ Failed to save fingerprint (\(status))")
+            return false
+        }
+        logInfo("✅ Saved fingerprint for \(Self.deviceType(family: family, model: model)) (\(String(format: "%08x", serial)))")
+        return true
+    }
+
+    /// Saves new fingerprint for device
+    /// - Parameters:
+    ///   - fingerprint: Fingerprint data to save
+    ///   - deviceType: Device name, as advertised over BLE
     ///   - serial: Serial number of device
-    public func saveFingerprint(_ fingerprint: Data, deviceType: String, serial: String) {
-        var fingerprints = loadFingerprints()
-        let normalizedType = normalizeDeviceType(deviceType)
-        
-        // Remove existing fingerprints for this device
-        fingerprints.removeAll { 
-            normalizeDeviceType($0.deviceType) == normalizedType && 
-            $0.serial == serial 
-        }
-        
-        let newFingerprint = DeviceFingerprint(
-            deviceType: deviceType,
-            serial: serial,
-            fingerprint: fingerprint
-        )
-        
-        fingerprints.append(newFingerprint)
-        saveFingerprints(fingerprints)
-        logInfo("✅ Saved fingerprint for \(normalizedType) (\(serial))")
+    /// - Returns: Whether the fingerprint was stored
+    @discardableResult
+    public func saveFingerprint(_ fingerprint: Data, deviceType: String, serial: String) -> Bool {
+        guard let key = Self.deviceKey(forDeviceType: deviceType),
+              let serialNumber = UInt32(serial, radix: 16) else {
+            logWarning("⚠️ Unknown device \(deviceType) (\(serial)) - fingerprint not saved")
+            return false
+        }
+        return saveFingerprint(fingerprint, family: key.family, model: key.model, serial: serialNumber)
     }
-    
+
+    /// Clears fingerprint for specific device
+    /// - Parameters:
+    ///   - family: Device family
+    ///   - model: Device model
+    ///   - serial: Serial number of the device
+    public func clearFingerprint(family: dc_family_t, model: UInt32, serial: UInt32) {
+        _ = dc_fingerprint_store_remove(fingerprintStore, family, model, serial)
+        logInfo("🗑️ Cleared fingerprint for \(Self.deviceType(family: family, model: model)) (\(String(format: "%08x", serial)))")
+    }
+
     /// Clears fingerprint for specific device
+    /// - Parameters:
+    ///   - deviceType: Device name, as advertised over BLE
+    ///   - serial: Serial number of the device
     public func clearFingerprint(forDeviceType deviceType: String, serial: String) {
-        var fingerprints = loadFingerprints()
-        let normalizedType = normalizeDeviceType(deviceType)
-        fingerprints.removeAll { 
-            normalizeDeviceType($0.deviceType) == normalizedType && 
-            $0.serial == serial 
+        guard let key = Self.deviceKey(forDeviceType: deviceType),
+              let serialNumber = UInt32(serial, radix: 16) else {
+            return
         }
-        saveFingerprints(fingerprints)
-        logInfo("🗑️ Cleared fingerprint for \(normalizedType) (\(serial))")
+        clearFingerprint(family: key.family, model: key.model, serial: serialNumber)
+    }
+
+    /// Key of a device in the stored inter-packet delays
+    private func pacingEntry(family: dc_family_t, model: UInt32, serial: UInt32) -> String {
+        "\(family.rawValue)/\(model)/\(String(format: "%08x", serial))"
     }
-    
+
+    /// Gets the inter-packet delay learned in the last session with a device
+    /// - Parameters:
+    ///   - family: Device family
+    ///   - model: Device model
+    ///   - serial: Serial number of the device
+    /// - Returns: Delay in milliseconds, or nil if none is stored
+    public func getPacing(family: dc_family_t, model: UInt32, serial: UInt32) -> UInt32? {
+        let pacing = UserDefaults.standard.dictionary(forKey: pacingKey) as? [String: Int]
+        guard let delay = pacing?[pacingEntry(family: family, model: model, serial: serial)], delay >= 0 else {
+            return nil
+        }
+        return UInt32(delay)
+    }
+
+    /// Saves the inter-packet delay learned during a session with a device
+    /// - Parameters:
+    ///   - delay: Delay in milliseconds, as returned by dc_device_get_pacing
+    ///   - family: Device family
+    ///   - model: Device model
+    ///   - serial: Serial number of the device
+    public func savePacing(_ delay: UInt32, family: dc_family_t, model: UInt32, serial: UInt32) {
+        var pacing = (UserDefaults.standard.dictionary(forKey: pacingKey) as? [String: Int]) ?? [:]
+        pacing[pacingEntry(family: family, model: model, serial: serial)] = Int(delay)
+        UserDefaults.standard.set(pacing, forKey: pacingKey)
+    }
+
+    /// Clears the inter-packet delay stored for a device
+    /// - Parameters:
+    ///   - family: Device family
+    ///   - model: Device model
+    ///   - serial: Serial number of the device
+    public func clearPacing(family: dc_family_t, model: UInt32, serial: UInt32) {
+        guard var pacing = UserDefaults.standard.dictionary(forKey: pacingKey) as? [String: Int] else {
+            return
+        }
+        pacing.removeValue(forKey: pacingEntry(family: family, model: model, serial: serial))
+        UserDefaults.standard.set(pacing, forKey: pacingKey)
+    }
+
     /// Clears all stored fingerprints
     public func clearAllFingerprints() {
-        UserDefaults.standard.removeObject(forKey: fingerprintKey)
+        _ = dc_fingerprint_store_clear(fingerprintStore)
         logInfo("🗑️ Cleared all fingerprints")
     }
-} 
\ No newline at end of file
+}
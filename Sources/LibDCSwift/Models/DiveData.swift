@@ -89,6 +89,32 @@ public struct DiveProfilePoint {
     }
 }
 
+/// Statistics derived from the samples of a dive by libdivecomputer
+public struct DiveStatistics {
+    /// Gas consumption of a single tank, between its first and last pressure sample
+    public struct Consumption {
+        public let beginPressure: Double
+        public let endPressure: Double
+        public let duration: TimeInterval
+        public let sac: Double?  // Bar/min at the surface
+        public let rmv: Double?  // Liter/min at the surface, needs the tank volume
+    }
+
+    public let divetime: TimeInterval
+    public let maxDepth: Double
+    public let avgDepth: Double  // Time weighted
+    public let maxAscentRate: Double  // m/min
+    public let maxDescentRate: Double  // m/min
+    public let ascentRateStep: Double  // Bin width of the rate histograms in m/min
+    public let ascentTime: [TimeInterval]  // Time per ascent rate bin
+    public let descentTime: [TimeInterval]  // Time per descent rate bin
+    public let depthStep: Double  // Bin width of the depth histogram in meters
+    public let timeAtDepth: [TimeInterval]  // Time per depth bin
+    public let minTemperature: Double?
+    public let maxTemperature: Double?
+    public let tanks: [Consumption]
+}
+
 public struct GasMix {
     public let helium: Double
     public let oxygen: Double
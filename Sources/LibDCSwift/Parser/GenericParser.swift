@@ -382,6 +382,147 @@ public class GenericParser {
         )
     }
     
+    /// Decimation modes for display-ready depth profiles
+    public enum ProfileDecimation {
+        case lttb /// Largest-Triangle-Three-Buckets, keeps the visual shape of the profile
+        case minMax /// Shallowest and deepest point per bucket, keeps all extremes
+
+        var asDCDecimation: dc_decimation_t {
+            switch self {
+            case .lttb: return DC_DECIMATION_LTTB
+            case .minMax: return DC_DECIMATION_MINMAX
+            }
+        }
+
+        /// Smallest maxPoints the mode accepts
+        var minimumPoints: Int {
+            switch self {
+            case .lttb: return 3 // First and last point, and at least one bucket
+            case .minMax: return 2
+            }
+        }
+    }
+
+    /// Parses a decimated depth profile for charts, without collecting every sample
+    /// - Parameters:
+    ///   - family: The family of the dive computer
+    ///   - model: The specific model number
+    ///   - diveData: Raw data from the dive computer
+    ///   - dataSize: Size of the raw data
+    ///   - maxPoints: Maximum number of profile points to return
+    ///   - decimation: Decimation mode used when the dive has more samples
+    ///   - context: Optional parser context
+    /// - Returns: At most maxPoints profile points (time and depth only)
+    /// - Throws: ParserError if parsing fails
+    public static func parseProfile(
+        family: DeviceConfiguration.DeviceFamily,
+        model: UInt32,
+        diveData: UnsafePointer<UInt8>,
+        dataSize: Int,
+        maxPoints: Int = 500,
+        decimation: ProfileDecimation = .lttb,
+        context: OpaquePointer? = nil
+    ) throws -> [DiveProfilePoint] {
+        guard maxPoints >= decimation.minimumPoints else {
+            throw ParserError.invalidParameters
+        }
+
+        var parser: OpaquePointer?
+        let rc = create_parser_for_device(&parser, context, family.asDCFamily, model, diveData, size_t(dataSize))
+        guard rc == DC_STATUS_SUCCESS, parser != nil else {
+            logError("❌ Parser creation failed with status: \(rc)")
+            throw ParserError.parserCreationFailed(rc)
+        }
+
+        defer {
+            dc_parser_destroy(parser)
+        }
+
+        var points = [dc_profile_point_t](repeating: dc_profile_point_t(), count: maxPoints)
+        var count: UInt32 = 0
+        let status = dc_parser_get_profile(parser, decimation.asDCDecimation, &points, UInt32(maxPoints), &count)
+        guard status == DC_STATUS_SUCCESS else {
+            throw ParserError.sampleProcessingFailed(status)
+        }
+
+        return points.prefix(Int(count)).map { point in
+            DiveProfilePoint(
+                time: TimeInterval(point.time) / 1000.0,
+                depth: point.depth
+            )
+        }
+    }
+
+    /// Computes the derived statistics of a dive in a single pass over the samples
+    /// - Parameters:
+    ///   - family: The family of the dive computer
+    ///   - model: The specific model number
+    ///   - diveData: Raw data from the dive computer
+    ///   - dataSize: Size of the raw data
+    ///   - context: Optional parser context
+    /// - Returns: Average depth, rate and depth histograms, temperature extrema and gas consumption
+    /// - Throws: ParserError if parsing fails
+    public static func parseStatistics(
+        family: DeviceConfiguration.DeviceFamily,
+        model: UInt32,
+        diveData: UnsafePointer<UInt8>,
+        dataSize: Int,
+        context: OpaquePointer? = nil
+    ) throws -> DiveStatistics {
+        var parser: OpaquePointer?
+        let rc = create_parser_for_device(&parser, context, family.asDCFamily, model, diveData, size_t(dataSize))
+        guard rc == DC_STATUS_SUCCESS, parser != nil else {
+            logError("❌ Parser creation failed with status: \(rc)")
+            throw ParserError.parserCreationFailed(rc)
+        }
+
+        defer {
+            dc_parser_destroy(parser)
+        }
+
+        var stats = dc_statistics_t()
+        let status = dc_parser_get_statistics(parser, &stats)
+        guard status == DC_STATUS_SUCCESS else {
+            throw ParserError.sampleProcessingFailed(status)
+        }
+
+        // Fixed size C arrays are imported as tuples.
+        func array<T>(_ tuple: T, count: Int) -> [Double] {
+            return withUnsafeBytes(of: tuple) { Array($0.bindMemory(to: Double.self).prefix(count)) }
+        }
+        func has(_ field: dc_field_type_t) -> Bool {
+            return stats.fields & (1 << field.rawValue) != 0
+        }
+
+        let tanks = withUnsafeBytes(of: stats.tank) { buffer in
+            Array(buffer.bindMemory(to: dc_consumption_t.self).prefix(Int(stats.tank_count)))
+        }
+
+        return DiveStatistics(
+            divetime: TimeInterval(stats.divetime),
+            maxDepth: stats.maxdepth,
+            avgDepth: stats.avgdepth,
+            maxAscentRate: stats.maxascent,
+            maxDescentRate: stats.maxdescent,
+            ascentRateStep: DC_STATISTICS_RATE_STEP,
+            ascentTime: array(stats.ascent, count: Int(DC_STATISTICS_RATE_BINS)),
+            descentTime: array(stats.descent, count: Int(DC_STATISTICS_RATE_BINS)),
+            depthStep: DC_STATISTICS_DEPTH_STEP,
+            timeAtDepth: array(stats.depth, count: Int(DC_STATISTICS_DEPTH_BINS)),
+            minTemperature: has(DC_FIELD_TEMPERATURE_MINIMUM) ? stats.temperature_minimum : nil,
+            maxTemperature: has(DC_FIELD_TEMPERATURE_MAXIMUM) ? stats.temperature_maximum : nil,
+            tanks: tanks.map { tank in
+                DiveStatistics.Consumption(
+                    beginPressure: tank.beginpressure,
+                    endPressure: tank.endpressure,
+                    duration: tank.duration,
+                    sac: tank.sac > 0 ? tank.sac : nil,
+                    rmv: tank.rmv > 0 ? tank.rmv : nil
+                )
+            }
+        )
+    }
+
     private static func convertTank(_ tank: dc_tank_t) -> DiveData.Tank {
         return DiveData.Tank(
             volume: tank.volume,
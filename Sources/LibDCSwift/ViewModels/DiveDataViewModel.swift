@@ -19,18 +19,6 @@ public class DiveDataViewModel: ObservableObject {
     @Published public var progress: DownloadProgress = .notStarted
     @Published public var hasNewDives: Bool = false
     
-    /// Key format: "fingerprint_{deviceType}_{serial}"
-    private let fingerprintKeyPrefix = "fingerprint_"
-    
-    /// Represents a stored device fingerprint with associated metadata
-    private struct StoredFingerprint: Codable {
-        let deviceType: String
-        let serial: String
-        let fingerprint: Data
-        let timestamp: Date
-    }
-    
-    private let fingerprintKey = "DeviceFingerprints"
     private static weak var activeInstance: DiveDataViewModel?
     public weak var persistence: DiveDataPersistence?
     
@@ -49,49 +37,23 @@ public class DiveDataViewModel: ObservableObject {
         return activeInstance
     }
     
-    /// Loads all stored device fingerprints from persistent storage
-    /// - Returns: Array of StoredFingerprint objects, or empty array if none found
-    private func loadStoredFingerprints() -> [StoredFingerprint] {
-        guard let data = UserDefaults.standard.data(forKey: fingerprintKey),
-              let fingerprints = try? JSONDecoder().decode([StoredFingerprint].self, from: data) else {
-            return []
-        }
-        return fingerprints
-    }
-    
-    /// Saves fingerprints to persistent storage
-    /// - Parameter fingerprints: Array of StoredFingerprint objects to save
-    private func saveStoredFingerprints(_ fingerprints: [StoredFingerprint]) {
-        if let data = try? JSONEncoder().encode(fingerprints) {
-            UserDefaults.standard.set(data, forKey: fingerprintKey)
-        }
-    }
-    
-    /// Normalizes a device type string for consistent comparison
-    /// Uses libdivecomputer's descriptor system and filter matching
-    /// - Parameter deviceType: The device type string to normalize
-    /// - Returns: Normalized device type string
-    private func normalizeDeviceType(_ deviceType: String) -> String {
-        // Try to find matching descriptor using libdivecomputer's filter system
-        var descriptor: OpaquePointer?
-        let status = find_descriptor_by_name(&descriptor, deviceType)
-        
-        if status == DC_STATUS_SUCCESS,
-           let desc = descriptor,
-           let vendor = dc_descriptor_get_vendor(desc),
-           let product = dc_descriptor_get_product(desc) {
-            let normalizedName = "\(String(cString: vendor)) \(String(cString: product))" // Use vendor and product name from descriptor
-            dc_descriptor_free(desc)
-            return normalizedName
-        }
-        
-        // If no match found, return original name
-        return deviceType
+    /// Retrieves stored fingerprint for a specific device
+    /// - Parameters:
+    ///   - family: Device family
+    ///   - model: Device model
+    ///   - serial: Serial number of the device
+    /// - Returns: Stored fingerprint data if found, nil otherwise
+    public func getFingerprint(family: dc_family_t, model: UInt32, serial: UInt32) -> Data? {
+        DeviceFingerprintStorage.shared.getFingerprint(
+            family: family,
+            model: model,
+            serial: serial
+        )?.fingerprint
     }
     
     /// Retrieves stored fingerprint for a specific device
     /// - Parameters:
-    ///   - deviceType: Type/model of the device
+    ///   - deviceType: Device name, as advertised over BLE
     ///   - serial: Serial number of the device
     /// - Returns: Stored fingerprint data if found, nil otherwise
     public func getFingerprint(forDeviceType deviceType: String, serial: String) -> Data? {
@@ -104,7 +66,28 @@ public class DiveDataViewModel: ObservableObject {
     /// Saves a new fingerprint for a device
     /// - Parameters:
     ///   - fingerprint: The fingerprint data to save
-    ///   - deviceType: Type/model of the device
+    ///   - family: Device family
+    ///   - model: Device model
+    ///   - serial: Serial number of the device
+    public func saveFingerprint(_ fingerprint: Data, family: dc_family_t, model: UInt32, serial: UInt32) {
+        guard !fingerprint.isEmpty else {
+            logWarning("⚠️ Attempted to save empty fingerprint - ignoring")
+            return
+        }
+        
+        DeviceFingerprintStorage.shared.saveFingerprint(
+            fingerprint,
+            family: family,
+            model: model,
+            serial: serial
+        )
+        objectWillChange.send()
+    }
+    
+    /// Saves a new fingerprint for a device
+    /// - Parameters:
+    ///   - fingerprint: The fingerprint data to save
+    ///   - deviceType: Device name, as advertised over BLE
     ///   - serial: Serial number of the device
     public func saveFingerprint(_ fingerprint: Data, deviceType: String, serial: String) {
         guard !fingerprint.isEmpty else {
@@ -122,7 +105,21 @@ public class DiveDataViewModel: ObservableObject {
     
     /// Clears the stored fingerprint for a specific device
     /// - Parameters:
-    ///   - deviceType: Type/model of the device
+    ///   - family: Device family
+    ///   - model: Device model
+    ///   - serial: Serial number of the device
+    public func clearFingerprint(family: dc_family_t, model: UInt32, serial: UInt32) {
+        DeviceFingerprintStorage.shared.clearFingerprint(
+            family: family,
+            model: model,
+            serial: serial
+        )
+        objectWillChange.send()
+    }
+    
+    /// Clears the stored fingerprint for a specific device
+    /// - Parameters:
+    ///   - deviceType: Device name, as advertised over BLE
     ///   - serial: Serial number of the device
     public func clearFingerprint(forDeviceType deviceType: String, serial: String) {
         DeviceFingerprintStorage.shared.clearFingerprint(
@@ -320,30 +317,65 @@ public class DiveDataViewModel: ObservableObject {
         }
     }
     
-    func forgetDevice(deviceType: String, serial: String) {
+    /// Forgets a device: removes it from the stored devices and clears its fingerprint
+    /// - Parameters:
+    ///   - family: Device family
+    ///   - model: Device model
+    ///   - serial: Serial number of the device
+    func forgetDevice(family: dc_family_t, model: UInt32, serial: UInt32) {
         if var storedDevices = DeviceStorage.shared.getAllStoredDevices() {
+            let storedFamily = DeviceConfiguration.DeviceFamily(dcFamily: family)
             storedDevices.removeAll { device in
-                device.name == deviceType 
+                device.family == storedFamily && device.model == model
             }
             DeviceStorage.shared.updateStoredDevices(storedDevices)
         }
-        clearFingerprint(forDeviceType: deviceType, serial: serial)
-        objectWillChange.send() 
-        logInfo("🗑️ Cleared fingerprint for \(normalizeDeviceType(deviceType)) (\(serial))")
+        clearFingerprint(family: family, model: model, serial: serial)
+        DeviceFingerprintStorage.shared.clearPacing(family: family, model: model, serial: serial)
     }
     
-    public func isDownloadOnlyNewDivesEnabled(forDeviceType deviceType: String, serial: String) -> Bool {
-        let fingerprints = loadStoredFingerprints()
-        if let storedFingerprint = fingerprints.first(where: { $0.deviceType == deviceType && $0.serial == serial }),
-           !storedFingerprint.fingerprint.isEmpty {
-            logInfo("🔍 Download only new dives is enabled for \(deviceType) (\(serial))")
+    /// Forgets a device: removes it from the stored devices and clears its fingerprint
+    /// - Parameters:
+    ///   - deviceType: Device name, as advertised over BLE
+    ///   - serial: Serial number of the device
+    func forgetDevice(deviceType: String, serial: String) {
+        guard let key = DeviceFingerprintStorage.deviceKey(forDeviceType: deviceType),
+              let serialNumber = UInt32(serial, radix: 16) else {
+            logWarning("⚠️ Unknown device \(deviceType) (\(serial)) - nothing to forget")
+            return
+        }
+        forgetDevice(family: key.family, model: key.model, serial: serialNumber)
+    }
+    
+    /// Whether a fingerprint is stored for the device, so only new dives are downloaded
+    /// - Parameters:
+    ///   - family: Device family
+    ///   - model: Device model
+    ///   - serial: Serial number of the device
+    public func isDownloadOnlyNewDivesEnabled(family: dc_family_t, model: UInt32, serial: UInt32) -> Bool {
+        let name = "\(DeviceFingerprintStorage.deviceType(family: family, model: model)) (\(String(format: "%08x", serial)))"
+        if let storedFingerprint = DeviceFingerprintStorage.shared.getFingerprint(family: family, model: model, serial: serial) {
+            logInfo("🔍 Download only new dives is enabled for \(name)")
             logInfo("📍 Current stored fingerprint: \(storedFingerprint.fingerprint.hexString)")
             return true
         }
-        logInfo("🔍 Download only new dives is disabled for \(deviceType) (\(serial))")
+        logInfo("🔍 Download only new dives is disabled for \(name)")
         return false
     }
     
+    /// Whether a fingerprint is stored for the device, so only new dives are downloaded
+    /// - Parameters:
+    ///   - deviceType: Device name, as advertised over BLE
+    ///   - serial: Serial number of the device
+    public func isDownloadOnlyNewDivesEnabled(forDeviceType deviceType: String, serial: String) -> Bool {
+        guard let key = DeviceFingerprintStorage.deviceKey(forDeviceType: deviceType),
+              let serialNumber = UInt32(serial, radix: 16) else {
+            logInfo("🔍 Download only new dives is disabled for unknown device \(deviceType) (\(serial))")
+            return false
+        }
+        return isDownloadOnlyNewDivesEnabled(family: key.family, model: key.model, serial: serialNumber)
+    }
+    
     public func resetProgress() {
         DispatchQueue.main.async {
             self.progress = .notStarted
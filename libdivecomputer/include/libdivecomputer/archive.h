@@ -0,0 +1,152 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 LibDCSwift contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#ifndef DC_ARCHIVE_H
+#define DC_ARCHIVE_H
+
+#include "common.h"
+#include "context.h"
+#include "datetime.h"
+#include "parser.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Dive archive
+ *
+ * The archive is a file with the raw dive data, as returned by
+ * dc_device_foreach, of any number of dive computers. Every dive is
+ * stored with the family, model and serial number of the dive
+ * computer, its fingerprint, a timestamp and a CRC-32 checksum of the
+ * dive data.
+ *
+ * The file is append-only: new dives, followed by a new index, are
+ * always written after the existing data, and the header is updated
+ * last to point to the new index. An interrupted update leaves the
+ * previous contents of the archive intact. The index is sorted on the
+ * family, model, serial number and fingerprint. The superseded indexes are left
+ * unused, until they take up more than half of the file, and the
+ * writer compacts the archive. Adding the dives in batches, with one
+ * writer per download, keeps that overhead small. Only one writer can
+ * be open at a time.
+ *
+ * For reading, the archive is memory mapped. The entries point into
+ * the mapping, and remain valid until the archive is closed. Dives
+ * are looked up with a binary search, and the data can be passed to
+ * dc_parser_new2 directly, without an intermediate copy. Once opened,
+ * the archive is read-only and can be accessed concurrently from
+ * multiple threads.
+ */
+
+typedef struct dc_archive_t dc_archive_t;
+typedef struct dc_archive_writer_t dc_archive_writer_t;
+
+typedef struct dc_archive_entry_t {
+	dc_family_t family;
+	unsigned int model;
+	unsigned int serial;
+	dc_ticks_t timestamp;
+	const unsigned char *data;
+	unsigned int size;
+	const unsigned char *fingerprint;
+	unsigned int fsize;
+	unsigned int checksum; /* CRC-32 of the dive data */
+} dc_archive_entry_t;
+
+typedef int (*dc_archive_callback_t) (const dc_archive_entry_t *entry, void *userdata);
+
+dc_status_t
+dc_archive_open (dc_archive_t **archive, dc_context_t *context, const char *filename);
+
+unsigned int
+dc_archive_get_count (dc_archive_t *archive);
+
+dc_status_t
+dc_archive_get_entry (dc_archive_t *archive, unsigned int n, dc_archive_entry_t *entry);
+
+/*
+ * Find the dive with the fingerprint of the given dive computer.
+ * Returns DC_STATUS_DONE if the dive is not in the archive.
+ */
+dc_status_t
+dc_archive_lookup (dc_archive_t *archive, dc_family_t family, unsigned int model, unsigned int serial, const unsigned char fingerprint[], unsigned int fsize, dc_archive_entry_t *entry);
+
+/*
+ * Invoke the callback for every dive, in the order of the index.
+ * Returning zero from the callback stops the iteration.
+ */
+dc_status_t
+dc_archive_foreach (dc_archive_t *archive, dc_archive_callback_t callback, void *userdata);
+
+/*
+ * Compare the checksum of every dive with its data.
+ */
+dc_status_t
+dc_archive_verify (dc_archive_t *archive);
+
+/*
+ * Create a parser for the dive, from the family and model stored in
+ * the archive.
+ */
+dc_status_t
+dc_archive_parser_new (dc_parser_t **parser, dc_archive_t *archive, const dc_archive_entry_t *entry);
+
+void
+dc_archive_close (dc_archive_t *archive);
+
+/*
+ * Open the archive for appending dives, or create a new one. The
+ * dives are only visible to readers after dc_archive_writer_close.
+ */
+dc_status_t
+dc_archive_writer_new (dc_archive_writer_t **writer, dc_context_t *context, const char *filename);
+
+/*
+ * Append a dive. The fingerprint is required. The serial number, as
+ * reported by the DC_EVENT_DEVINFO event, keeps the dives of two dive
+ * computers of the same model apart. Returns DC_STATUS_DONE if a dive
+ * with the same fingerprint of the same dive computer is already
+ * present in the archive. Duplicates added to the same writer
+ * are dropped from the index, keeping the first one.
+ */
+dc_status_t
+dc_archive_writer_add (dc_archive_writer_t *writer, dc_family_t family, unsigned int model, unsigned int serial, dc_ticks_t timestamp, const unsigned char data[], unsigned int size, const unsigned char fingerprint[], unsigned int fsize);
+
+/*
+ * Write the index, commit the new dives and close the writer.
+ */
+dc_status_t
+dc_archive_writer_close (dc_archive_writer_t *writer);
+
+/*
+ * Rewrite the archive without the unused space, and replace the file
+ * once the new contents are on disk. Readers that already have the
+ * archive open keep the old contents. No writer may be open.
+ */
+dc_status_t
+dc_archive_compact (dc_context_t *context, const char *filename);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* DC_ARCHIVE_H */
@@ -60,6 +60,13 @@ extern "C" {
 #define DC_IOCTL_BLE_CHARACTERISTIC_READ  DC_IOCTL_IOR('b', 3, DC_IOCTL_SIZE_VARIABLE)
 #define DC_IOCTL_BLE_CHARACTERISTIC_WRITE DC_IOCTL_IOW('b', 3, DC_IOCTL_SIZE_VARIABLE)
 
+/**
+ * Get the maximum payload size of a single BLE write.
+ *
+ * The data format is an unsigned int.
+ */
+#define DC_IOCTL_BLE_GET_MTU   DC_IOCTL_IOR('b', 4, sizeof(unsigned int))
+
 /**
  * The minimum number of bytes (including the terminating null byte) for
  * formatting a bluetooth UUID as a string.
@@ -0,0 +1,74 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 LibDCSwift contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#ifndef DC_BUHLMANN_H
+#define DC_BUHLMANN_H
+
+#include "common.h"
+#include "parser.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Buhlmann ZHL-16C tissue replay
+ *
+ * The engine captures the profile of a dive (time, ambient pressure,
+ * breathing gas and CCR setpoint) from the samples of a parser once,
+ * after which it can be replayed any number of times, for example with
+ * different gradient factors. The parser is not needed after creation.
+ *
+ * A replay produces one value per profile point (one per time sample):
+ *
+ *   ceiling: The ceiling in meters, using the gradient factors. The
+ *            GF low anchor is the deepest GF low ceiling so far.
+ *   gf99:    The supersaturation of the leading compartment, as a
+ *            percentage of its M-value at the current depth.
+ *   tts:     The time to surface in seconds, ascending at 10 m/min
+ *            with 3 m stop increments on the current gas.
+ *
+ * Any of the output arrays can be NULL, and the time to surface (which
+ * simulates an ascent for every point) is only calculated on request.
+ * Each array must hold dc_buhlmann_get_count elements.
+ */
+
+typedef struct dc_buhlmann_t dc_buhlmann_t;
+
+dc_status_t
+dc_buhlmann_new (dc_buhlmann_t **engine, dc_parser_t *parser);
+
+unsigned int
+dc_buhlmann_get_count (dc_buhlmann_t *engine);
+
+dc_status_t
+dc_buhlmann_get_profile (dc_buhlmann_t *engine, unsigned int time[], double depth[]);
+
+dc_status_t
+dc_buhlmann_replay (dc_buhlmann_t *engine, unsigned int gflow, unsigned int gfhigh, double ceiling[], double gf99[], unsigned int tts[]);
+
+void
+dc_buhlmann_free (dc_buhlmann_t *engine);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* DC_BUHLMANN_H */
@@ -85,6 +85,12 @@ dc_device_set_events (dc_device_t *device, unsigned int events, dc_event_callbac
 dc_status_t
 dc_device_set_fingerprint (dc_device_t *device, const unsigned char data[], unsigned int size);
 
+dc_status_t
+dc_device_get_pacing (dc_device_t *device, unsigned int *delay);
+
+dc_status_t
+dc_device_set_pacing (dc_device_t *device, unsigned int delay);
+
 dc_status_t
 dc_device_read (dc_device_t *device, unsigned int address, unsigned char data[], unsigned int size);
 
@@ -0,0 +1,91 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 LibDCSwift contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#ifndef DC_DIVEINDEX_H
+#define DC_DIVEINDEX_H
+
+#include "common.h"
+#include "context.h"
+#include "descriptor.h"
+#include "device.h"
+#include "buffer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Dive index
+ *
+ * For the families that download the entire memory of the dive
+ * computer, the dive boundaries can be located in a memory dump
+ * (obtained with dc_device_dump) without a connection to the device.
+ * The index records the location and fingerprint of every dive, in
+ * the same order as dc_device_foreach (newest dive first).
+ *
+ * Dives that are stored contiguously in the dump reference the dump
+ * directly, and the dump must therefore remain valid (and unmodified)
+ * for the lifetime of the index. Dives that wrap around a ringbuffer
+ * are reassembled in memory owned by the index, and have their offset
+ * set to DC_DIVEINDEX_DETACHED.
+ *
+ * Once created, the index is read-only. Entries can be retrieved
+ * concurrently from multiple threads, which allows the dives to be
+ * parsed in parallel.
+ */
+
+#define DC_DIVEINDEX_DETACHED 0xFFFFFFFF
+
+typedef struct dc_diveindex_t dc_diveindex_t;
+
+typedef struct dc_diveindex_entry_t {
+	unsigned int offset; /* Offset in the dump, or DC_DIVEINDEX_DETACHED */
+	const unsigned char *data;
+	unsigned int size;
+	const unsigned char *fingerprint;
+	unsigned int fsize;
+} dc_diveindex_entry_t;
+
+dc_status_t
+dc_diveindex_new (dc_diveindex_t **index, dc_context_t *context, dc_descriptor_t *descriptor, dc_buffer_t *dump);
+
+unsigned int
+dc_diveindex_get_count (dc_diveindex_t *index);
+
+dc_status_t
+dc_diveindex_get_entry (dc_diveindex_t *index, unsigned int n, dc_diveindex_entry_t *entry);
+
+/*
+ * Invoke the callback for every dive in the index, distributed over
+ * the requested number of threads (where supported). The callback is
+ * called concurrently and must be thread-safe. Returning zero from the
+ * callback stops the dispatching of the remaining dives.
+ */
+dc_status_t
+dc_diveindex_foreach (dc_diveindex_t *index, unsigned int nthreads, dc_dive_callback_t callback, void *userdata);
+
+void
+dc_diveindex_free (dc_diveindex_t *index);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* DC_DIVEINDEX_H */
@@ -0,0 +1,88 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 LibDCSwift contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#ifndef DC_FINGERPRINT_H
+#define DC_FINGERPRINT_H
+
+#include "common.h"
+#include "context.h"
+#include "datetime.h"
+#include "buffer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Fingerprint store
+ *
+ * The store keeps the fingerprint of the most recent dive downloaded
+ * from every dive computer, identified by its family, model and serial
+ * number, together with the time it was stored. The fingerprints are
+ * kept in a hash table in memory, and every change is written to a
+ * temporary file which then replaces the store file, so the file always
+ * contains either the old or the new contents. A missing file is an
+ * empty store.
+ *
+ * The store can be used from multiple threads, but only one store
+ * should be open for the same file.
+ */
+
+typedef struct dc_fingerprint_store_t dc_fingerprint_store_t;
+
+typedef int (*dc_fingerprint_callback_t) (dc_family_t family, unsigned int model, unsigned int serial, const unsigned char fingerprint[], unsigned int fsize, dc_ticks_t timestamp, void *userdata);
+
+dc_status_t
+dc_fingerprint_store_open (dc_fingerprint_store_t **store, dc_context_t *context, const char *filename);
+
+/*
+ * Copy the fingerprint of the dive computer into the buffer. Returns
+ * DC_STATUS_DONE if no fingerprint is stored. The timestamp is
+ * optional.
+ */
+dc_status_t
+dc_fingerprint_store_get (dc_fingerprint_store_t *store, dc_family_t family, unsigned int model, unsigned int serial, dc_buffer_t *fingerprint, dc_ticks_t *timestamp);
+
+dc_status_t
+dc_fingerprint_store_set (dc_fingerprint_store_t *store, dc_family_t family, unsigned int model, unsigned int serial, const unsigned char fingerprint[], unsigned int fsize);
+
+dc_status_t
+dc_fingerprint_store_remove (dc_fingerprint_store_t *store, dc_family_t family, unsigned int model, unsigned int serial);
+
+dc_status_t
+dc_fingerprint_store_clear (dc_fingerprint_store_t *store);
+
+/*
+ * Invoke the callback for every stored fingerprint, in no particular
+ * order. The store is locked during the iteration, and the callback
+ * must not use it. Returning zero from the callback stops the
+ * iteration.
+ */
+dc_status_t
+dc_fingerprint_store_foreach (dc_fingerprint_store_t *store, dc_fingerprint_callback_t callback, void *userdata);
+
+void
+dc_fingerprint_store_close (dc_fingerprint_store_t *store);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* DC_FINGERPRINT_H */
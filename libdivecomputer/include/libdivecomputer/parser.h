@@ -49,6 +49,9 @@ typedef enum dc_sample_type_t {
 	DC_SAMPLE_GASMIX
 } dc_sample_type_t;
 
+#define DC_SAMPLE_MASK(type) (1u << (type))
+#define DC_SAMPLE_MASK_ALL ((1u << (DC_SAMPLE_GASMIX + 1)) - 1)
+
 typedef enum dc_field_type_t {
 	DC_FIELD_DIVETIME,
 	DC_FIELD_MAXDEPTH,
@@ -247,6 +250,104 @@ typedef struct dc_location_t {
 	double altitude;
 } dc_location_t;
 
+#define DC_FIELD_MASK(type) (1u << (type))
+
+/*
+ * Dive summary
+ *
+ * All the non-indexed fields of a dive in a single structure. The
+ * fields member is a mask (DC_FIELD_MASK) with the fields that are
+ * available. The indexed fields (DC_FIELD_GASMIX and DC_FIELD_TANK)
+ * are not part of the summary, use dc_parser_get_field to retrieve them.
+ */
+typedef struct dc_summary_t {
+	unsigned int fields;
+	unsigned int divetime;
+	double maxdepth;
+	double avgdepth;
+	unsigned int gasmix_count;
+	dc_salinity_t salinity;
+	double atmospheric;
+	double temperature_surface;
+	double temperature_minimum;
+	double temperature_maximum;
+	unsigned int tank_count;
+	dc_divemode_t divemode;
+	dc_decomodel_t decomodel;
+	dc_location_t location;
+} dc_summary_t;
+
+/*
+ * Dive statistics
+ *
+ * Statistics derived from the samples in a single pass. The fields
+ * member is a mask (DC_FIELD_MASK) with the values that are available:
+ * DC_FIELD_DIVETIME, DC_FIELD_MAXDEPTH and DC_FIELD_AVGDEPTH when the
+ * dive has time samples, DC_FIELD_TEMPERATURE_MINIMUM and
+ * DC_FIELD_TEMPERATURE_MAXIMUM when it has temperature samples, and
+ * DC_FIELD_TANK_COUNT when it has pressure samples.
+ *
+ * The average depth is time weighted. The ascent and descent rates are
+ * calculated between consecutive samples, and the time spent at each
+ * rate (in steps of DC_STATISTICS_RATE_STEP m/min) is accumulated in
+ * the ascent and descent histograms. The depth histogram contains the
+ * time spent in each depth range of DC_STATISTICS_DEPTH_STEP meters.
+ * The last bin of every histogram also contains everything beyond it.
+ *
+ * The gas consumption of a tank covers the time between its first and
+ * last pressure sample. The SAC rate is the pressure drop per minute at
+ * surface pressure, and the RMV (only available when the tank volume is
+ * known) the corresponding volume of gas at the surface.
+ */
+#define DC_STATISTICS_RATE_STEP   3.0  /* m/min */
+#define DC_STATISTICS_RATE_BINS   8
+#define DC_STATISTICS_DEPTH_STEP  5.0  /* m */
+#define DC_STATISTICS_DEPTH_BINS  20
+#define DC_STATISTICS_TANKS       8
+
+typedef struct dc_consumption_t {
+	double beginpressure; /* Bar */
+	double endpressure;   /* Bar */
+	double duration;      /* Seconds */
+	double sac;           /* Bar/min */
+	double rmv;           /* Liter/min */
+} dc_consumption_t;
+
+typedef struct dc_statistics_t {
+	unsigned int fields;
+	unsigned int divetime;
+	double maxdepth;
+	double avgdepth;
+	double maxascent;  /* m/min */
+	double maxdescent; /* m/min */
+	double ascent[DC_STATISTICS_RATE_BINS];   /* Seconds */
+	double descent[DC_STATISTICS_RATE_BINS];  /* Seconds */
+	double depth[DC_STATISTICS_DEPTH_BINS];   /* Seconds */
+	double temperature_minimum;
+	double temperature_maximum;
+	unsigned int tank_count;
+	dc_consumption_t tank[DC_STATISTICS_TANKS];
+} dc_statistics_t;
+
+/*
+ * Profile decimation
+ *
+ * DC_DECIMATION_LTTB: Largest-Triangle-Three-Buckets, which keeps the
+ * visual shape of the profile with exactly the requested number of
+ * points.
+ * DC_DECIMATION_MINMAX: The shallowest and deepest point of every
+ * bucket, which preserves all the extremes (e.g. short excursions).
+ */
+typedef enum dc_decimation_t {
+	DC_DECIMATION_LTTB,
+	DC_DECIMATION_MINMAX
+} dc_decimation_t;
+
+typedef struct dc_profile_point_t {
+	unsigned int time; /* Milliseconds */
+	double depth;
+} dc_profile_point_t;
+
 typedef union dc_sample_value_t {
 	unsigned int time; /* Milliseconds */
 	double depth;
@@ -306,15 +407,27 @@ dc_parser_set_atmospheric (dc_parser_t *parser, double atmospheric);
 dc_status_t
 dc_parser_set_density (dc_parser_t *parser, double density);
 
+dc_status_t
+dc_parser_set_sample_mask (dc_parser_t *parser, unsigned int mask);
+
 dc_status_t
 dc_parser_get_datetime (dc_parser_t *parser, dc_datetime_t *datetime);
 
 dc_status_t
 dc_parser_get_field (dc_parser_t *parser, dc_field_type_t type, unsigned int flags, void *value);
 
+dc_status_t
+dc_parser_get_summary (dc_parser_t *parser, dc_summary_t *summary, unsigned int fields);
+
+dc_status_t
+dc_parser_get_statistics (dc_parser_t *parser, dc_statistics_t *statistics);
+
 dc_status_t
 dc_parser_samples_foreach (dc_parser_t *parser, dc_sample_callback_t callback, void *userdata);
 
+dc_status_t
+dc_parser_get_profile (dc_parser_t *parser, dc_decimation_t decimation, dc_profile_point_t points[], unsigned int maxpoints, unsigned int *npoints);
+
 dc_status_t
 dc_parser_destroy (dc_parser_t *parser);
 
@@ -0,0 +1,88 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 LibDCSwift contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#ifndef DC_SYNTHETIC_H
+#define DC_SYNTHETIC_H
+
+#include "common.h"
+#include "context.h"
+#include "buffer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Synthetic dive logs
+ *
+ * The generator produces raw dive data, in the format downloaded from
+ * the dive computer, for a dive of arbitrary length. The data can be
+ * fed to the parser of the family returned by dc_synthetic_get_family,
+ * which makes it possible to measure the parsers on inputs much larger
+ * than real dives, without the need for any hardware.
+ *
+ * The dive consists of a descent, a bottom phase with a slowly varying
+ * depth, and an ascent with a safety stop. The tanks are breathed one
+ * after the other, and bookmarks are placed at random samples, at the
+ * requested average rate. The same parameters (including the seed)
+ * always produce the same data.
+ *
+ * The number of tanks is limited to what the format can store (none for
+ * the Shearwater Predator, which has no bookmarks either), and formats
+ * with a fixed sample rate (the Shearwater Predator with 10 seconds, and
+ * the Uwatec Galileo with 4 seconds) ignore the interval.
+ * The Shearwater LRE format is the Petrel format, compressed the way it
+ * is transferred by the dive computer. It needs to be decompressed with
+ * dc_synthetic_decompress before it can be parsed. For the other formats,
+ * the data is copied unchanged.
+ */
+
+typedef enum dc_synthetic_format_t {
+	DC_SYNTHETIC_SHEARWATER_PREDATOR,
+	DC_SYNTHETIC_SHEARWATER_PETREL,
+	DC_SYNTHETIC_SHEARWATER_LRE,
+	DC_SYNTHETIC_HW_OSTC3,
+	DC_SYNTHETIC_SUUNTO_EONSTEEL,
+	DC_SYNTHETIC_UWATEC_GALILEO,
+} dc_synthetic_format_t;
+
+typedef struct dc_synthetic_t {
+	unsigned int duration; /* Dive time (seconds) */
+	unsigned int interval; /* Sample interval (seconds) */
+	double maxdepth;       /* Maximum depth (meters) */
+	unsigned int ntanks;   /* Number of tanks */
+	double events;         /* Bookmarks per hour */
+	unsigned int seed;
+} dc_synthetic_t;
+
+dc_status_t
+dc_synthetic_get_family (dc_synthetic_format_t format, dc_family_t *family, unsigned int *model);
+
+dc_status_t
+dc_synthetic_generate (dc_context_t *context, dc_synthetic_format_t format, const dc_synthetic_t *params, dc_buffer_t *buffer);
+
+dc_status_t
+dc_synthetic_decompress (dc_context_t *context, dc_synthetic_format_t format, const unsigned char data[], unsigned int size, dc_buffer_t *buffer);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* DC_SYNTHETIC_H */
@@ -60,6 +60,17 @@ NOTE:   String length must be evenly divisible by 16byte (str_len % 16 == 0)
 #include <string.h> // CBC mode, for memset
 #include "aes.h"
 
+// Use the AES instructions of the processor, when the compiler targets
+// a processor that has them (e.g. -maes on x86, or any ARMv8 with the
+// cryptography extension, such as all Apple arm64 devices).
+#if defined(__AES__) && defined(__SSE2__)
+  #include <wmmintrin.h>
+  #define AES_X86_AESNI
+#elif (defined(__ARM_FEATURE_AES) || defined(__ARM_FEATURE_CRYPTO)) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+  #include <arm_neon.h>
+  #define AES_ARMV8_CRYPTO
+#endif
+
 
 /*****************************************************************************/
 /* Defines:                                                                  */
@@ -491,6 +502,48 @@ void AES128_ECB_encrypt(uint8_t* input, const uint8_t* key, uint8_t* output)
   Cipher(&state);
 }
 
+void AES128_key_expand(aes128_key_t* expanded, const uint8_t* key)
+{
+  aes_state_t state;
+
+  state.Key = key;
+  KeyExpansion(&state);
+
+  memcpy(expanded->RoundKey, state.RoundKey, sizeof(expanded->RoundKey));
+}
+
+void AES128_ECB_encrypt_expanded(const uint8_t* input, const aes128_key_t* expanded, uint8_t* output)
+{
+#if defined(AES_X86_AESNI)
+  const __m128i* rk = (const __m128i*) expanded->RoundKey;
+  __m128i block = _mm_loadu_si128((const __m128i*) input);
+  block = _mm_xor_si128(block, _mm_loadu_si128(rk));
+  for (uint8_t round = 1; round < Nr; ++round)
+  {
+    block = _mm_aesenc_si128(block, _mm_loadu_si128(rk + round));
+  }
+  block = _mm_aesenclast_si128(block, _mm_loadu_si128(rk + Nr));
+  _mm_storeu_si128((__m128i*) output, block);
+#elif defined(AES_ARMV8_CRYPTO)
+  const uint8_t* rk = expanded->RoundKey;
+  uint8x16_t block = vld1q_u8(input);
+  for (uint8_t round = 0; round < Nr - 1; ++round)
+  {
+    block = vaesmcq_u8(vaeseq_u8(block, vld1q_u8(rk + round * KEYLEN)));
+  }
+  block = vaeseq_u8(block, vld1q_u8(rk + (Nr - 1) * KEYLEN));
+  block = veorq_u8(block, vld1q_u8(rk + Nr * KEYLEN));
+  vst1q_u8(output, block);
+#else
+  aes_state_t state;
+  memcpy(state.RoundKey, expanded->RoundKey, sizeof(state.RoundKey));
+  memmove(output, input, KEYLEN);
+  state.state = (state_t*)output;
+
+  Cipher(&state);
+#endif
+}
+
 void AES128_ECB_decrypt(uint8_t* input, const uint8_t* key, uint8_t *output)
 {
   aes_state_t state;
@@ -53,9 +53,18 @@ typedef unsigned int  uint32_t;
 
 #if defined(ECB) && ECB
 
+// The expanded key, for encrypting a stream of blocks with the same key
+// without repeating the key expansion for every block.
+typedef struct aes128_key_t {
+  uint8_t RoundKey[176];
+} aes128_key_t;
+
 void AES128_ECB_encrypt(uint8_t* input, const uint8_t* key, uint8_t *output);
 void AES128_ECB_decrypt(uint8_t* input, const uint8_t* key, uint8_t *output);
 
+void AES128_key_expand(aes128_key_t* expanded, const uint8_t* key);
+void AES128_ECB_encrypt_expanded(const uint8_t* input, const aes128_key_t* expanded, uint8_t *output);
+
 #endif // #if defined(ECB) && ECB
 
 
@@ -0,0 +1,969 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 LibDCSwift contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdint.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOGDI
+#include <windows.h>
+#include <io.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <libdivecomputer/archive.h>
+
+#include "context-private.h"
+#include "parser-private.h"
+#include "checksum.h"
+#include "array.h"
+
+/*
+ * File format (all values little endian):
+ *
+ * The header contains the location of the current index. It is the
+ * only part of the file that is ever overwritten.
+ *
+ *    0  magic "DCAR"
+ *    4  version
+ *    8  index offset (64 bit)
+ *   16  number of dives
+ *   20  CRC-32 of the index
+ *   24  reserved
+ *   28  CRC-32 of the header
+ *
+ * Every dive is stored as the fingerprint immediately followed by the
+ * dive data. The index has one entry per dive, sorted on the family,
+ * model, serial number and fingerprint:
+ *
+ *    0  family
+ *    4  model
+ *    8  timestamp (64 bit)
+ *   16  offset of the fingerprint (64 bit)
+ *   24  fingerprint size
+ *   28  dive size
+ *   32  CRC-32 of the dive data
+ *   36  serial number
+ */
+
+#define VERSION   1
+#define SZ_HEADER 32
+#define SZ_ENTRY  40
+
+static const unsigned char magic[] = {'D', 'C', 'A', 'R'};
+
+struct dc_archive_t {
+	dc_context_t *context;
+	const unsigned char *data;
+	size_t size;
+	const unsigned char *index;
+	unsigned long long ioffset;
+	unsigned int count;
+};
+
+typedef struct dc_archive_record_t {
+	dc_family_t family;
+	unsigned int model;
+	unsigned int serial;
+	dc_ticks_t timestamp;
+	unsigned long long offset;
+	unsigned int fsize;
+	unsigned int size;
+	unsigned int checksum;
+	unsigned int sequence;
+	size_t foffset;
+	const unsigned char *fingerprint;
+} dc_archive_record_t;
+
+struct dc_archive_writer_t {
+	dc_context_t *context;
+	char *filename;
+	// Current contents of the archive, or NULL for a new archive.
+	dc_archive_t *archive;
+	FILE *fp;
+	unsigned long long position;
+	// Dives added by this writer, and a copy of their fingerprints.
+	dc_archive_record_t *records;
+	unsigned int count;
+	unsigned int capacity;
+	dc_buffer_t *fingerprints;
+	dc_status_t status;
+	// Size of the header, dives and index that are in use.
+	unsigned long long used;
+};
+
+static int
+dc_archive_compare (dc_family_t family1, unsigned int model1, unsigned int serial1, const unsigned char fingerprint1[], unsigned int fsize1,
+	dc_family_t family2, unsigned int model2, unsigned int serial2, const unsigned char fingerprint2[], unsigned int fsize2)
+{
+	if (family1 != family2)
+		return (unsigned int) family1 < (unsigned int) family2 ? -1 : 1;
+	if (model1 != model2)
+		return model1 < model2 ? -1 : 1;
+	if (serial1 != serial2)
+		return serial1 < serial2 ? -1 : 1;
+
+	int cmp = memcmp (fingerprint1, fingerprint2, fsize1 < fsize2 ? fsize1 : fsize2);
+	if (cmp != 0)
+		return cmp;
+	if (fsize1 != fsize2)
+		return fsize1 < fsize2 ? -1 : 1;
+
+	return 0;
+}
+
+static dc_status_t
+dc_archive_map (dc_archive_t *archive, const char *filename)
+{
+#ifdef _WIN32
+	HANDLE hFile = CreateFileA (filename, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+		NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (hFile == INVALID_HANDLE_VALUE) {
+		ERROR (archive->context, "Failed to open the archive.");
+		return DC_STATUS_IO;
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx (hFile, &size)) {
+		ERROR (archive->context, "Failed to get the archive size.");
+		CloseHandle (hFile);
+		return DC_STATUS_IO;
+	}
+
+	if ((unsigned long long) size.QuadPart > SIZE_MAX) {
+		ERROR (archive->context, "Archive too large to map.");
+		CloseHandle (hFile);
+		return DC_STATUS_NOMEMORY;
+	}
+
+	if (size.QuadPart == 0) {
+		CloseHandle (hFile);
+		return DC_STATUS_SUCCESS;
+	}
+
+	// The view remains valid after closing the handles.
+	HANDLE hMapping = CreateFileMappingA (hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle (hFile);
+	if (hMapping == NULL) {
+		ERROR (archive->context, "Failed to map the archive.");
+		return DC_STATUS_IO;
+	}
+
+	void *data = MapViewOfFile (hMapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle (hMapping);
+	if (data == NULL) {
+		ERROR (archive->context, "Failed to map the archive.");
+		return DC_STATUS_IO;
+	}
+#else
+	int fd = open (filename, O_RDONLY);
+	if (fd < 0) {
+		ERROR (archive->context, "Failed to open the archive.");
+		return DC_STATUS_IO;
+	}
+
+	struct stat st;
+	if (fstat (fd, &st) != 0) {
+		ERROR (archive->context, "Failed to get the archive size.");
+		close (fd);
+		return DC_STATUS_IO;
+	}
+
+	if ((unsigned long long) st.st_size > SIZE_MAX) {
+		ERROR (archive->context, "Archive too large to map.");
+		close (fd);
+		return DC_STATUS_NOMEMORY;
+	}
+
+	if (st.st_size == 0) {
+		close (fd);
+		return DC_STATUS_SUCCESS;
+	}
+
+	// The mapping remains valid after closing the file descriptor.
+	void *data = mmap (NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close (fd);
+	if (data == MAP_FAILED) {
+		ERROR (archive->context, "Failed to map the archive.");
+		return DC_STATUS_IO;
+	}
+#endif
+
+	archive->data = (const unsigned char *) data;
+#ifdef _WIN32
+	archive->size = size.QuadPart;
+#else
+	archive->size = st.st_size;
+#endif
+
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+dc_archive_load (dc_archive_t *archive)
+{
+	const unsigned char *data = archive->data;
+
+	if (archive->size < SZ_HEADER || memcmp (data, magic, sizeof (magic)) != 0) {
+		ERROR (archive->context, "Invalid archive header.");
+		return DC_STATUS_DATAFORMAT;
+	}
+
+	unsigned int version = array_uint32_le (data + 4);
+	if (version != VERSION) {
+		ERROR (archive->context, "Unsupported archive version (%u).", version);
+		return DC_STATUS_UNSUPPORTED;
+	}
+
+	if (checksum_crc32r (data, SZ_HEADER - 4) != array_uint32_le (data + SZ_HEADER - 4)) {
+		ERROR (archive->context, "Unexpected archive header checksum.");
+		return DC_STATUS_DATAFORMAT;
+	}
+
+	unsigned long long ioffset = array_uint64_le (data + 8);
+	unsigned int count = array_uint32_le (data + 16);
+	if (ioffset < SZ_HEADER || ioffset > archive->size ||
+		count > UINT_MAX / SZ_ENTRY ||
+		(unsigned long long) count * SZ_ENTRY > archive->size - ioffset) {
+		ERROR (archive->context, "Invalid archive index.");
+		return DC_STATUS_DATAFORMAT;
+	}
+
+	if (checksum_crc32r (data + ioffset, count * SZ_ENTRY) != array_uint32_le (data + 20)) {
+		ERROR (archive->context, "Unexpected archive index checksum.");
+		return DC_STATUS_DATAFORMAT;
+	}
+
+	archive->index = data + ioffset;
+	archive->ioffset = ioffset;
+	archive->count = count;
+
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+dc_archive_decode (dc_archive_t *archive, unsigned int n, dc_archive_entry_t *entry)
+{
+	const unsigned char *p = archive->index + (size_t) n * SZ_ENTRY;
+
+	// The dive must be located between the header and the index.
+	unsigned long long offset = array_uint64_le (p + 16);
+	unsigned int fsize = array_uint32_le (p + 24);
+	unsigned int size = array_uint32_le (p + 28);
+	if (offset < SZ_HEADER || offset > archive->ioffset ||
+		(unsigned long long) fsize + size > archive->ioffset - offset) {
+		ERROR (archive->context, "Invalid dive record (%u).", n);
+		return DC_STATUS_DATAFORMAT;
+	}
+
+	entry->family = (dc_family_t) array_uint32_le (p);
+	entry->model = array_uint32_le (p + 4);
+	entry->serial = array_uint32_le (p + 36);
+	entry->timestamp = (dc_ticks_t) array_uint64_le (p + 8);
+	entry->fingerprint = archive->data + offset;
+	entry->fsize = fsize;
+	entry->data = archive->data + offset + fsize;
+	entry->size = size;
+	entry->checksum = array_uint32_le (p + 32);
+
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+dc_archive_search (dc_archive_t *archive, dc_family_t family, unsigned int model, unsigned int serial, const unsigned char fingerprint[], unsigned int fsize, dc_archive_entry_t *entry)
+{
+	unsigned int lo = 0, hi = archive->count;
+	while (lo < hi) {
+		unsigned int mid = lo + (hi - lo) / 2;
+		dc_status_t rc = dc_archive_decode (archive, mid, entry);
+		if (rc != DC_STATUS_SUCCESS)
+			return rc;
+
+		int cmp = dc_archive_compare (entry->family, entry->model, entry->serial, entry->fingerprint, entry->fsize,
+			family, model, serial, fingerprint, fsize);
+		if (cmp == 0)
+			return DC_STATUS_SUCCESS;
+		if (cmp < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return DC_STATUS_DONE;
+}
+
+static dc_status_t
+dc_archive_new (dc_archive_t **out, dc_context_t *context, const char *filename)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_archive_t *archive = NULL;
+
+	archive = (dc_archive_t *) malloc (sizeof (dc_archive_t));
+	if (archive == NULL) {
+		ERROR (context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	archive->context = context;
+	archive->data = NULL;
+	archive->size = 0;
+	archive->index = NULL;
+	archive->ioffset = 0;
+	archive->count = 0;
+
+	status = dc_archive_map (archive, filename);
+	if (status != DC_STATUS_SUCCESS) {
+		free (archive);
+		return status;
+	}
+
+	*out = archive;
+
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+dc_archive_open (dc_archive_t **out, dc_context_t *context, const char *filename)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_archive_t *archive = NULL;
+
+	if (out == NULL || filename == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	status = dc_archive_new (&archive, context, filename);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	status = dc_archive_load (archive);
+	if (status != DC_STATUS_SUCCESS)
+		goto error_close;
+
+	*out = archive;
+
+	return DC_STATUS_SUCCESS;
+
+error_close:
+	dc_archive_close (archive);
+	return status;
+}
+
+unsigned int
+dc_archive_get_count (dc_archive_t *archive)
+{
+	if (archive == NULL)
+		return 0;
+
+	return archive->count;
+}
+
+dc_status_t
+dc_archive_get_entry (dc_archive_t *archive, unsigned int n, dc_archive_entry_t *entry)
+{
+	if (archive == NULL || entry == NULL || n >= archive->count)
+		return DC_STATUS_INVALIDARGS;
+
+	return dc_archive_decode (archive, n, entry);
+}
+
+dc_status_t
+dc_archive_lookup (dc_archive_t *archive, dc_family_t family, unsigned int model, unsigned int serial, const unsigned char fingerprint[], unsigned int fsize, dc_archive_entry_t *entry)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_archive_entry_t tmp;
+
+	if (archive == NULL || entry == NULL || (fingerprint == NULL && fsize))
+		return DC_STATUS_INVALIDARGS;
+
+	status = dc_archive_search (archive, family, model, serial, fingerprint, fsize, &tmp);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	*entry = tmp;
+
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+dc_archive_foreach (dc_archive_t *archive, dc_archive_callback_t callback, void *userdata)
+{
+	if (archive == NULL || callback == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	for (unsigned int i = 0; i < archive->count; ++i) {
+		dc_archive_entry_t entry;
+		dc_status_t rc = dc_archive_decode (archive, i, &entry);
+		if (rc != DC_STATUS_SUCCESS)
+			return rc;
+
+		if (!callback (&entry, userdata))
+			break;
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+dc_archive_verify (dc_archive_t *archive)
+{
+	if (archive == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	for (unsigned int i = 0; i < archive->count; ++i) {
+		dc_archive_entry_t entry;
+		dc_status_t rc = dc_archive_decode (archive, i, &entry);
+		if (rc != DC_STATUS_SUCCESS)
+			return rc;
+
+		if (checksum_crc32r (entry.data, entry.size) != entry.checksum) {
+			ERROR (archive->context, "Unexpected dive checksum (%u).", i);
+			return DC_STATUS_DATAFORMAT;
+		}
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+dc_archive_parser_new (dc_parser_t **parser, dc_archive_t *archive, const dc_archive_entry_t *entry)
+{
+	if (archive == NULL || entry == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	return dc_parser_new_internal (parser, archive->context, entry->data, entry->size, entry->family, entry->model);
+}
+
+void
+dc_archive_close (dc_archive_t *archive)
+{
+	if (archive == NULL)
+		return;
+
+	if (archive->data) {
+#ifdef _WIN32
+		UnmapViewOfFile ((void *) archive->data);
+#else
+		munmap ((void *) archive->data, archive->size);
+#endif
+	}
+
+	free (archive);
+}
+
+static int
+dc_archive_sync (FILE *fp)
+{
+	if (fflush (fp) != 0)
+		return -1;
+
+#ifdef _WIN32
+	return _commit (_fileno (fp));
+#else
+	return fsync (fileno (fp));
+#endif
+}
+
+static dc_status_t
+dc_archive_write (dc_archive_writer_t *writer, const unsigned char data[], size_t size)
+{
+	if (size && fwrite (data, 1, size, writer->fp) != size) {
+		ERROR (writer->context, "Failed to write the archive.");
+		return DC_STATUS_IO;
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+dc_archive_write_header (dc_archive_writer_t *writer, unsigned long long ioffset, unsigned int count, unsigned int checksum)
+{
+	unsigned char header[SZ_HEADER] = {0};
+
+	memcpy (header, magic, sizeof (magic));
+	array_uint32_le_set (header + 4, VERSION);
+	array_uint64_le_set (header + 8, ioffset);
+	array_uint32_le_set (header + 16, count);
+	array_uint32_le_set (header + 20, checksum);
+	array_uint32_le_set (header + SZ_HEADER - 4, checksum_crc32r (header, SZ_HEADER - 4));
+
+	if (fseek (writer->fp, 0, SEEK_SET) != 0) {
+		ERROR (writer->context, "Failed to seek the archive.");
+		return DC_STATUS_IO;
+	}
+
+	return dc_archive_write (writer, header, sizeof (header));
+}
+
+dc_status_t
+dc_archive_writer_new (dc_archive_writer_t **out, dc_context_t *context, const char *filename)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_archive_writer_t *writer = NULL;
+
+	if (out == NULL || filename == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	writer = (dc_archive_writer_t *) malloc (sizeof (dc_archive_writer_t));
+	if (writer == NULL) {
+		ERROR (context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	writer->context = context;
+	writer->filename = NULL;
+	writer->archive = NULL;
+	writer->position = 0;
+	writer->records = NULL;
+	writer->count = 0;
+	writer->capacity = 0;
+	writer->status = DC_STATUS_SUCCESS;
+	writer->used = 0;
+	writer->fingerprints = NULL;
+	writer->fp = NULL;
+
+	writer->filename = (char *) malloc (strlen (filename) + 1);
+	if (writer->filename == NULL) {
+		ERROR (context, "Failed to allocate memory.");
+		status = DC_STATUS_NOMEMORY;
+		goto error_free;
+	}
+	strcpy (writer->filename, filename);
+
+	writer->fp = fopen (filename, "r+b");
+	if (writer->fp == NULL && errno == ENOENT) {
+		writer->fp = fopen (filename, "w+b");
+	}
+	if (writer->fp == NULL) {
+		ERROR (context, "Failed to open the archive.");
+		status = DC_STATUS_IO;
+		goto error_free;
+	}
+
+	writer->fingerprints = dc_buffer_new (0);
+	if (writer->fingerprints == NULL) {
+		ERROR (context, "Failed to allocate memory.");
+		status = DC_STATUS_NOMEMORY;
+		goto error_free;
+	}
+
+	// Load the existing index. An empty file is a new archive.
+	status = dc_archive_new (&writer->archive, context, filename);
+	if (status != DC_STATUS_SUCCESS)
+		goto error_free;
+
+	if (writer->archive->size) {
+		status = dc_archive_load (writer->archive);
+		if (status != DC_STATUS_SUCCESS)
+			goto error_free;
+
+		// Anything after the index is left over from an interrupted
+		// update, and is skipped.
+		writer->position = writer->archive->size;
+	} else {
+		dc_archive_close (writer->archive);
+		writer->archive = NULL;
+
+		status = dc_archive_write_header (writer, SZ_HEADER, 0, checksum_crc32r (NULL, 0));
+		if (status != DC_STATUS_SUCCESS)
+			goto error_free;
+
+		if (dc_archive_sync (writer->fp) != 0) {
+			ERROR (context, "Failed to write the archive.");
+			status = DC_STATUS_IO;
+			goto error_free;
+		}
+
+		writer->position = SZ_HEADER;
+	}
+
+	*out = writer;
+
+	return DC_STATUS_SUCCESS;
+
+error_free:
+	if (writer->fp)
+		fclose (writer->fp);
+	dc_archive_close (writer->archive);
+	dc_buffer_free (writer->fingerprints);
+	free (writer->filename);
+	free (writer);
+	return status;
+}
+
+dc_status_t
+dc_archive_writer_add (dc_archive_writer_t *writer, dc_family_t family, unsigned int model, unsigned int serial, dc_ticks_t timestamp, const unsigned char data[], unsigned int size, const unsigned char fingerprint[], unsigned int fsize)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+
+	if (writer == NULL || (data == NULL && size) || fingerprint == NULL || fsize == 0)
+		return DC_STATUS_INVALIDARGS;
+
+	if (writer->status != DC_STATUS_SUCCESS)
+		return writer->status;
+
+	if (writer->archive) {
+		dc_archive_entry_t entry;
+		status = dc_archive_search (writer->archive, family, model, serial, fingerprint, fsize, &entry);
+		if (status != DC_STATUS_DONE)
+			return status == DC_STATUS_SUCCESS ? DC_STATUS_DONE : status;
+	}
+
+	// Grow the record array if necessary.
+	if (writer->count == writer->capacity) {
+		unsigned int capacity = writer->capacity ? writer->capacity * 2 : 64;
+		dc_archive_record_t *records = (dc_archive_record_t *) realloc (writer->records, capacity * sizeof (dc_archive_record_t));
+		if (records == NULL) {
+			ERROR (writer->context, "Failed to allocate memory.");
+			return DC_STATUS_NOMEMORY;
+		}
+		writer->records = records;
+		writer->capacity = capacity;
+	}
+
+	dc_archive_record_t *record = writer->records + writer->count;
+	record->family = family;
+	record->model = model;
+	record->serial = serial;
+	record->timestamp = timestamp;
+	record->offset = writer->position;
+	record->fsize = fsize;
+	record->size = size;
+	record->checksum = checksum_crc32r (data, size);
+	record->sequence = writer->count;
+	record->foffset = dc_buffer_get_size (writer->fingerprints);
+	record->fingerprint = NULL;
+
+	if (!dc_buffer_append (writer->fingerprints, fingerprint, fsize)) {
+		ERROR (writer->context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	// A partial write leaves the file position unknown, and no further
+	// dives can be added.
+	if (fseek (writer->fp, 0, SEEK_END) != 0) {
+		ERROR (writer->context, "Failed to seek the archive.");
+		writer->status = DC_STATUS_IO;
+		return writer->status;
+	}
+
+	status = dc_archive_write (writer, fingerprint, fsize);
+	if (status == DC_STATUS_SUCCESS)
+		status = dc_archive_write (writer, data, size);
+	if (status != DC_STATUS_SUCCESS) {
+		writer->status = status;
+		return status;
+	}
+
+	writer->position += (unsigned long long) fsize + size;
+	writer->count++;
+
+	return DC_STATUS_SUCCESS;
+}
+
+static int
+dc_archive_record_cmp (const void *a, const void *b)
+{
+	const dc_archive_record_t *r1 = (const dc_archive_record_t *) a;
+	const dc_archive_record_t *r2 = (const dc_archive_record_t *) b;
+
+	int cmp = dc_archive_compare (r1->family, r1->model, r1->serial, r1->fingerprint, r1->fsize,
+		r2->family, r2->model, r2->serial, r2->fingerprint, r2->fsize);
+	if (cmp != 0)
+		return cmp;
+
+	// Keep the dives with the same fingerprint in the order they were
+	// added, to retain only the first one.
+	return r1->sequence < r2->sequence ? -1 : 1;
+}
+
+static dc_status_t
+dc_archive_writer_commit (dc_archive_writer_t *writer)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_archive_t *archive = writer->archive;
+	dc_buffer_t *index = NULL;
+
+	unsigned int nold = archive ? archive->count : 0;
+	if (writer->count > UINT_MAX / SZ_ENTRY - nold) {
+		ERROR (writer->context, "Too many dives in the archive.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	// The fingerprint storage no longer moves.
+	const unsigned char *fingerprints = dc_buffer_get_data (writer->fingerprints);
+	for (unsigned int i = 0; i < writer->count; ++i) {
+		writer->records[i].fingerprint = fingerprints + writer->records[i].foffset;
+	}
+
+	qsort (writer->records, writer->count, sizeof (dc_archive_record_t), dc_archive_record_cmp);
+
+	index = dc_buffer_new ((nold + writer->count) * SZ_ENTRY);
+	if (index == NULL) {
+		ERROR (writer->context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	// Merge the existing index with the new dives.
+	unsigned long long used = SZ_HEADER;
+	unsigned int i = 0, j = 0, count = 0;
+	while (i < nold || j < writer->count) {
+		const dc_archive_record_t *record = writer->records + j;
+
+		if (j < writer->count && j > 0 &&
+			dc_archive_compare (record->family, record->model, record->serial, record->fingerprint, record->fsize,
+			record[-1].family, record[-1].model, record[-1].serial, record[-1].fingerprint, record[-1].fsize) == 0) {
+			WARNING (writer->context, "Duplicate dive skipped.");
+			j++;
+			continue;
+		}
+
+		if (i < nold) {
+			dc_archive_entry_t entry;
+			status = dc_archive_decode (archive, i, &entry);
+			if (status != DC_STATUS_SUCCESS)
+				goto error_free;
+
+			if (j == writer->count ||
+				dc_archive_compare (entry.family, entry.model, entry.serial, entry.fingerprint, entry.fsize,
+				record->family, record->model, record->serial, record->fingerprint, record->fsize) < 0) {
+				dc_buffer_append (index, archive->index + (size_t) i * SZ_ENTRY, SZ_ENTRY);
+				used += (unsigned long long) entry.fsize + entry.size;
+				count++;
+				i++;
+				continue;
+			}
+		}
+
+		unsigned char buffer[SZ_ENTRY] = {0};
+		array_uint32_le_set (buffer, record->family);
+		array_uint32_le_set (buffer + 4, record->model);
+		array_uint64_le_set (buffer + 8, record->timestamp);
+		array_uint64_le_set (buffer + 16, record->offset);
+		array_uint32_le_set (buffer + 24, record->fsize);
+		array_uint32_le_set (buffer + 28, record->size);
+		array_uint32_le_set (buffer + 32, record->checksum);
+		array_uint32_le_set (buffer + 36, record->serial);
+		dc_buffer_append (index, buffer, sizeof (buffer));
+		used += (unsigned long long) record->fsize + record->size;
+		count++;
+		j++;
+	}
+
+	// Write the index, and make it durable before the header refers to it.
+	unsigned long long ioffset = writer->position;
+	const unsigned char *data = dc_buffer_get_data (index);
+	size_t size = dc_buffer_get_size (index);
+
+	if (fseek (writer->fp, 0, SEEK_END) != 0) {
+		ERROR (writer->context, "Failed to seek the archive.");
+		status = DC_STATUS_IO;
+		goto error_free;
+	}
+
+	status = dc_archive_write (writer, data, size);
+	if (status != DC_STATUS_SUCCESS)
+		goto error_free;
+
+	if (dc_archive_sync (writer->fp) != 0) {
+		ERROR (writer->context, "Failed to write the archive.");
+		status = DC_STATUS_IO;
+		goto error_free;
+	}
+
+	status = dc_archive_write_header (writer, ioffset, count, checksum_crc32r (data, size));
+	if (status != DC_STATUS_SUCCESS)
+		goto error_free;
+
+	if (dc_archive_sync (writer->fp) != 0) {
+		ERROR (writer->context, "Failed to write the archive.");
+		status = DC_STATUS_IO;
+		goto error_free;
+	}
+
+	writer->position = ioffset + size;
+	writer->used = used + size;
+
+error_free:
+	dc_buffer_free (index);
+	return status;
+}
+
+dc_status_t
+dc_archive_writer_close (dc_archive_writer_t *writer)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+
+	if (writer == NULL)
+		return DC_STATUS_SUCCESS;
+
+	// Without new dives, the archive is left untouched.
+	status = writer->status;
+	if (status == DC_STATUS_SUCCESS && writer->count) {
+		status = dc_archive_writer_commit (writer);
+	}
+
+	fclose (writer->fp);
+	dc_archive_close (writer->archive);
+
+	// Every commit leaves the previous index, and the dives of an
+	// interrupted update, unused. Once that takes up more than half of
+	// the file, the archive is rewritten, which keeps the size of the
+	// file linear in the number of dives. The dives are committed
+	// already, so a failure is not reported.
+	if (status == DC_STATUS_SUCCESS && writer->count &&
+		writer->position > 2 * writer->used) {
+		if (dc_archive_compact (writer->context, writer->filename) != DC_STATUS_SUCCESS) {
+			WARNING (writer->context, "Failed to compact the archive.");
+		}
+	}
+
+	dc_buffer_free (writer->fingerprints);
+	free (writer->records);
+	free (writer->filename);
+	free (writer);
+
+	return status;
+}
+
+dc_status_t
+dc_archive_compact (dc_context_t *context, const char *filename)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_archive_t *archive = NULL;
+	dc_buffer_t *index = NULL;
+	char *tmpname = NULL;
+	FILE *fp = NULL;
+
+	if (filename == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	status = dc_archive_open (&archive, context, filename);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	// The dives are stored in the order of the index, directly after
+	// the header, followed by the index with the new offsets.
+	index = dc_buffer_new ((size_t) archive->count * SZ_ENTRY);
+	if (index == NULL || !dc_buffer_append (index, archive->index, (size_t) archive->count * SZ_ENTRY)) {
+		ERROR (context, "Failed to allocate memory.");
+		status = DC_STATUS_NOMEMORY;
+		goto error_free;
+	}
+
+	unsigned char *entries = dc_buffer_get_data (index);
+	unsigned long long offset = SZ_HEADER;
+	for (unsigned int i = 0; i < archive->count; ++i) {
+		dc_archive_entry_t entry;
+		status = dc_archive_decode (archive, i, &entry);
+		if (status != DC_STATUS_SUCCESS)
+			goto error_free;
+
+		array_uint64_le_set (entries + (size_t) i * SZ_ENTRY + 16, offset);
+		offset += (unsigned long long) entry.fsize + entry.size;
+	}
+
+	unsigned int checksum = checksum_crc32r (entries, dc_buffer_get_size (index));
+
+	unsigned char header[SZ_HEADER] = {0};
+	memcpy (header, magic, sizeof (magic));
+	array_uint32_le_set (header + 4, VERSION);
+	array_uint64_le_set (header + 8, offset);
+	array_uint32_le_set (header + 16, archive->count);
+	array_uint32_le_set (header + 20, checksum);
+	array_uint32_le_set (header + SZ_HEADER - 4, checksum_crc32r (header, SZ_HEADER - 4));
+
+	// Write a new file next to the archive, and replace the archive once
+	// the new contents are on disk.
+	size_t length = strlen (filename);
+	tmpname = (char *) malloc (length + 5);
+	if (tmpname == NULL) {
+		ERROR (context, "Failed to allocate memory.");
+		status = DC_STATUS_NOMEMORY;
+		goto error_free;
+	}
+	memcpy (tmpname, filename, length);
+	memcpy (tmpname + length, ".tmp", 5);
+
+	fp = fopen (tmpname, "wb");
+	if (fp == NULL) {
+		ERROR (context, "Failed to create the archive.");
+		status = DC_STATUS_IO;
+		goto error_free;
+	}
+
+	int rc = fwrite (header, 1, sizeof (header), fp) != sizeof (header);
+	for (unsigned int i = 0; i < archive->count && !rc; ++i) {
+		dc_archive_entry_t entry;
+		dc_archive_decode (archive, i, &entry);
+		size_t size = (size_t) entry.fsize + entry.size;
+		rc = fwrite (entry.fingerprint, 1, size, fp) != size;
+	}
+	rc = rc || fwrite (entries, 1, dc_buffer_get_size (index), fp) != dc_buffer_get_size (index);
+	rc = rc || dc_archive_sync (fp) != 0;
+	rc = fclose (fp) != 0 || rc;
+	if (rc) {
+		ERROR (context, "Failed to write the archive.");
+		status = DC_STATUS_IO;
+		goto error_remove;
+	}
+
+	// The mapping has to be released before the file can be replaced.
+	dc_archive_close (archive);
+	archive = NULL;
+
+#ifdef _WIN32
+	rc = !MoveFileExA (tmpname, filename, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+	rc = rename (tmpname, filename) != 0;
+#endif
+	if (rc) {
+		ERROR (context, "Failed to replace the archive.");
+		status = DC_STATUS_IO;
+		goto error_remove;
+	}
+
+	free (tmpname);
+	dc_buffer_free (index);
+
+	return DC_STATUS_SUCCESS;
+
+error_remove:
+	remove (tmpname);
+error_free:
+	free (tmpname);
+	dc_buffer_free (index);
+	dc_archive_close (archive);
+	return status;
+}
@@ -21,6 +21,15 @@
 
 #include <string.h>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ARRAY_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
 #include "array.h"
 
 void
@@ -60,27 +69,169 @@ array_reverse_nibbles (unsigned char data[], unsigned int size)
 	}
 }
 
-int
-array_isequal (const unsigned char data[], unsigned int size, unsigned char value)
+/*
+ * Return the number of leading bytes (starting at the beginning of the
+ * buffer) that are equal to the value. The bulk of the data is compared
+ * in vector registers, and only the tail is handled byte by byte.
+ */
+static size_t
+array_span_forward (const unsigned char data[], size_t size, unsigned char value)
 {
-	for (unsigned int i = 0; i < size; ++i) {
-		if (data[i] != value)
-			return 0;
+	size_t i = 0;
+
+#if defined(__AVX2__)
+	const __m256i pattern = _mm256_set1_epi8 ((char) value);
+	while (i + 32 <= size) {
+		__m256i v = _mm256_loadu_si256 ((const __m256i *) (data + i));
+		unsigned int mask = (unsigned int) _mm256_movemask_epi8 (_mm256_cmpeq_epi8 (v, pattern));
+		if (mask != 0xFFFFFFFFu)
+			break;
+		i += 32;
+	}
+#elif defined(ARRAY_SSE2)
+	const __m128i pattern = _mm_set1_epi8 ((char) value);
+	while (i + 16 <= size) {
+		__m128i v = _mm_loadu_si128 ((const __m128i *) (data + i));
+		unsigned int mask = (unsigned int) _mm_movemask_epi8 (_mm_cmpeq_epi8 (v, pattern));
+		if (mask != 0xFFFF)
+			break;
+		i += 16;
+	}
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	const uint8x16_t pattern = vdupq_n_u8 (value);
+	while (i + 16 <= size) {
+		uint64x2_t eq = vreinterpretq_u64_u8 (vceqq_u8 (vld1q_u8 (data + i), pattern));
+		if ((vgetq_lane_u64 (eq, 0) & vgetq_lane_u64 (eq, 1)) != ~(uint64_t) 0)
+			break;
+		i += 16;
+	}
+#endif
+
+	while (i < size && data[i] == value)
+		i++;
+
+	return i;
+}
+
+/*
+ * Locate the last occurrence of the value in the buffer. This is the
+ * backward counterpart of memchr, which isn't available everywhere.
+ */
+static const unsigned char *
+array_find_backward (const unsigned char data[], size_t size, unsigned char value)
+{
+#if defined(__AVX2__)
+	const __m256i pattern = _mm256_set1_epi8 ((char) value);
+	while (size >= 32) {
+		__m256i v = _mm256_loadu_si256 ((const __m256i *) (data + size - 32));
+		if (_mm256_movemask_epi8 (_mm256_cmpeq_epi8 (v, pattern)))
+			break;
+		size -= 32;
+	}
+#elif defined(ARRAY_SSE2)
+	const __m128i pattern = _mm_set1_epi8 ((char) value);
+	while (size >= 16) {
+		__m128i v = _mm_loadu_si128 ((const __m128i *) (data + size - 16));
+		if (_mm_movemask_epi8 (_mm_cmpeq_epi8 (v, pattern)))
+			break;
+		size -= 16;
+	}
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	const uint8x16_t pattern = vdupq_n_u8 (value);
+	while (size >= 16) {
+		uint64x2_t eq = vreinterpretq_u64_u8 (vceqq_u8 (vld1q_u8 (data + size - 16), pattern));
+		if (vgetq_lane_u64 (eq, 0) | vgetq_lane_u64 (eq, 1))
+			break;
+		size -= 16;
+	}
+#endif
+
+	while (size) {
+		size--;
+		if (data[size] == value)
+			return data + size;
+	}
+
+	return NULL;
+}
+
+/*
+ * Return the number of leading bytes that are different from both
+ * values, similar to strcspn with a two byte reject set. This is used
+ * to locate the special characters in byte stuffed protocols, such that
+ * the runs in between can be processed in bulk.
+ */
+unsigned int
+array_cspan (const unsigned char data[], unsigned int size, unsigned char a, unsigned char b)
+{
+	unsigned int i = 0;
+
+#if defined(__AVX2__)
+	const __m256i pa = _mm256_set1_epi8 ((char) a);
+	const __m256i pb = _mm256_set1_epi8 ((char) b);
+	while (i + 32 <= size) {
+		__m256i v = _mm256_loadu_si256 ((const __m256i *) (data + i));
+		__m256i eq = _mm256_or_si256 (_mm256_cmpeq_epi8 (v, pa), _mm256_cmpeq_epi8 (v, pb));
+		if (_mm256_movemask_epi8 (eq))
+			break;
+		i += 32;
+	}
+#elif defined(ARRAY_SSE2)
+	const __m128i pa = _mm_set1_epi8 ((char) a);
+	const __m128i pb = _mm_set1_epi8 ((char) b);
+	while (i + 16 <= size) {
+		__m128i v = _mm_loadu_si128 ((const __m128i *) (data + i));
+		__m128i eq = _mm_or_si128 (_mm_cmpeq_epi8 (v, pa), _mm_cmpeq_epi8 (v, pb));
+		if (_mm_movemask_epi8 (eq))
+			break;
+		i += 16;
+	}
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	const uint8x16_t pa = vdupq_n_u8 (a);
+	const uint8x16_t pb = vdupq_n_u8 (b);
+	while (i + 16 <= size) {
+		uint8x16_t v = vld1q_u8 (data + i);
+		uint64x2_t eq = vreinterpretq_u64_u8 (vorrq_u8 (vceqq_u8 (v, pa), vceqq_u8 (v, pb)));
+		if (vgetq_lane_u64 (eq, 0) | vgetq_lane_u64 (eq, 1))
+			break;
+		i += 16;
 	}
+#endif
 
-	return 1;
+	while (i < size && data[i] != a && data[i] != b)
+		i++;
+
+	return i;
+}
+
+int
+array_isequal (const unsigned char data[], unsigned int size, unsigned char value)
+{
+	return array_span_forward (data, size, value) == size;
 }
 
 
+/*
+ * The marker searches only run the full comparison at offsets where a
+ * single byte of the marker already matches. Locating that byte is
+ * delegated to memchr (or its backward counterpart), which processes
+ * the buffer many bytes at a time.
+ */
 const unsigned char *
 array_search_forward (const unsigned char *data, unsigned int size,
                       const unsigned char *marker, unsigned int msize)
 {
-	while (size >= msize) {
-		if (memcmp (data, marker, msize) == 0)
-			return data;
-		size--;
-		data++;
+	if (msize == 0)
+		return data;
+
+	const unsigned char *end = data + size;
+	while ((size_t) (end - data) >= msize) {
+		const unsigned char *p = (const unsigned char *) memchr (data, marker[0], (end - data) - msize + 1);
+		if (p == NULL)
+			break;
+		if (memcmp (p + 1, marker + 1, msize - 1) == 0)
+			return p;
+		data = p + 1;
 	}
 	return NULL;
 }
@@ -90,12 +241,19 @@ const unsigned char *
 array_search_backward (const unsigned char *data, unsigned int size,
                        const unsigned char *marker, unsigned int msize)
 {
-	data += size;
-	while (size >= msize) {
-		if (memcmp (data - msize, marker, msize) == 0)
-			return data;
-		size--;
-		data--;
+	if (msize == 0)
+		return data + size;
+
+	// The returned pointer points past the end of the marker.
+	const unsigned char last = marker[msize - 1];
+	size_t n = size;
+	while (n >= msize) {
+		const unsigned char *p = array_find_backward (data + msize - 1, n - msize + 1, last);
+		if (p == NULL)
+			break;
+		if (memcmp (p + 1 - msize, marker, msize - 1) == 0)
+			return p + 1;
+		n = p - data;
 	}
 	return NULL;
 }
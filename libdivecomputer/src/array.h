@@ -41,6 +41,9 @@ array_reverse_nibbles (unsigned char data[], unsigned int size);
 int
 array_isequal (const unsigned char data[], unsigned int size, unsigned char value);
 
+unsigned int
+array_cspan (const unsigned char data[], unsigned int size, unsigned char a, unsigned char b);
+
 const unsigned char *
 array_search_forward (const unsigned char *data, unsigned int size,
                       const unsigned char *marker, unsigned int msize);
@@ -57,6 +57,7 @@ static const dc_parser_vtable_t atomics_cobalt_parser_vtable = {
 	atomics_cobalt_parser_get_datetime, /* datetime */
 	atomics_cobalt_parser_get_field, /* fields */
 	atomics_cobalt_parser_samples_foreach, /* samples_foreach */
+	NULL, /* summary */
 	NULL /* destroy */
 };
 
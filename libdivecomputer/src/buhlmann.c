@@ -0,0 +1,581 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 LibDCSwift contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#include <stdlib.h>
+#include <math.h>
+
+#include <libdivecomputer/buhlmann.h>
+#include <libdivecomputer/units.h>
+
+#include "context-private.h"
+#include "parser-private.h"
+
+#define NCOMPARTMENTS 16
+
+#define WATER_VAPOUR 0.0627 /* bar */
+#define AIR_N2       0.7902
+
+#define ASCENT_RATE  (10.0 / 60.0) /* m/s */
+#define STOP_STEP    3.0 /* m */
+#define STOP_TIME    60.0 /* s */
+#define MAX_TTS      (48 * 3600)
+
+#define UNDEFINED 0xFFFFFFFF
+
+/*
+ * The compartments are stored as a structure of arrays, with all the
+ * N2 and all the He values contiguous. The per compartment loops below
+ * are branch free (the maximum is taken in a separate loop), and are
+ * vectorized by the compiler.
+ */
+typedef struct buhlmann_tissues_t {
+	double n2[NCOMPARTMENTS];
+	double he[NCOMPARTMENTS];
+} buhlmann_tissues_t;
+
+typedef struct buhlmann_coefficients_t {
+	double total[NCOMPARTMENTS];
+	double a[NCOMPARTMENTS];
+	double b[NCOMPARTMENTS];
+} buhlmann_coefficients_t;
+
+typedef struct buhlmann_point_t {
+	unsigned int time; /* Milliseconds */
+	double pressure; /* Ambient pressure (bar) */
+	double n2, he; /* Inert gas fractions */
+	double setpoint; /* CCR setpoint (bar), or zero */
+} buhlmann_point_t;
+
+struct dc_buhlmann_t {
+	dc_context_t *context;
+	double atmospheric;
+	double density;
+	// Profile.
+	buhlmann_point_t *points;
+	unsigned int count;
+	unsigned int capacity;
+	// Rate constants (1/s), their inverse, and the exponential decay
+	// over a stop.
+	buhlmann_tissues_t k, invk, stop;
+	// Sample collection.
+	dc_gasmix_t *gasmixes;
+	unsigned int ngasmixes;
+	unsigned int ccr;
+	unsigned int havetime;
+	unsigned int gasmix;
+	buhlmann_point_t pending;
+	double depth;
+	dc_status_t status;
+};
+
+/* ZHL-16C (compartment 1b) parameters. */
+static const double n2_halftime[NCOMPARTMENTS] = {
+	5.0, 8.0, 12.5, 18.5, 27.0, 38.3, 54.3, 77.0,
+	109.0, 146.0, 187.0, 239.0, 305.0, 390.0, 498.0, 635.0};
+static const double n2_a[NCOMPARTMENTS] = {
+	1.1696, 1.0000, 0.8618, 0.7562, 0.6200, 0.5043, 0.4410, 0.4000,
+	0.3750, 0.3500, 0.3295, 0.3065, 0.2835, 0.2610, 0.2480, 0.2327};
+static const double n2_b[NCOMPARTMENTS] = {
+	0.5578, 0.6514, 0.7222, 0.7825, 0.8126, 0.8434, 0.8693, 0.8910,
+	0.9092, 0.9222, 0.9319, 0.9403, 0.9477, 0.9544, 0.9602, 0.9653};
+static const double he_halftime[NCOMPARTMENTS] = {
+	1.88, 3.02, 4.72, 6.99, 10.21, 14.48, 20.53, 29.11,
+	41.20, 55.19, 70.69, 90.34, 115.29, 147.42, 188.24, 240.03};
+static const double he_a[NCOMPARTMENTS] = {
+	1.6189, 1.3830, 1.1919, 1.0458, 0.9220, 0.8205, 0.7305, 0.6502,
+	0.5950, 0.5545, 0.5333, 0.5189, 0.5181, 0.5176, 0.5172, 0.5119};
+static const double he_b[NCOMPARTMENTS] = {
+	0.4770, 0.5747, 0.6527, 0.7223, 0.7582, 0.7957, 0.8279, 0.8553,
+	0.8757, 0.8903, 0.8997, 0.9073, 0.9122, 0.9171, 0.9217, 0.9267};
+
+static double
+buhlmann_pressure (const dc_buhlmann_t *engine, double depth)
+{
+	return engine->atmospheric + depth * engine->density * GRAVITY / BAR;
+}
+
+static double
+buhlmann_depth (const dc_buhlmann_t *engine, double pressure)
+{
+	return (pressure - engine->atmospheric) * BAR / (engine->density * GRAVITY);
+}
+
+static void
+buhlmann_inspired (double pressure, const buhlmann_point_t *gas, double *n2, double *he)
+{
+	double inert = pressure - WATER_VAPOUR;
+	double n2_fraction = gas->n2, he_fraction = gas->he;
+
+	if (gas->setpoint > 0.0) {
+		// The inert gases of the diluent make up the remainder.
+		double fraction = gas->n2 + gas->he;
+		inert -= gas->setpoint;
+		n2_fraction = fraction > 0.0 ? gas->n2 / fraction : 0.0;
+		he_fraction = fraction > 0.0 ? gas->he / fraction : 0.0;
+	}
+
+	if (inert < 0.0)
+		inert = 0.0;
+
+	*n2 = inert * n2_fraction;
+	*he = inert * he_fraction;
+}
+
+/*
+ * Schreiner equation: the inspired pressure changes linearly from its
+ * initial value (pi) at the given rate (r, bar/s) over the interval.
+ * The decay factors exp(-k * dt) are passed in. The arrays never alias,
+ * which allows the compiler to vectorize the loop.
+ */
+static void
+buhlmann_schreiner_gas (double * restrict p, const double * restrict decay, const double * restrict invk, double dt, double pi, double r)
+{
+	for (unsigned int i = 0; i < NCOMPARTMENTS; ++i) {
+		p[i] = pi + r * (dt - invk[i]) - (pi - p[i] - r * invk[i]) * decay[i];
+	}
+}
+
+static void
+buhlmann_schreiner (const dc_buhlmann_t *engine, buhlmann_tissues_t *tissues, const buhlmann_tissues_t *decay, double dt, double n2_pi, double n2_r, double he_pi, double he_r)
+{
+	buhlmann_schreiner_gas (tissues->n2, decay->n2, engine->invk.n2, dt, n2_pi, n2_r);
+	buhlmann_schreiner_gas (tissues->he, decay->he, engine->invk.he, dt, he_pi, he_r);
+}
+
+static void
+buhlmann_decay (const dc_buhlmann_t *engine, buhlmann_tissues_t *decay, double dt)
+{
+	for (unsigned int i = 0; i < NCOMPARTMENTS; ++i) {
+		decay->n2[i] = exp (-engine->k.n2[i] * dt);
+		decay->he[i] = exp (-engine->k.he[i] * dt);
+	}
+}
+
+static void
+buhlmann_segment (const dc_buhlmann_t *engine, buhlmann_tissues_t *tissues, const buhlmann_tissues_t *decay, double dt, double begin, double end, const buhlmann_point_t *gas)
+{
+	double n2_begin, he_begin, n2_end, he_end;
+	buhlmann_inspired (begin, gas, &n2_begin, &he_begin);
+	buhlmann_inspired (end, gas, &n2_end, &he_end);
+
+	buhlmann_schreiner (engine, tissues, decay, dt,
+		n2_begin, (n2_end - n2_begin) / dt,
+		he_begin, (he_end - he_begin) / dt);
+}
+
+/*
+ * The combined M-value coefficients of the compartments. The total inert
+ * gas pressure, and the a and b coefficients weighted by the partial
+ * pressures of N2 and He.
+ */
+static void
+buhlmann_coefficients (const buhlmann_tissues_t *tissues, buhlmann_coefficients_t *coefficients)
+{
+	for (unsigned int i = 0; i < NCOMPARTMENTS; ++i) {
+		double n2 = tissues->n2[i], he = tissues->he[i];
+		double total = n2 + he;
+		double inverse = 1.0 / total;
+		coefficients->total[i] = total;
+		coefficients->a[i] = (n2_a[i] * n2 + he_a[i] * he) * inverse;
+		coefficients->b[i] = (n2_b[i] * n2 + he_b[i] * he) * inverse;
+	}
+}
+
+static double
+buhlmann_maximum (const double values[NCOMPARTMENTS], double minimum)
+{
+	double maximum = minimum;
+	for (unsigned int i = 0; i < NCOMPARTMENTS; ++i) {
+		if (values[i] > maximum)
+			maximum = values[i];
+	}
+
+	return maximum;
+}
+
+/*
+ * The ceiling (as ambient pressure) for a constant gradient factor.
+ */
+static double
+buhlmann_tolerated (const buhlmann_coefficients_t *c, double gf)
+{
+	double values[NCOMPARTMENTS];
+
+	for (unsigned int i = 0; i < NCOMPARTMENTS; ++i) {
+		values[i] = (c->total[i] - gf * c->a[i]) / (gf / c->b[i] + 1.0 - gf);
+	}
+
+	return buhlmann_maximum (values, 0.0);
+}
+
+/*
+ * The gradient factor of the leading compartment at the given pressure.
+ */
+static double
+buhlmann_gf99 (const buhlmann_coefficients_t *c, double pressure)
+{
+	double values[NCOMPARTMENTS];
+
+	for (unsigned int i = 0; i < NCOMPARTMENTS; ++i) {
+		values[i] = (c->total[i] - pressure) / (pressure / c->b[i] + c->a[i] - pressure);
+	}
+
+	return buhlmann_maximum (values, 0.0);
+}
+
+/*
+ * The ceiling (as ambient pressure) with the gradient factor changing
+ * linearly from gflow at the anchor to gfhigh at the surface.
+ */
+static double
+buhlmann_ceiling (const buhlmann_coefficients_t *c, double gflow, double gfhigh, double anchor, double surface)
+{
+	if (anchor <= surface)
+		return buhlmann_tolerated (c, gfhigh);
+
+	double slope = (gflow - gfhigh) / (anchor - surface);
+	double values[NCOMPARTMENTS];
+
+	for (unsigned int i = 0; i < NCOMPARTMENTS; ++i) {
+		double total = c->total[i], a = c->a[i], b = c->b[i];
+		double k = 1.0 / b - 1.0;
+
+		// Solve total = p + gf(p) * (p * k + a) for the pressure p, with
+		// gf(p) = gfhigh + slope * (p - surface). This is the root that
+		// reduces to the constant gradient factor solution for slope 0.
+		double qa = slope * k;
+		double qb = 1.0 + gfhigh * k + slope * a - slope * surface * k;
+		double qc = gfhigh * a - slope * surface * a - total;
+		double d = qb * qb - 4.0 * qa * qc;
+		double p = -2.0 * qc / (qb + sqrt (d > 0.0 ? d : 0.0));
+
+		// Below the anchor, gflow applies.
+		double deep = (total - gflow * a) / (gflow / b + 1.0 - gflow);
+		values[i] = p > anchor ? deep : p;
+	}
+
+	return buhlmann_maximum (values, 0.0);
+}
+
+static unsigned int
+buhlmann_tts (const dc_buhlmann_t *engine, const buhlmann_tissues_t *current, const buhlmann_point_t *gas, double pressure, double gflow, double gfhigh, double anchor)
+{
+	const double surface = engine->atmospheric;
+
+	buhlmann_tissues_t tissues = *current;
+	buhlmann_tissues_t decay;
+
+	double depth = buhlmann_depth (engine, pressure);
+	double time = 0.0;
+
+	while (depth > 0.0 && time < MAX_TTS) {
+		buhlmann_coefficients_t coefficients;
+		buhlmann_coefficients (&tissues, &coefficients);
+
+		double tolerated = buhlmann_tolerated (&coefficients, gflow);
+		anchor = tolerated > anchor ? tolerated : anchor;
+
+		double ceiling = buhlmann_depth (engine,
+			buhlmann_ceiling (&coefficients, gflow, gfhigh, anchor, surface));
+		double stop = ceiling > 0.0 ? ceil (ceiling / STOP_STEP) * STOP_STEP : 0.0;
+
+		if (stop < depth) {
+			// Ascend to the next stop (or the surface).
+			double next = buhlmann_pressure (engine, stop);
+			double dt = (depth - stop) / ASCENT_RATE;
+			buhlmann_decay (engine, &decay, dt);
+			buhlmann_segment (engine, &tissues, &decay, dt, pressure, next, gas);
+			pressure = next;
+			depth = stop;
+			time += dt;
+		} else {
+			// Wait at the stop.
+			buhlmann_segment (engine, &tissues, &engine->stop, STOP_TIME, pressure, pressure, gas);
+			time += STOP_TIME;
+		}
+	}
+
+	return time < MAX_TTS ? (unsigned int) (time + 0.5) : MAX_TTS;
+}
+
+static void
+buhlmann_push (dc_buhlmann_t *engine)
+{
+	if (engine->status != DC_STATUS_SUCCESS)
+		return;
+
+	// Grow the profile if necessary.
+	if (engine->count == engine->capacity) {
+		unsigned int capacity = engine->capacity ? engine->capacity * 2 : 1024;
+		buhlmann_point_t *points = (buhlmann_point_t *) realloc (engine->points, capacity * sizeof (buhlmann_point_t));
+		if (points == NULL) {
+			ERROR (engine->context, "Failed to allocate memory.");
+			engine->status = DC_STATUS_NOMEMORY;
+			return;
+		}
+		engine->points = points;
+		engine->capacity = capacity;
+	}
+
+	buhlmann_point_t *point = engine->points + engine->count;
+	*point = engine->pending;
+	point->pressure = buhlmann_pressure (engine, engine->depth);
+
+	if (engine->gasmix < engine->ngasmixes) {
+		point->n2 = engine->gasmixes[engine->gasmix].nitrogen;
+		point->he = engine->gasmixes[engine->gasmix].helium;
+	} else {
+		point->n2 = AIR_N2;
+		point->he = 0.0;
+	}
+
+	engine->count++;
+}
+
+static void
+buhlmann_sample_cb (dc_sample_type_t type, const dc_sample_value_t *value, void *userdata)
+{
+	dc_buhlmann_t *engine = (dc_buhlmann_t *) userdata;
+
+	switch (type) {
+	case DC_SAMPLE_TIME:
+		if (engine->havetime) {
+			buhlmann_push (engine);
+		}
+		engine->pending.time = value->time;
+		engine->havetime = 1;
+		break;
+	case DC_SAMPLE_DEPTH:
+		engine->depth = value->depth;
+		break;
+	case DC_SAMPLE_GASMIX:
+		engine->gasmix = value->gasmix;
+		break;
+	case DC_SAMPLE_SETPOINT:
+		if (engine->ccr) {
+			engine->pending.setpoint = value->setpoint;
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+dc_status_t
+dc_buhlmann_new (dc_buhlmann_t **out, dc_parser_t *parser)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_buhlmann_t *engine = NULL;
+
+	if (out == NULL || parser == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	engine = (dc_buhlmann_t *) calloc (1, sizeof (dc_buhlmann_t));
+	if (engine == NULL) {
+		ERROR (parser->context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	engine->context = parser->context;
+	engine->status = DC_STATUS_SUCCESS;
+
+	for (unsigned int i = 0; i < NCOMPARTMENTS; ++i) {
+		engine->k.n2[i] = log (2.0) / (n2_halftime[i] * 60.0);
+		engine->k.he[i] = log (2.0) / (he_halftime[i] * 60.0);
+		engine->invk.n2[i] = 1.0 / engine->k.n2[i];
+		engine->invk.he[i] = 1.0 / engine->k.he[i];
+	}
+	buhlmann_decay (engine, &engine->stop, STOP_TIME);
+
+	// Surface pressure and water density.
+	double atmospheric = 0.0;
+	if (dc_parser_get_field (parser, DC_FIELD_ATMOSPHERIC, 0, &atmospheric) == DC_STATUS_SUCCESS &&
+		atmospheric > 0.0) {
+		engine->atmospheric = atmospheric;
+	} else {
+		engine->atmospheric = ATM / BAR;
+	}
+
+	dc_salinity_t salinity = {DC_WATER_SALT, 0.0};
+	if (dc_parser_get_field (parser, DC_FIELD_SALINITY, 0, &salinity) == DC_STATUS_SUCCESS &&
+		salinity.density > 0.0) {
+		engine->density = salinity.density;
+	} else if (salinity.type == DC_WATER_FRESH) {
+		engine->density = DEF_DENSITY_FRESH;
+	} else {
+		engine->density = DEF_DENSITY_SALT;
+	}
+
+	// The setpoint only applies on a rebreather.
+	unsigned int divemode = DC_DIVEMODE_OC;
+	if (dc_parser_get_field (parser, DC_FIELD_DIVEMODE, 0, &divemode) == DC_STATUS_SUCCESS) {
+		engine->ccr = divemode == DC_DIVEMODE_CCR;
+	}
+
+	// Gas mixes.
+	unsigned int ngasmixes = 0;
+	if (dc_parser_get_field (parser, DC_FIELD_GASMIX_COUNT, 0, &ngasmixes) == DC_STATUS_SUCCESS &&
+		ngasmixes) {
+		engine->gasmixes = (dc_gasmix_t *) malloc (ngasmixes * sizeof (dc_gasmix_t));
+		if (engine->gasmixes == NULL) {
+			ERROR (parser->context, "Failed to allocate memory.");
+			status = DC_STATUS_NOMEMORY;
+			goto error_free;
+		}
+
+		for (unsigned int i = 0; i < ngasmixes; ++i) {
+			status = dc_parser_get_field (parser, DC_FIELD_GASMIX, i, engine->gasmixes + i);
+			if (status != DC_STATUS_SUCCESS) {
+				ERROR (parser->context, "Failed to get the gas mix %u.", i);
+				goto error_free;
+			}
+		}
+		engine->ngasmixes = ngasmixes;
+	}
+	engine->gasmix = engine->ngasmixes ? 0 : UNDEFINED;
+
+	// Capture the profile, regardless of the sample mask.
+	unsigned int samplemask = parser->samplemask;
+	unsigned int enabled = parser->enabled;
+	parser->samplemask = DC_SAMPLE_MASK_ALL;
+	parser->enabled = DC_SAMPLE_MASK_ALL;
+
+	status = dc_parser_samples_foreach (parser, buhlmann_sample_cb, engine);
+
+	parser->samplemask = samplemask;
+	parser->enabled = enabled;
+
+	if (status != DC_STATUS_SUCCESS)
+		goto error_free;
+
+	if (engine->havetime) {
+		buhlmann_push (engine);
+	}
+
+	status = engine->status;
+	if (status != DC_STATUS_SUCCESS)
+		goto error_free;
+
+	*out = engine;
+
+	return DC_STATUS_SUCCESS;
+
+error_free:
+	dc_buhlmann_free (engine);
+	return status;
+}
+
+unsigned int
+dc_buhlmann_get_count (dc_buhlmann_t *engine)
+{
+	if (engine == NULL)
+		return 0;
+
+	return engine->count;
+}
+
+dc_status_t
+dc_buhlmann_get_profile (dc_buhlmann_t *engine, unsigned int time[], double depth[])
+{
+	if (engine == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	for (unsigned int i = 0; i < engine->count; ++i) {
+		if (time)
+			time[i] = engine->points[i].time;
+		if (depth)
+			depth[i] = buhlmann_depth (engine, engine->points[i].pressure);
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+dc_buhlmann_replay (dc_buhlmann_t *engine, unsigned int gflow, unsigned int gfhigh, double ceiling[], double gf99[], unsigned int tts[])
+{
+	if (engine == NULL || gflow == 0 || gflow > gfhigh)
+		return DC_STATUS_INVALIDARGS;
+
+	const double gl = gflow / 100.0, gh = gfhigh / 100.0;
+	const double surface = engine->atmospheric;
+
+	// Saturated with air at the surface.
+	buhlmann_tissues_t tissues;
+	for (unsigned int i = 0; i < NCOMPARTMENTS; ++i) {
+		tissues.n2[i] = (surface - WATER_VAPOUR) * AIR_N2;
+		tissues.he[i] = 0.0;
+	}
+
+	buhlmann_tissues_t decay;
+	double interval = 0.0;
+	double anchor = 0.0;
+
+	for (unsigned int n = 0; n < engine->count; ++n) {
+		const buhlmann_point_t *point = engine->points + n;
+
+		if (n) {
+			const buhlmann_point_t *previous = point - 1;
+			double dt = ((double) point->time - (double) previous->time) / 1000.0;
+			if (dt > 0.0) {
+				// Most dives have a fixed sample interval.
+				if (dt != interval) {
+					buhlmann_decay (engine, &decay, dt);
+					interval = dt;
+				}
+				buhlmann_segment (engine, &tissues, &decay, dt,
+					previous->pressure, point->pressure, previous);
+			}
+		}
+
+		buhlmann_coefficients_t coefficients;
+		buhlmann_coefficients (&tissues, &coefficients);
+
+		double tolerated = buhlmann_tolerated (&coefficients, gl);
+		anchor = tolerated > anchor ? tolerated : anchor;
+
+		if (ceiling) {
+			double depth = buhlmann_depth (engine,
+				buhlmann_ceiling (&coefficients, gl, gh, anchor, surface));
+			ceiling[n] = depth > 0.0 ? depth : 0.0;
+		}
+
+		if (gf99) {
+			gf99[n] = buhlmann_gf99 (&coefficients, point->pressure) * 100.0;
+		}
+
+		if (tts) {
+			tts[n] = buhlmann_tts (engine, &tissues, point, point->pressure, gl, gh, anchor);
+		}
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
+void
+dc_buhlmann_free (dc_buhlmann_t *engine)
+{
+	if (engine == NULL)
+		return;
+
+	free (engine->gasmixes);
+	free (engine->points);
+	free (engine);
+}
@@ -49,6 +49,7 @@ static const dc_parser_vtable_t citizen_aqualand_parser_vtable = {
 	citizen_aqualand_parser_get_datetime, /* datetime */
 	citizen_aqualand_parser_get_field, /* fields */
 	citizen_aqualand_parser_samples_foreach, /* samples_foreach */
+	NULL, /* summary */
 	NULL /* destroy */
 };
 
@@ -31,6 +31,7 @@
 #include "rbstream.h"
 
 #define MAXRETRIES 2
+#define CHUNK_ALIGN 1024
 
 #define COCHRAN_MODEL_COMMANDER_TM 0
 #define COCHRAN_MODEL_COMMANDER_PRE21000 1
@@ -538,33 +539,24 @@ cochran_commander_read (cochran_commander_device_t *device, dc_event_progress_t
 
 
 static dc_status_t
-cochran_commander_read_retry (cochran_commander_device_t *device, dc_event_progress_t *progress, unsigned int address, unsigned char data[], unsigned int size)
+cochran_commander_read_chunk (dc_device_t *abstract, dc_event_progress_t *progress, unsigned int address, unsigned char data[], unsigned int size)
 {
-	// Save the state of the progress events.
-	unsigned int saved = 0;
-	if (progress) {
-		saved = progress->current;
-	}
-
-	unsigned int nretries = 0;
-	dc_status_t rc = DC_STATUS_SUCCESS;
-	while ((rc = cochran_commander_read (device, progress, address, data, size)) != DC_STATUS_SUCCESS) {
-		// Automatically discard a corrupted packet,
-		// and request a new one.
-		if (rc != DC_STATUS_PROTOCOL && rc != DC_STATUS_TIMEOUT)
-			return rc;
-
-		// Abort if the maximum number of retries is reached.
-		if (nretries++ >= MAXRETRIES)
-			return rc;
+	return cochran_commander_read ((cochran_commander_device_t *) abstract, progress, address, data, size);
+}
 
-		// Restore the state of the progress events.
-		if (progress) {
-			progress->current = saved;
-		}
-	}
 
-	return rc;
+static dc_status_t
+cochran_commander_read_retry (cochran_commander_device_t *device, dc_event_progress_t *progress, unsigned int address, unsigned char data[], unsigned int size)
+{
+	// The data stream has no checksums, so a dropped byte is only noticed
+	// as a timeout at the end of the read. Split large reads into chunks
+	// of roughly ten seconds at the line rate, such that a retry doesn't
+	// have to start all over again. Every extra read command costs about
+	// half a second of fixed delays, which limits the overhead to a few
+	// percent.
+	unsigned int chunksize = device->layout->baudrate & ~(CHUNK_ALIGN - 1);
+
+	return device_read_retry ((dc_device_t *) device, cochran_commander_read_chunk, progress, address, data, size, chunksize, MAXRETRIES);
 }
 
 
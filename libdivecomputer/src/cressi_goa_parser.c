@@ -82,6 +82,7 @@ static const dc_parser_vtable_t cressi_goa_parser_vtable = {
 	cressi_goa_parser_get_datetime, /* datetime */
 	cressi_goa_parser_get_field, /* fields */
 	cressi_goa_parser_samples_foreach, /* samples_foreach */
+	NULL, /* summary */
 	NULL /* destroy */
 };
 
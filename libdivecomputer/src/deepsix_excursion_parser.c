@@ -127,6 +127,7 @@ static const dc_parser_vtable_t deepsix_parser_vtable = {
 	deepsix_excursion_parser_get_datetime, /* datetime */
 	deepsix_excursion_parser_get_field, /* fields */
 	deepsix_excursion_parser_samples_foreach, /* samples_foreach */
+	NULL, /* summary */
 	NULL /* destroy */
 };
 
@@ -26,6 +26,7 @@
 
 #include <libdivecomputer/context.h>
 #include <libdivecomputer/device.h>
+#include <libdivecomputer/iostream.h>
 
 #include "common-private.h"
 
@@ -40,6 +41,22 @@ struct dc_device_vtable_t;
 
 typedef struct dc_device_vtable_t dc_device_vtable_t;
 
+typedef dc_status_t (*device_read_func_t) (dc_device_t *device, dc_event_progress_t *progress, unsigned int address, unsigned char data[], unsigned int size);
+
+/*
+ * Adaptive inter-packet delay (in milliseconds). The delay grows by a
+ * fixed step after every failed packet, and is halved again after a
+ * window of consecutive successful packets, but never drops below the
+ * minimum required by the driver and the transport. A maximum of zero
+ * disables pacing.
+ */
+typedef struct dc_pacing_t {
+	unsigned int delay;
+	unsigned int minimum;
+	unsigned int maximum;
+	unsigned int nsuccess;
+} dc_pacing_t;
+
 struct dc_device_t {
 	const dc_device_vtable_t *vtable;
 	// Library context.
@@ -54,6 +71,8 @@ struct dc_device_t {
 	// Cached events for the parsers.
 	dc_event_devinfo_t devinfo;
 	dc_event_clock_t clock;
+	// Inter-packet pacing.
+	dc_pacing_t pacing;
 };
 
 struct dc_device_vtable_t {
@@ -91,9 +110,28 @@ device_event_emit (dc_device_t *device, dc_event_type_t event, const void *data)
 int
 device_is_cancelled (dc_device_t *device);
 
+/*
+ * Initialize the pacing. The minimum and maximum delay of the driver
+ * are raised by the floor of the transport of the I/O stream.
+ */
+void
+device_pacing_init (dc_device_t *device, dc_iostream_t *iostream, unsigned int minimum, unsigned int maximum);
+
+void
+device_pacing_wait (dc_device_t *device, dc_iostream_t *iostream);
+
+void
+device_pacing_success (dc_device_t *device);
+
+void
+device_pacing_failure (dc_device_t *device);
+
 dc_status_t
 device_dump_read (dc_device_t *device, unsigned int address, unsigned char data[], unsigned int size, unsigned int blocksize);
 
+dc_status_t
+device_read_retry (dc_device_t *device, device_read_func_t read, dc_event_progress_t *progress, unsigned int address, unsigned char data[], unsigned int size, unsigned int chunksize, unsigned int maxretries);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
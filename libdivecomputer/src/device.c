@@ -71,6 +71,8 @@
 #include "device-private.h"
 #include "context-private.h"
 
+#define PACING_WINDOW 32
+
 dc_device_t *
 dc_device_allocate (dc_context_t *context, const dc_device_vtable_t *vtable)
 {
@@ -100,6 +102,8 @@ dc_device_allocate (dc_context_t *context, const dc_device_vtable_t *vtable)
 	memset (&device->devinfo, 0, sizeof (device->devinfo));
 	memset (&device->clock, 0, sizeof (device->clock));
 
+	memset (&device->pacing, 0, sizeof (device->pacing));
+
 	return device;
 }
 
@@ -323,6 +327,43 @@ dc_device_set_fingerprint (dc_device_t *device, const unsigned char data[], unsi
 }
 
 
+dc_status_t
+dc_device_get_pacing (dc_device_t *device, unsigned int *delay)
+{
+	if (device == NULL)
+		return DC_STATUS_UNSUPPORTED;
+
+	if (device->pacing.maximum == 0)
+		return DC_STATUS_UNSUPPORTED;
+
+	if (delay)
+		*delay = device->pacing.delay;
+
+	return DC_STATUS_SUCCESS;
+}
+
+
+dc_status_t
+dc_device_set_pacing (dc_device_t *device, unsigned int delay)
+{
+	if (device == NULL)
+		return DC_STATUS_UNSUPPORTED;
+
+	if (device->pacing.maximum == 0)
+		return DC_STATUS_UNSUPPORTED;
+
+	if (delay < device->pacing.minimum)
+		delay = device->pacing.minimum;
+	if (delay > device->pacing.maximum)
+		delay = device->pacing.maximum;
+
+	device->pacing.delay = delay;
+	device->pacing.nsuccess = 0;
+
+	return DC_STATUS_SUCCESS;
+}
+
+
 dc_status_t
 dc_device_read (dc_device_t *device, unsigned int address, unsigned char data[], unsigned int size)
 {
@@ -404,6 +445,58 @@ device_dump_read (dc_device_t *device, unsigned int address, unsigned char data[
 }
 
 
+/*
+ * Read a large range in a number of smaller chunks, and retry a failed
+ * chunk on its own, instead of the entire range. A corrupted or missing
+ * byte is detected at the end of its chunk at the latest, so everything
+ * before the start of the failed chunk is known to be good.
+ */
+dc_status_t
+device_read_retry (dc_device_t *device, device_read_func_t read, dc_event_progress_t *progress, unsigned int address, unsigned char data[], unsigned int size, unsigned int chunksize, unsigned int maxretries)
+{
+	if (device == NULL || read == NULL || chunksize == 0)
+		return DC_STATUS_INVALIDARGS;
+
+	unsigned int nbytes = 0;
+	while (nbytes < size) {
+		// Calculate the chunk size.
+		unsigned int len = size - nbytes;
+		if (len > chunksize)
+			len = chunksize;
+
+		// Save the state of the progress events.
+		unsigned int saved = 0;
+		if (progress) {
+			saved = progress->current;
+		}
+
+		unsigned int nretries = 0;
+		dc_status_t rc = DC_STATUS_SUCCESS;
+		while ((rc = read (device, progress, address + nbytes, data + nbytes, len)) != DC_STATUS_SUCCESS) {
+			// Automatically discard a corrupted chunk,
+			// and request it again.
+			if (rc != DC_STATUS_PROTOCOL && rc != DC_STATUS_TIMEOUT)
+				return rc;
+
+			// Abort if the maximum number of retries is reached.
+			if (nretries++ >= maxretries)
+				return rc;
+
+			WARNING (device->context, "Retrying the read at offset %u.", nbytes);
+
+			// Restore the state of the progress events.
+			if (progress) {
+				progress->current = saved;
+			}
+		}
+
+		nbytes += len;
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
+
 dc_status_t
 dc_device_foreach (dc_device_t *device, dc_dive_callback_t callback, void *userdata)
 {
@@ -455,6 +548,74 @@ dc_device_close (dc_device_t *device)
 }
 
 
+static unsigned int
+device_pacing_floor (dc_transport_t transport)
+{
+	switch (transport) {
+	case DC_TRANSPORT_IRDA:
+		// The link is half-duplex, and the other side may need up
+		// to 10 ms to turn the link around before it can receive.
+		return 10;
+	default:
+		// Over BLE, every write already waits for the next connection
+		// event, and the other links have no minimum of their own.
+		return 0;
+	}
+}
+
+
+void
+device_pacing_init (dc_device_t *device, dc_iostream_t *iostream, unsigned int minimum, unsigned int maximum)
+{
+	assert (minimum <= maximum);
+
+	unsigned int base = device_pacing_floor (dc_iostream_get_transport (iostream));
+
+	device->pacing.delay = base + minimum;
+	device->pacing.minimum = base + minimum;
+	device->pacing.maximum = base + maximum;
+	device->pacing.nsuccess = 0;
+}
+
+
+void
+device_pacing_wait (dc_device_t *device, dc_iostream_t *iostream)
+{
+	if (device->pacing.delay) {
+		dc_iostream_sleep (iostream, device->pacing.delay);
+	}
+}
+
+
+void
+device_pacing_success (dc_device_t *device)
+{
+	dc_pacing_t *pacing = &device->pacing;
+
+	if (pacing->delay <= pacing->minimum)
+		return;
+
+	// Halve the delay after a window of consecutive successful packets.
+	if (++pacing->nsuccess >= PACING_WINDOW) {
+		pacing->delay = pacing->minimum + (pacing->delay - pacing->minimum) / 2;
+		pacing->nsuccess = 0;
+	}
+}
+
+
+void
+device_pacing_failure (dc_device_t *device)
+{
+	dc_pacing_t *pacing = &device->pacing;
+
+	// Increase the delay.
+	if (pacing->delay < pacing->maximum)
+		pacing->delay++;
+
+	pacing->nsuccess = 0;
+}
+
+
 void
 device_event_emit (dc_device_t *device, dc_event_type_t event, const void *data)
 {
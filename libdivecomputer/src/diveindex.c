@@ -0,0 +1,320 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 LibDCSwift contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(HAVE_PTHREAD_H) && !defined(_WIN32)
+#include <pthread.h>
+#define USE_PTHREAD
+#endif
+
+#include <libdivecomputer/diveindex.h>
+
+#include "context-private.h"
+#include "hw_ostc.h"
+#include "reefnet_sensusultra.h"
+#include "uwatec_smart.h"
+#include "cressi_leonardo.h"
+
+typedef struct dc_diveindex_record_t {
+	unsigned int offset;
+	unsigned int size;
+	unsigned int detached;
+	unsigned int foffset;
+	unsigned int fsize;
+} dc_diveindex_record_t;
+
+struct dc_diveindex_t {
+	dc_context_t *context;
+	const unsigned char *dump;
+	size_t dsize;
+	// Storage for the detached dives and the fingerprints.
+	dc_buffer_t *storage;
+	dc_diveindex_record_t *records;
+	unsigned int count;
+	unsigned int capacity;
+	dc_status_t status;
+};
+
+static int
+dc_diveindex_append (const unsigned char *data, unsigned int size, const unsigned char *fingerprint, unsigned int fsize, void *userdata)
+{
+	dc_diveindex_t *index = (dc_diveindex_t *) userdata;
+
+	// Grow the record array if necessary.
+	if (index->count == index->capacity) {
+		unsigned int capacity = index->capacity ? index->capacity * 2 : 64;
+		dc_diveindex_record_t *records = (dc_diveindex_record_t *) realloc (index->records, capacity * sizeof (dc_diveindex_record_t));
+		if (records == NULL) {
+			ERROR (index->context, "Failed to allocate memory.");
+			index->status = DC_STATUS_NOMEMORY;
+			return 0;
+		}
+		index->records = records;
+		index->capacity = capacity;
+	}
+
+	dc_diveindex_record_t *record = index->records + index->count;
+	record->size = size;
+	record->fsize = fsize;
+
+	if (data >= index->dump && size <= index->dsize &&
+		(size_t) (data - index->dump) <= index->dsize - size) {
+		// Reference the dive directly in the dump.
+		record->offset = data - index->dump;
+		record->detached = 0;
+	} else {
+		// Keep a private copy of the reassembled dive.
+		record->offset = dc_buffer_get_size (index->storage);
+		record->detached = 1;
+		if (!dc_buffer_append (index->storage, data, size)) {
+			ERROR (index->context, "Failed to allocate memory.");
+			index->status = DC_STATUS_NOMEMORY;
+			return 0;
+		}
+	}
+
+	record->foffset = dc_buffer_get_size (index->storage);
+	if (!dc_buffer_append (index->storage, fingerprint, fsize)) {
+		ERROR (index->context, "Failed to allocate memory.");
+		index->status = DC_STATUS_NOMEMORY;
+		return 0;
+	}
+
+	index->count++;
+
+	return 1;
+}
+
+dc_status_t
+dc_diveindex_new (dc_diveindex_t **out, dc_context_t *context, dc_descriptor_t *descriptor, dc_buffer_t *dump)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_diveindex_t *index = NULL;
+
+	if (out == NULL || descriptor == NULL || dump == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	index = (dc_diveindex_t *) malloc (sizeof (dc_diveindex_t));
+	if (index == NULL) {
+		ERROR (context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	index->context = context;
+	index->dump = dc_buffer_get_data (dump);
+	index->dsize = dc_buffer_get_size (dump);
+	index->records = NULL;
+	index->count = 0;
+	index->capacity = 0;
+	index->status = DC_STATUS_SUCCESS;
+	index->storage = dc_buffer_new (0);
+	if (index->storage == NULL) {
+		ERROR (context, "Failed to allocate memory.");
+		status = DC_STATUS_NOMEMORY;
+		goto error_free;
+	}
+
+	// Locate the dives in the memory dump. Without a device handle, the
+	// extraction doesn't stop at the fingerprint, and all dives present
+	// in the dump are indexed.
+	const unsigned char *data = index->dump;
+	unsigned int size = index->dsize;
+	switch (dc_descriptor_get_type (descriptor)) {
+	case DC_FAMILY_HW_OSTC:
+		status = hw_ostc_extract_dives (NULL, data, size, dc_diveindex_append, index);
+		break;
+	case DC_FAMILY_REEFNET_SENSUSULTRA:
+		status = reefnet_sensusultra_extract_dives (NULL, data, size, dc_diveindex_append, index);
+		break;
+	case DC_FAMILY_UWATEC_SMART:
+		status = uwatec_smart_extract_dives (NULL, data, size, dc_diveindex_append, index);
+		break;
+	case DC_FAMILY_CRESSI_LEONARDO:
+		status = cressi_leonardo_extract_dives (NULL, data, size, dc_diveindex_append, index);
+		break;
+	default:
+		status = DC_STATUS_UNSUPPORTED;
+		break;
+	}
+
+	if (status == DC_STATUS_SUCCESS)
+		status = index->status;
+	if (status != DC_STATUS_SUCCESS)
+		goto error_free;
+
+	*out = index;
+
+	return DC_STATUS_SUCCESS;
+
+error_free:
+	dc_diveindex_free (index);
+	return status;
+}
+
+unsigned int
+dc_diveindex_get_count (dc_diveindex_t *index)
+{
+	if (index == NULL)
+		return 0;
+
+	return index->count;
+}
+
+dc_status_t
+dc_diveindex_get_entry (dc_diveindex_t *index, unsigned int n, dc_diveindex_entry_t *entry)
+{
+	if (index == NULL || entry == NULL || n >= index->count)
+		return DC_STATUS_INVALIDARGS;
+
+	const dc_diveindex_record_t *record = index->records + n;
+	const unsigned char *storage = dc_buffer_get_data (index->storage);
+
+	if (record->detached) {
+		entry->offset = DC_DIVEINDEX_DETACHED;
+		entry->data = storage + record->offset;
+	} else {
+		entry->offset = record->offset;
+		entry->data = index->dump + record->offset;
+	}
+	entry->size = record->size;
+	entry->fingerprint = storage + record->foffset;
+	entry->fsize = record->fsize;
+
+	return DC_STATUS_SUCCESS;
+}
+
+typedef struct dc_diveindex_worker_t {
+	dc_diveindex_t *index;
+	dc_dive_callback_t callback;
+	void *userdata;
+	unsigned int next;
+	int stop;
+#ifdef USE_PTHREAD
+	pthread_mutex_t mutex;
+#endif
+} dc_diveindex_worker_t;
+
+static void *
+dc_diveindex_worker (void *arg)
+{
+	dc_diveindex_worker_t *worker = (dc_diveindex_worker_t *) arg;
+
+	while (1) {
+		// Claim the next dive.
+#ifdef USE_PTHREAD
+		pthread_mutex_lock (&worker->mutex);
+#endif
+		unsigned int n = worker->next;
+		int done = worker->stop || n >= worker->index->count;
+		if (!done)
+			worker->next++;
+#ifdef USE_PTHREAD
+		pthread_mutex_unlock (&worker->mutex);
+#endif
+		if (done)
+			break;
+
+		dc_diveindex_entry_t entry;
+		dc_diveindex_get_entry (worker->index, n, &entry);
+		if (!worker->callback (entry.data, entry.size, entry.fingerprint, entry.fsize, worker->userdata)) {
+#ifdef USE_PTHREAD
+			pthread_mutex_lock (&worker->mutex);
+#endif
+			worker->stop = 1;
+#ifdef USE_PTHREAD
+			pthread_mutex_unlock (&worker->mutex);
+#endif
+		}
+	}
+
+	return NULL;
+}
+
+dc_status_t
+dc_diveindex_foreach (dc_diveindex_t *index, unsigned int nthreads, dc_dive_callback_t callback, void *userdata)
+{
+	if (index == NULL || callback == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	dc_diveindex_worker_t worker;
+	worker.index = index;
+	worker.callback = callback;
+	worker.userdata = userdata;
+	worker.next = 0;
+	worker.stop = 0;
+
+#ifdef USE_PTHREAD
+	if (nthreads > index->count)
+		nthreads = index->count;
+
+	pthread_t *threads = NULL;
+	unsigned int nstarted = 0;
+	if (nthreads > 1) {
+		threads = (pthread_t *) malloc ((nthreads - 1) * sizeof (pthread_t));
+		if (threads == NULL) {
+			ERROR (index->context, "Failed to allocate memory.");
+			return DC_STATUS_NOMEMORY;
+		}
+	}
+
+	pthread_mutex_init (&worker.mutex, NULL);
+
+	// The calling thread acts as one of the workers. If a thread fails
+	// to start, the remaining workers simply process more dives.
+	for (unsigned int i = 0; i + 1 < nthreads; ++i) {
+		if (pthread_create (&threads[nstarted], NULL, dc_diveindex_worker, &worker) != 0) {
+			WARNING (index->context, "Failed to start worker thread.");
+			break;
+		}
+		nstarted++;
+	}
+
+	dc_diveindex_worker (&worker);
+
+	for (unsigned int i = 0; i < nstarted; ++i) {
+		pthread_join (threads[i], NULL);
+	}
+
+	pthread_mutex_destroy (&worker.mutex);
+	free (threads);
+#else
+	dc_diveindex_worker (&worker);
+#endif
+
+	return DC_STATUS_SUCCESS;
+}
+
+void
+dc_diveindex_free (dc_diveindex_t *index)
+{
+	if (index == NULL)
+		return;
+
+	dc_buffer_free (index->storage);
+	free (index->records);
+	free (index);
+}
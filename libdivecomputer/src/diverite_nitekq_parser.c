@@ -62,6 +62,7 @@ static const dc_parser_vtable_t diverite_nitekq_parser_vtable = {
 	diverite_nitekq_parser_get_datetime, /* datetime */
 	diverite_nitekq_parser_get_field, /* fields */
 	diverite_nitekq_parser_samples_foreach, /* samples_foreach */
+	NULL, /* summary */
 	NULL /* destroy */
 };
 
@@ -0,0 +1,670 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 LibDCSwift contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOGDI
+#include <windows.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#if defined(HAVE_PTHREAD_H) && !defined(_WIN32)
+#include <pthread.h>
+#define USE_PTHREAD
+#endif
+
+#include <libdivecomputer/fingerprint.h>
+
+#include "context-private.h"
+#include "checksum.h"
+#include "array.h"
+
+/*
+ * File format (all values little endian):
+ *
+ *    0  magic "DCFP"
+ *    4  version
+ *    8  number of fingerprints
+ *   12  reserved
+ *
+ * followed by every fingerprint:
+ *
+ *    0  family
+ *    4  model
+ *    8  serial number
+ *   12  fingerprint size
+ *   16  timestamp (64 bit)
+ *   24  fingerprint
+ *
+ * and a CRC-32 of all the preceding bytes.
+ */
+
+#define VERSION   1
+#define SZ_HEADER 16
+#define SZ_RECORD 24
+
+static const unsigned char magic[] = {'D', 'C', 'F', 'P'};
+
+typedef struct dc_fingerprint_entry_t {
+	dc_family_t family;
+	unsigned int model;
+	unsigned int serial;
+	dc_ticks_t timestamp;
+	// NULL for an empty slot.
+	unsigned char *fingerprint;
+	unsigned int fsize;
+} dc_fingerprint_entry_t;
+
+struct dc_fingerprint_store_t {
+	dc_context_t *context;
+	char *filename;
+	// Open addressing hash table, with linear probing. The capacity is
+	// a power of two, and at most half of the slots are in use.
+	dc_fingerprint_entry_t *table;
+	unsigned int capacity;
+	unsigned int count;
+#ifdef USE_PTHREAD
+	pthread_mutex_t mutex;
+#endif
+};
+
+static void
+dc_fingerprint_store_lock (dc_fingerprint_store_t *store)
+{
+#ifdef USE_PTHREAD
+	pthread_mutex_lock (&store->mutex);
+#endif
+}
+
+static void
+dc_fingerprint_store_unlock (dc_fingerprint_store_t *store)
+{
+#ifdef USE_PTHREAD
+	pthread_mutex_unlock (&store->mutex);
+#endif
+}
+
+static unsigned int
+dc_fingerprint_hash (dc_family_t family, unsigned int model, unsigned int serial)
+{
+	unsigned int hash = (unsigned int) family * 0x9E3779B1u;
+	hash ^= model * 0x85EBCA77u;
+	hash ^= serial * 0xC2B2AE3Du;
+	hash ^= hash >> 15;
+	hash *= 0x2C1B3C6Du;
+	hash ^= hash >> 12;
+	return hash;
+}
+
+/*
+ * Locate the slot of the key, or the empty slot where it would be
+ * inserted.
+ */
+static unsigned int
+dc_fingerprint_find (dc_fingerprint_entry_t *table, unsigned int capacity, dc_family_t family, unsigned int model, unsigned int serial)
+{
+	unsigned int mask = capacity - 1;
+	unsigned int i = dc_fingerprint_hash (family, model, serial) & mask;
+	while (table[i].fingerprint != NULL) {
+		if (table[i].family == family &&
+			table[i].model == model &&
+			table[i].serial == serial)
+			break;
+		i = (i + 1) & mask;
+	}
+
+	return i;
+}
+
+static dc_status_t
+dc_fingerprint_reserve (dc_fingerprint_store_t *store, unsigned int count)
+{
+	if (count <= store->capacity / 2)
+		return DC_STATUS_SUCCESS;
+
+	unsigned int capacity = store->capacity ? store->capacity : 16;
+	while (count > capacity / 2)
+		capacity *= 2;
+
+	dc_fingerprint_entry_t *table = (dc_fingerprint_entry_t *) calloc (capacity, sizeof (dc_fingerprint_entry_t));
+	if (table == NULL) {
+		ERROR (store->context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	for (unsigned int i = 0; i < store->capacity; ++i) {
+		const dc_fingerprint_entry_t *entry = store->table + i;
+		if (entry->fingerprint == NULL)
+			continue;
+		table[dc_fingerprint_find (table, capacity, entry->family, entry->model, entry->serial)] = *entry;
+	}
+
+	free (store->table);
+	store->table = table;
+	store->capacity = capacity;
+
+	return DC_STATUS_SUCCESS;
+}
+
+/*
+ * Remove the entry from the slot, and move the following entries of
+ * the same probe sequence back, to keep them reachable.
+ */
+static void
+dc_fingerprint_erase (dc_fingerprint_store_t *store, unsigned int i)
+{
+	unsigned int mask = store->capacity - 1;
+	unsigned int j = i;
+
+	store->table[i].fingerprint = NULL;
+
+	while (1) {
+		j = (j + 1) & mask;
+		dc_fingerprint_entry_t *entry = store->table + j;
+		if (entry->fingerprint == NULL)
+			break;
+
+		// The entry can move to the free slot, unless its home slot is
+		// located cyclically in (i, j].
+		unsigned int home = dc_fingerprint_hash (entry->family, entry->model, entry->serial) & mask;
+		if (((j - home) & mask) >= ((j - i) & mask)) {
+			store->table[i] = *entry;
+			entry->fingerprint = NULL;
+			i = j;
+		}
+	}
+
+	store->count--;
+}
+
+static void
+dc_fingerprint_free_table (dc_fingerprint_entry_t *table, unsigned int capacity)
+{
+	for (unsigned int i = 0; i < capacity; ++i) {
+		free (table[i].fingerprint);
+	}
+	free (table);
+}
+
+static dc_status_t
+dc_fingerprint_insert (dc_fingerprint_store_t *store, dc_family_t family, unsigned int model, unsigned int serial, const unsigned char fingerprint[], unsigned int fsize, dc_ticks_t timestamp)
+{
+	dc_status_t status = dc_fingerprint_reserve (store, store->count + 1);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	unsigned char *copy = (unsigned char *) malloc (fsize);
+	if (copy == NULL) {
+		ERROR (store->context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
+	}
+	memcpy (copy, fingerprint, fsize);
+
+	dc_fingerprint_entry_t *entry = store->table + dc_fingerprint_find (store->table, store->capacity, family, model, serial);
+	if (entry->fingerprint == NULL) {
+		store->count++;
+	}
+
+	free (entry->fingerprint);
+	entry->family = family;
+	entry->model = model;
+	entry->serial = serial;
+	entry->timestamp = timestamp;
+	entry->fingerprint = copy;
+	entry->fsize = fsize;
+
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+dc_fingerprint_load (dc_fingerprint_store_t *store)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_buffer_t *buffer = NULL;
+	FILE *fp = NULL;
+
+	fp = fopen (store->filename, "rb");
+	if (fp == NULL) {
+		if (errno == ENOENT)
+			return DC_STATUS_SUCCESS;
+		ERROR (store->context, "Failed to open the fingerprint store.");
+		return DC_STATUS_IO;
+	}
+
+	buffer = dc_buffer_new (0);
+	if (buffer == NULL) {
+		ERROR (store->context, "Failed to allocate memory.");
+		status = DC_STATUS_NOMEMORY;
+		goto error_close;
+	}
+
+	unsigned char block[1024];
+	size_t nbytes = 0;
+	while ((nbytes = fread (block, 1, sizeof (block), fp)) > 0) {
+		if (!dc_buffer_append (buffer, block, nbytes)) {
+			ERROR (store->context, "Failed to allocate memory.");
+			status = DC_STATUS_NOMEMORY;
+			goto error_free;
+		}
+	}
+
+	if (ferror (fp)) {
+		ERROR (store->context, "Failed to read the fingerprint store.");
+		status = DC_STATUS_IO;
+		goto error_free;
+	}
+
+	const unsigned char *data = dc_buffer_get_data (buffer);
+	size_t size = dc_buffer_get_size (buffer);
+
+	if (size < SZ_HEADER + 4 || memcmp (data, magic, sizeof (magic)) != 0) {
+		ERROR (store->context, "Invalid fingerprint store header.");
+		status = DC_STATUS_DATAFORMAT;
+		goto error_free;
+	}
+
+	unsigned int version = array_uint32_le (data + 4);
+	if (version != VERSION) {
+		ERROR (store->context, "Unsupported fingerprint store version (%u).", version);
+		status = DC_STATUS_UNSUPPORTED;
+		goto error_free;
+	}
+
+	size -= 4;
+	if (checksum_crc32r (data, size) != array_uint32_le (data + size)) {
+		ERROR (store->context, "Unexpected fingerprint store checksum.");
+		status = DC_STATUS_DATAFORMAT;
+		goto error_free;
+	}
+
+	unsigned int count = array_uint32_le (data + 8);
+	size_t offset = SZ_HEADER;
+	for (unsigned int i = 0; i < count; ++i) {
+		if (offset + SZ_RECORD > size) {
+			ERROR (store->context, "Unexpected end of the fingerprint store.");
+			status = DC_STATUS_DATAFORMAT;
+			goto error_free;
+		}
+
+		const unsigned char *record = data + offset;
+		unsigned int fsize = array_uint32_le (record + 12);
+		if (fsize == 0 || fsize > size - offset - SZ_RECORD) {
+			ERROR (store->context, "Invalid fingerprint size (%u).", fsize);
+			status = DC_STATUS_DATAFORMAT;
+			goto error_free;
+		}
+
+		status = dc_fingerprint_insert (store,
+			(dc_family_t) array_uint32_le (record),
+			array_uint32_le (record + 4),
+			array_uint32_le (record + 8),
+			record + SZ_RECORD, fsize,
+			(dc_ticks_t) array_uint64_le (record + 16));
+		if (status != DC_STATUS_SUCCESS)
+			goto error_free;
+
+		offset += SZ_RECORD + fsize;
+	}
+
+error_free:
+	dc_buffer_free (buffer);
+error_close:
+	fclose (fp);
+	return status;
+}
+
+static dc_status_t
+dc_fingerprint_save (dc_fingerprint_store_t *store)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_buffer_t *buffer = NULL;
+	char *tmpname = NULL;
+	FILE *fp = NULL;
+
+	buffer = dc_buffer_new (SZ_HEADER + store->count * (SZ_RECORD + 8) + 4);
+	if (buffer == NULL) {
+		ERROR (store->context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	unsigned char header[SZ_HEADER] = {0};
+	memcpy (header, magic, sizeof (magic));
+	array_uint32_le_set (header + 4, VERSION);
+	array_uint32_le_set (header + 8, store->count);
+	int success = dc_buffer_append (buffer, header, sizeof (header));
+
+	for (unsigned int i = 0; i < store->capacity && success; ++i) {
+		const dc_fingerprint_entry_t *entry = store->table + i;
+		if (entry->fingerprint == NULL)
+			continue;
+
+		unsigned char record[SZ_RECORD] = {0};
+		array_uint32_le_set (record, entry->family);
+		array_uint32_le_set (record + 4, entry->model);
+		array_uint32_le_set (record + 8, entry->serial);
+		array_uint32_le_set (record + 12, entry->fsize);
+		array_uint64_le_set (record + 16, entry->timestamp);
+		success = dc_buffer_append (buffer, record, sizeof (record)) &&
+			dc_buffer_append (buffer, entry->fingerprint, entry->fsize);
+	}
+
+	unsigned char crc[4];
+	array_uint32_le_set (crc, checksum_crc32r (dc_buffer_get_data (buffer), dc_buffer_get_size (buffer)));
+	if (!success || !dc_buffer_append (buffer, crc, sizeof (crc))) {
+		ERROR (store->context, "Failed to allocate memory.");
+		status = DC_STATUS_NOMEMORY;
+		goto error_free;
+	}
+
+	// Write a new file next to the store, and replace the store once the
+	// new contents are on disk.
+	size_t length = strlen (store->filename);
+	tmpname = (char *) malloc (length + 5);
+	if (tmpname == NULL) {
+		ERROR (store->context, "Failed to allocate memory.");
+		status = DC_STATUS_NOMEMORY;
+		goto error_free;
+	}
+	memcpy (tmpname, store->filename, length);
+	memcpy (tmpname + length, ".tmp", 5);
+
+	fp = fopen (tmpname, "wb");
+	if (fp == NULL) {
+		ERROR (store->context, "Failed to create the fingerprint store.");
+		status = DC_STATUS_IO;
+		goto error_free;
+	}
+
+	size_t size = dc_buffer_get_size (buffer);
+	int rc = fwrite (dc_buffer_get_data (buffer), 1, size, fp) != size || fflush (fp) != 0;
+#ifdef _WIN32
+	rc = rc || _commit (_fileno (fp)) != 0;
+#else
+	rc = rc || fsync (fileno (fp)) != 0;
+#endif
+	rc = fclose (fp) != 0 || rc;
+	if (rc) {
+		ERROR (store->context, "Failed to write the fingerprint store.");
+		status = DC_STATUS_IO;
+		goto error_remove;
+	}
+
+#ifdef _WIN32
+	rc = !MoveFileExA (tmpname, store->filename, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+	rc = rename (tmpname, store->filename) != 0;
+#endif
+	if (rc) {
+		ERROR (store->context, "Failed to replace the fingerprint store.");
+		status = DC_STATUS_IO;
+		goto error_remove;
+	}
+
+	free (tmpname);
+	dc_buffer_free (buffer);
+
+	return DC_STATUS_SUCCESS;
+
+error_remove:
+	remove (tmpname);
+error_free:
+	free (tmpname);
+	dc_buffer_free (buffer);
+	return status;
+}
+
+dc_status_t
+dc_fingerprint_store_open (dc_fingerprint_store_t **out, dc_context_t *context, const char *filename)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_fingerprint_store_t *store = NULL;
+
+	if (out == NULL || filename == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	store = (dc_fingerprint_store_t *) malloc (sizeof (dc_fingerprint_store_t));
+	if (store == NULL) {
+		ERROR (context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	store->context = context;
+	store->table = NULL;
+	store->capacity = 0;
+	store->count = 0;
+	store->filename = (char *) malloc (strlen (filename) + 1);
+	if (store->filename == NULL) {
+		ERROR (context, "Failed to allocate memory.");
+		free (store);
+		return DC_STATUS_NOMEMORY;
+	}
+	strcpy (store->filename, filename);
+
+#ifdef USE_PTHREAD
+	pthread_mutex_init (&store->mutex, NULL);
+#endif
+
+	status = dc_fingerprint_reserve (store, 1);
+	if (status != DC_STATUS_SUCCESS)
+		goto error_close;
+
+	status = dc_fingerprint_load (store);
+	if (status != DC_STATUS_SUCCESS)
+		goto error_close;
+
+	*out = store;
+
+	return DC_STATUS_SUCCESS;
+
+error_close:
+	dc_fingerprint_store_close (store);
+	return status;
+}
+
+dc_status_t
+dc_fingerprint_store_get (dc_fingerprint_store_t *store, dc_family_t family, unsigned int model, unsigned int serial, dc_buffer_t *fingerprint, dc_ticks_t *timestamp)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+
+	if (store == NULL || fingerprint == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	dc_fingerprint_store_lock (store);
+
+	const dc_fingerprint_entry_t *entry = store->table + dc_fingerprint_find (store->table, store->capacity, family, model, serial);
+	if (entry->fingerprint == NULL) {
+		status = DC_STATUS_DONE;
+	} else if (!dc_buffer_clear (fingerprint) ||
+		!dc_buffer_append (fingerprint, entry->fingerprint, entry->fsize)) {
+		ERROR (store->context, "Failed to allocate memory.");
+		status = DC_STATUS_NOMEMORY;
+	} else if (timestamp) {
+		*timestamp = entry->timestamp;
+	}
+
+	dc_fingerprint_store_unlock (store);
+
+	return status;
+}
+
+dc_status_t
+dc_fingerprint_store_set (dc_fingerprint_store_t *store, dc_family_t family, unsigned int model, unsigned int serial, const unsigned char fingerprint[], unsigned int fsize)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+
+	if (store == NULL || fingerprint == NULL || fsize == 0)
+		return DC_STATUS_INVALIDARGS;
+
+	dc_fingerprint_store_lock (store);
+
+	// Keep the previous fingerprint, to restore it if the store can't be
+	// written.
+	dc_fingerprint_entry_t previous = store->table[dc_fingerprint_find (store->table, store->capacity, family, model, serial)];
+	if (previous.fingerprint) {
+		unsigned char *copy = (unsigned char *) malloc (previous.fsize);
+		if (copy == NULL) {
+			ERROR (store->context, "Failed to allocate memory.");
+			status = DC_STATUS_NOMEMORY;
+			goto error_unlock;
+		}
+		memcpy (copy, previous.fingerprint, previous.fsize);
+		previous.fingerprint = copy;
+	}
+
+	status = dc_fingerprint_insert (store, family, model, serial, fingerprint, fsize, dc_datetime_now ());
+	if (status != DC_STATUS_SUCCESS)
+		goto error_free;
+
+	status = dc_fingerprint_save (store);
+	if (status != DC_STATUS_SUCCESS) {
+		unsigned int i = dc_fingerprint_find (store->table, store->capacity, family, model, serial);
+		if (previous.fingerprint) {
+			free (store->table[i].fingerprint);
+			store->table[i] = previous;
+			previous.fingerprint = NULL;
+		} else {
+			free (store->table[i].fingerprint);
+			dc_fingerprint_erase (store, i);
+		}
+	}
+
+error_free:
+	free (previous.fingerprint);
+error_unlock:
+	dc_fingerprint_store_unlock (store);
+	return status;
+}
+
+dc_status_t
+dc_fingerprint_store_remove (dc_fingerprint_store_t *store, dc_family_t family, unsigned int model, unsigned int serial)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+
+	if (store == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	dc_fingerprint_store_lock (store);
+
+	unsigned int i = dc_fingerprint_find (store->table, store->capacity, family, model, serial);
+	dc_fingerprint_entry_t previous = store->table[i];
+	if (previous.fingerprint == NULL)
+		goto error_unlock;
+
+	dc_fingerprint_erase (store, i);
+
+	status = dc_fingerprint_save (store);
+	if (status != DC_STATUS_SUCCESS) {
+		// The table has room for the entry it contained before.
+		store->table[dc_fingerprint_find (store->table, store->capacity, family, model, serial)] = previous;
+		store->count++;
+		goto error_unlock;
+	}
+
+	free (previous.fingerprint);
+
+error_unlock:
+	dc_fingerprint_store_unlock (store);
+	return status;
+}
+
+dc_status_t
+dc_fingerprint_store_clear (dc_fingerprint_store_t *store)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+
+	if (store == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	dc_fingerprint_store_lock (store);
+
+	dc_fingerprint_entry_t *table = store->table;
+	unsigned int capacity = store->capacity;
+	unsigned int count = store->count;
+
+	store->table = NULL;
+	store->capacity = 0;
+	store->count = 0;
+
+	status = dc_fingerprint_reserve (store, 1);
+	if (status == DC_STATUS_SUCCESS)
+		status = dc_fingerprint_save (store);
+
+	if (status != DC_STATUS_SUCCESS) {
+		free (store->table);
+		store->table = table;
+		store->capacity = capacity;
+		store->count = count;
+	} else {
+		dc_fingerprint_free_table (table, capacity);
+	}
+
+	dc_fingerprint_store_unlock (store);
+
+	return status;
+}
+
+dc_status_t
+dc_fingerprint_store_foreach (dc_fingerprint_store_t *store, dc_fingerprint_callback_t callback, void *userdata)
+{
+	if (store == NULL || callback == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	dc_fingerprint_store_lock (store);
+
+	for (unsigned int i = 0; i < store->capacity; ++i) {
+		const dc_fingerprint_entry_t *entry = store->table + i;
+		if (entry->fingerprint == NULL)
+			continue;
+
+		if (!callback (entry->family, entry->model, entry->serial, entry->fingerprint, entry->fsize, entry->timestamp, userdata))
+			break;
+	}
+
+	dc_fingerprint_store_unlock (store);
+
+	return DC_STATUS_SUCCESS;
+}
+
+void
+dc_fingerprint_store_close (dc_fingerprint_store_t *store)
+{
+	if (store == NULL)
+		return;
+
+#ifdef USE_PTHREAD
+	pthread_mutex_destroy (&store->mutex);
+#endif
+
+	dc_fingerprint_free_table (store->table, store->capacity);
+	free (store->filename);
+	free (store);
+}
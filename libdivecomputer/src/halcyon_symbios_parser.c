@@ -109,6 +109,7 @@ static const dc_parser_vtable_t halcyon_symbios_parser_vtable = {
 	halcyon_symbios_parser_get_datetime, /* datetime */
 	halcyon_symbios_parser_get_field, /* fields */
 	halcyon_symbios_parser_samples_foreach, /* samples_foreach */
+	NULL, /* summary */
 	NULL /* destroy */
 };
 
@@ -20,12 +20,14 @@
  */
 
 #include <stdlib.h> // malloc, free
+#include <string.h> // memcpy, memchr
 
 #include "hdlc.h"
 
 #include "iostream-private.h"
 #include "common-private.h"
 #include "context-private.h"
+#include "array.h"
 
 #define END     0x7E
 #define ESC     0x7D
@@ -222,6 +224,28 @@ dc_hdlc_read (dc_iostream_t *abstract, void *data, size_t size, size_t *actual)
 		}
 
 		while (hdlc->rbuf_available) {
+			const unsigned char *p = hdlc->rbuf + hdlc->rbuf_offset;
+
+			if (!initialized) {
+				// Skip everything up to the start of the frame.
+				const unsigned char *end = (const unsigned char *) memchr (p, END, hdlc->rbuf_available);
+				size_t n = end ? (size_t) (end - p) : hdlc->rbuf_available;
+				hdlc->rbuf_offset += n;
+				hdlc->rbuf_available -= n;
+				if (end == NULL)
+					break;
+			} else if (!escaped) {
+				// Copy the run of ordinary characters in bulk.
+				size_t n = array_cspan (p, hdlc->rbuf_available, END, ESC);
+				if (nbytes < size)
+					memcpy ((unsigned char *) data + nbytes, p, n < size - nbytes ? n : size - nbytes);
+				nbytes += n;
+				hdlc->rbuf_offset += n;
+				hdlc->rbuf_available -= n;
+				if (hdlc->rbuf_available == 0)
+					break;
+			}
+
 			unsigned char c = hdlc->rbuf[hdlc->rbuf_offset];
 			hdlc->rbuf_offset++;
 			hdlc->rbuf_available--;
@@ -279,64 +303,74 @@ out:
 	return status;
 }
 
+static dc_status_t
+dc_hdlc_append (dc_hdlc_t *hdlc, const unsigned char data[], size_t size)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+
+	while (size) {
+		size_t n = hdlc->wbuf_size - hdlc->wbuf_offset;
+		if (n > size)
+			n = size;
+
+		// Append the characters.
+		memcpy (hdlc->wbuf + hdlc->wbuf_offset, data, n);
+		hdlc->wbuf_offset += n;
+		data += n;
+		size -= n;
+
+		// Flush the buffer if necessary.
+		if (hdlc->wbuf_offset >= hdlc->wbuf_size) {
+			status = dc_iostream_write (hdlc->iostream, hdlc->wbuf, hdlc->wbuf_offset, NULL);
+			if (status != DC_STATUS_SUCCESS) {
+				return status;
+			}
+
+			hdlc->wbuf_offset = 0;
+		}
+	}
+
+	return status;
+}
+
 static dc_status_t
 dc_hdlc_write (dc_iostream_t *abstract, const void *data, size_t size, size_t *actual)
 {
 	dc_status_t status = DC_STATUS_SUCCESS;
 	dc_hdlc_t *hdlc = (dc_hdlc_t *) abstract;
+	const unsigned char *p = (const unsigned char *) data;
+	const unsigned char end[] = {END};
 	size_t nbytes = 0;
 
 	// Clear the buffer.
 	hdlc->wbuf_offset = 0;
 
 	// Start of the packet.
-	hdlc->wbuf[hdlc->wbuf_offset++] = END;
-
-	// Flush the buffer if necessary.
-	if (hdlc->wbuf_offset >= hdlc->wbuf_size) {
-		status = dc_iostream_write (hdlc->iostream, hdlc->wbuf, hdlc->wbuf_offset, NULL);
-		if (status != DC_STATUS_SUCCESS) {
-			goto out;
-		}
-
-		hdlc->wbuf_offset = 0;
+	status = dc_hdlc_append (hdlc, end, sizeof(end));
+	if (status != DC_STATUS_SUCCESS) {
+		goto out;
 	}
 
 	while (nbytes < size) {
-		unsigned char c = ((const unsigned char *) data)[nbytes];
-
-		if (c == END || c == ESC) {
-			// Append the escape character.
-			hdlc->wbuf[hdlc->wbuf_offset++] = ESC;
-
-			// Flush the buffer if necessary.
-			if (hdlc->wbuf_offset >= hdlc->wbuf_size) {
-				status = dc_iostream_write (hdlc->iostream, hdlc->wbuf, hdlc->wbuf_offset, NULL);
-				if (status != DC_STATUS_SUCCESS) {
-					goto out;
-				}
-
-				hdlc->wbuf_offset = 0;
-			}
-
-			// Escape the character.
-			c ^= ESC_BIT;
+		// Append the run of ordinary characters in bulk.
+		size_t n = array_cspan (p + nbytes, size - nbytes, END, ESC);
+		status = dc_hdlc_append (hdlc, p + nbytes, n);
+		if (status != DC_STATUS_SUCCESS) {
+			goto out;
 		}
 
-		// Append the character.
-		hdlc->wbuf[hdlc->wbuf_offset++] = c;
+		nbytes += n;
 
-		// Flush the buffer if necessary.
-		if (hdlc->wbuf_offset >= hdlc->wbuf_size) {
-			status = dc_iostream_write (hdlc->iostream, hdlc->wbuf, hdlc->wbuf_offset, NULL);
+		if (nbytes < size) {
+			// Escape the special character.
+			const unsigned char escaped[] = {ESC, p[nbytes] ^ ESC_BIT};
+			status = dc_hdlc_append (hdlc, escaped, sizeof(escaped));
 			if (status != DC_STATUS_SUCCESS) {
 				goto out;
 			}
 
-			hdlc->wbuf_offset = 0;
+			nbytes++;
 		}
-
-		nbytes++;
 	}
 
 	// End of the packet.
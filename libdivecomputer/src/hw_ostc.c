@@ -81,9 +81,6 @@ static const dc_device_vtable_t hw_ostc_device_vtable = {
 	NULL /* close */
 };
 
-static dc_status_t
-hw_ostc_extract_dives (dc_device_t *device, const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata);
-
 static dc_status_t
 hw_ostc_send (hw_ostc_device_t *device, unsigned char cmd, unsigned int echo)
 {
@@ -594,7 +591,7 @@ hw_ostc_device_screenshot (dc_device_t *abstract, dc_buffer_t *buffer, hw_ostc_f
 }
 
 
-static dc_status_t
+dc_status_t
 hw_ostc_extract_dives (dc_device_t *abstract, const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata)
 {
 	hw_ostc_device_t *device = (hw_ostc_device_t *) abstract;
@@ -602,6 +599,9 @@ hw_ostc_extract_dives (dc_device_t *abstract, const unsigned char data[], unsign
 	if (abstract && !ISINSTANCE (abstract))
 		return DC_STATUS_INVALIDARGS;
 
+	if (size < 266)
+		return DC_STATUS_DATAFORMAT;
+
 	const unsigned char header[2] = {0xFA, 0xFA};
 	const unsigned char footer[2] = {0xFD, 0xFD};
 
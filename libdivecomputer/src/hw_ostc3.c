@@ -791,13 +791,17 @@ hw_ostc3_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback, voi
 	// The device maintains an internal counter which is incremented for every
 	// dive, and the current value at the time of the dive is stored in the
 	// dive header. Thus the most recent dive will have the highest value.
+	// Uninitialized header entries are remembered, such that the headers
+	// only need to be scanned once.
 	unsigned int latest = 0;
 	unsigned int maximum = 0;
+	unsigned char empty[RB_LOGBOOK_COUNT] = {0};
 	for (unsigned int i = 0; i < RB_LOGBOOK_COUNT; ++i) {
 		unsigned int offset = i * logbook->size;
 
 		// Ignore uninitialized header entries.
-		if (array_isequal (header + offset, logbook->size, 0xFF))
+		empty[i] = array_isequal (header + offset, logbook->size, 0xFF);
+		if (empty[i])
 			continue;
 
 		// Get the internal dive number.
@@ -813,12 +817,13 @@ hw_ostc3_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback, voi
 	unsigned int size = 0;
 	unsigned int maxsize = 0;
 	unsigned char dive[RB_LOGBOOK_COUNT] = {0};
+	unsigned int lengths[RB_LOGBOOK_COUNT] = {0};
 	for (unsigned int i = 0; i < RB_LOGBOOK_COUNT; ++i) {
 		unsigned int idx = (latest + RB_LOGBOOK_COUNT - i) % RB_LOGBOOK_COUNT;
 		unsigned int offset = idx * logbook->size;
 
 		// Ignore uninitialized header entries.
-		if (array_isequal (header + offset, logbook->size, 0xFF)) {
+		if (empty[idx]) {
 			WARNING (abstract->context, "Unexpected empty header found.");
 			continue;
 		}
@@ -845,6 +850,7 @@ hw_ostc3_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback, voi
 			maxsize = length;
 		size += length;
 		dive[ndives] = idx;
+		lengths[ndives] = length;
 		ndives++;
 	}
 
@@ -870,15 +876,7 @@ hw_ostc3_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback, voi
 	for (unsigned int i = 0; i < ndives; ++i) {
 		unsigned int idx = dive[i];
 		unsigned int offset = idx * logbook->size;
-
-		// Calculate the profile length.
-		unsigned int length = RB_LOGBOOK_SIZE_FULL + array_uint24_le (header + offset + logbook->profile) - 3;
-		if (!compact) {
-			// Workaround for a bug in older firmware versions.
-			unsigned int firmware = array_uint16_be (header + offset + HDR_FULL_FIRMWARE);
-			if (firmware < OSTC3FW(0,93))
-				length -= 3;
-		}
+		unsigned int length = lengths[i];
 
 		// Download the dive.
 		unsigned char number[1] = {idx};
@@ -1168,6 +1166,7 @@ hw_ostc3_firmware_readfile3 (hw_ostc3_firmware_t *firmware, dc_context_t *contex
 	unsigned char encrypted[16] = {0};
 	unsigned int bytes = 0, addr = 0;
 	unsigned char checksum[4];
+	aes128_key_t key;
 
 	if (firmware == NULL) {
 		ERROR (context, "Invalid arguments.");
@@ -1192,8 +1191,11 @@ hw_ostc3_firmware_readfile3 (hw_ostc3_firmware_t *firmware, dc_context_t *contex
 	}
 	bytes += 16;
 
+	// The same key is used for every block.
+	AES128_key_expand (&key, ostc3_key);
+
 	// Load the iv for AES-FCB-mode
-	AES128_ECB_encrypt (iv, ostc3_key, tmpbuf);
+	AES128_ECB_encrypt_expanded (iv, &key, tmpbuf);
 
 	for (addr = 0; addr < SZ_FIRMWARE; addr += 16, bytes += 16) {
 		rc = hw_ostc3_firmware_readline (fp, context, bytes, encrypted, sizeof(encrypted));
@@ -1208,7 +1210,7 @@ hw_ostc3_firmware_readfile3 (hw_ostc3_firmware_t *firmware, dc_context_t *contex
 			firmware->data[addr + i] = encrypted[i] ^ tmpbuf[i];
 
 		// Run the next round of encryption
-		AES128_ECB_encrypt (encrypted, ostc3_key, tmpbuf);
+		AES128_ECB_encrypt_expanded (encrypted, &key, tmpbuf);
 	}
 
 	// This file format contains a tail with the checksum in
@@ -134,6 +134,7 @@ typedef struct hw_ostc_parser_t {
 static dc_status_t hw_ostc_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t hw_ostc_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t hw_ostc_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
+static dc_status_t hw_ostc_parser_summary (dc_parser_t *abstract, dc_summary_t *summary);
 
 static dc_status_t hw_ostc_parser_internal_foreach (hw_ostc_parser_t *parser, dc_sample_callback_t callback, void *userdata);
 
@@ -146,6 +147,7 @@ static const dc_parser_vtable_t hw_ostc_parser_vtable = {
 	hw_ostc_parser_get_datetime, /* datetime */
 	hw_ostc_parser_get_field, /* fields */
 	hw_ostc_parser_samples_foreach, /* samples_foreach */
+	hw_ostc_parser_summary, /* summary */
 	NULL /* destroy */
 };
 
@@ -509,8 +511,10 @@ hw_ostc_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned
 	if (rc != DC_STATUS_SUCCESS)
 		return rc;
 
-	// Cache the profile data.
-	if (parser->cached < PROFILE) {
+	// Cache the profile data. Only the manually entered gas mixes
+	// are not stored in the header.
+	if ((type == DC_FIELD_GASMIX_COUNT || type == DC_FIELD_GASMIX) &&
+		parser->cached < PROFILE) {
 		rc = hw_ostc_parser_internal_foreach (parser, NULL, NULL);
 		if (rc != DC_STATUS_SUCCESS)
 			return rc;
@@ -698,6 +702,13 @@ hw_ostc_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned
 }
 
 
+static dc_status_t
+hw_ostc_parser_summary (dc_parser_t *abstract, dc_summary_t *summary)
+{
+	return dc_parser_summary_fill (abstract, summary, ~DC_FIELD_MASK (DC_FIELD_GASMIX_COUNT));
+}
+
+
 static dc_status_t
 hw_ostc_parser_internal_foreach (hw_ostc_parser_t *parser, dc_sample_callback_t callback, void *userdata)
 {
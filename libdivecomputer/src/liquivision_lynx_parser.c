@@ -130,6 +130,7 @@ static const dc_parser_vtable_t liquivision_lynx_parser_vtable = {
 	liquivision_lynx_parser_get_datetime, /* datetime */
 	liquivision_lynx_parser_get_field, /* fields */
 	liquivision_lynx_parser_samples_foreach, /* samples_foreach */
+	NULL, /* summary */
 	NULL /* destroy */
 };
 
@@ -54,7 +54,7 @@ mares_common_device_init (mares_common_device_t *device, dc_iostream_t *iostream
 	// Set the default values.
 	device->iostream = iostream;
 	device->echo = 0;
-	device->delay = 0;
+	device_pacing_init ((dc_device_t *) device, iostream, 0, MAXDELAY);
 }
 
 
@@ -87,9 +87,7 @@ mares_common_packet (mares_common_device_t *device, const unsigned char command[
 	if (device_is_cancelled (abstract))
 		return DC_STATUS_CANCELLED;
 
-	if (device->delay) {
-		dc_iostream_sleep (device->iostream, device->delay);
-	}
+	device_pacing_wait (abstract, device->iostream);
 
 	// Send the command to the device.
 	status = dc_iostream_write (device->iostream, command, csize, NULL);
@@ -135,6 +133,8 @@ mares_common_packet (mares_common_device_t *device, const unsigned char command[
 		return DC_STATUS_PROTOCOL;
 	}
 
+	device_pacing_success (abstract);
+
 	return DC_STATUS_SUCCESS;
 }
 
@@ -154,6 +154,9 @@ mares_common_transfer (mares_common_device_t *device, const unsigned char comman
 		if (nretries++ >= MAXRETRIES)
 			return rc;
 
+		// Increase the inter packet delay.
+		device_pacing_failure ((dc_device_t *) device);
+
 		// Discard any garbage bytes.
 		dc_iostream_sleep (device->iostream, 100);
 		dc_iostream_purge (device->iostream, DC_DIRECTION_INPUT);
@@ -31,6 +31,7 @@ extern "C" {
 #endif /* __cplusplus */
 
 #define PACKETSIZE 0x20
+#define MAXDELAY   16
 
 typedef struct mares_common_layout_t {
 	unsigned int memsize;
@@ -44,7 +45,6 @@ typedef struct mares_common_device_t {
 	dc_device_t base;
 	dc_iostream_t *iostream;
 	unsigned int echo;
-	unsigned int delay;
 } mares_common_device_t;
 
 void
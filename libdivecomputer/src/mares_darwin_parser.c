@@ -60,6 +60,7 @@ static const dc_parser_vtable_t mares_darwin_parser_vtable = {
 	mares_darwin_parser_get_datetime, /* datetime */
 	mares_darwin_parser_get_field, /* fields */
 	mares_darwin_parser_samples_foreach, /* samples_foreach */
+	NULL, /* summary */
 	NULL /* destroy */
 };
 
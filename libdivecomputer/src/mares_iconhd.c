@@ -1103,24 +1103,67 @@ mares_iconhd_device_foreach_object (dc_device_t *abstract, dc_dive_callback_t ca
 	progress.maximum = (1 + ndives * 2) * NSTEPS;
 	device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
 
-	// Download the dives.
-	for (unsigned int i = 0; i < ndives; ++i) {
-		// Erase the buffer.
-		dc_buffer_clear (buffer);
+	// Allocate memory for the dive headers.
+	dc_buffer_t *headers = dc_buffer_new (0);
+	unsigned int *offsets = (unsigned int *) malloc ((ndives + 1) * sizeof (unsigned int));
+	if (headers == NULL || offsets == NULL) {
+		ERROR (abstract->context, "Failed to allocate memory.");
+		free (offsets);
+		dc_buffer_free (headers);
+		dc_buffer_free (buffer);
+		return DC_STATUS_NOMEMORY;
+	}
 
+	// Download the dive headers first. Only the headers of the new dives
+	// are needed, and once their number is known, the progress events
+	// can be based on the number of dives that actually need to be
+	// downloaded. The size of the dive data is only known once it has
+	// been read. If a header fails to download, the dives with a header
+	// are still downloaded, and the error is returned afterwards.
+	dc_status_t status = DC_STATUS_SUCCESS;
+	unsigned int count = 0;
+	offsets[0] = 0;
+	for (unsigned int i = 0; i < ndives; ++i) {
 		// Read the dive header.
-		rc = mares_iconhd_read_object (device, &progress, buffer, OBJ_DIVE + i, OBJ_DIVE_HEADER);
-		if (rc != DC_STATUS_SUCCESS) {
+		status = mares_iconhd_read_object (device, &progress, headers, OBJ_DIVE + i, OBJ_DIVE_HEADER);
+		if (status != DC_STATUS_SUCCESS) {
 			ERROR (abstract->context, "Failed to read the dive header.");
 			break;
 		}
 
+		const unsigned char *header = dc_buffer_get_data (headers) + offsets[count];
+		unsigned int size = dc_buffer_get_size (headers) - offsets[count];
+		if (size < 0x08 + device->fingerprint_size) {
+			ERROR (abstract->context, "Unexpected number of bytes received (%u).", size);
+			status = DC_STATUS_PROTOCOL;
+			break;
+		}
+
 		// Check the fingerprint data.
-		if (memcmp (dc_buffer_get_data (buffer) + 0x08, device->fingerprint, device->fingerprint_size) == 0) {
+		if (memcmp (header + 0x08, device->fingerprint, device->fingerprint_size) == 0) {
 			INFO (abstract->context, "Stopping due to detecting a matching fingerprint");
 			break;
 		}
 
+		offsets[++count] = dc_buffer_get_size (headers);
+	}
+
+	// Update and emit a progress event.
+	progress.maximum = progress.current + count * NSTEPS;
+	device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
+
+	// Download the dives.
+	for (unsigned int i = 0; rc == DC_STATUS_SUCCESS && i < count; ++i) {
+		// Erase the buffer.
+		dc_buffer_clear (buffer);
+
+		// Copy the dive header.
+		if (!dc_buffer_append (buffer, dc_buffer_get_data (headers) + offsets[i], offsets[i + 1] - offsets[i])) {
+			ERROR (abstract->context, "Insufficient buffer space available.");
+			rc = DC_STATUS_NOMEMORY;
+			break;
+		}
+
 		// Read the dive data.
 		rc = mares_iconhd_read_object (device, &progress, buffer, OBJ_DIVE + i, OBJ_DIVE_DATA);
 		if (rc != DC_STATUS_SUCCESS) {
@@ -1134,7 +1177,12 @@ mares_iconhd_device_foreach_object (dc_device_t *abstract, dc_dive_callback_t ca
 		}
 	}
 
-	dc_buffer_free(buffer);
+	free (offsets);
+	dc_buffer_free (headers);
+	dc_buffer_free (buffer);
+
+	if (rc == DC_STATUS_SUCCESS)
+		rc = status;
 
 	return rc;
 }
@@ -72,6 +72,7 @@ static const dc_parser_vtable_t mares_nemo_parser_vtable = {
 	mares_nemo_parser_get_datetime, /* datetime */
 	mares_nemo_parser_get_field, /* fields */
 	mares_nemo_parser_samples_foreach, /* samples_foreach */
+	NULL, /* summary */
 	NULL /* destroy */
 };
 
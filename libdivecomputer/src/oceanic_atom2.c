@@ -40,6 +40,8 @@
 #define MAXDELAY   16
 #define INVALID    0xFFFFFFFF
 
+#define NPAGES     8
+
 #define CMD_INIT      0xA8
 #define CMD_VERSION   0x84
 #define CMD_HANDSHAKE 0xE5
@@ -56,23 +58,29 @@
 
 #define REPEAT 50
 
+typedef struct oceanic_atom2_page_t {
+	unsigned char data[256];
+	unsigned int page;
+	unsigned int highmem;
+	unsigned int stamp;
+} oceanic_atom2_page_t;
+
 typedef struct oceanic_atom2_device_t {
 	oceanic_common_device_t base;
 	dc_iostream_t *iostream;
 	unsigned int handshake_repeat;
 	unsigned int handshake_counter;
 	unsigned int sequence;
-	unsigned int delay;
 	unsigned int extra;
 	unsigned int bigpage;
-	unsigned char cache[256];
-	unsigned int cached_page;
-	unsigned int cached_highmem;
+	oceanic_atom2_page_t cache[NPAGES];
+	unsigned int stamp;
 } oceanic_atom2_device_t;
 
 static dc_status_t oceanic_atom2_device_read (dc_device_t *abstract, unsigned int address, unsigned char data[], unsigned int size);
 static dc_status_t oceanic_atom2_device_write (dc_device_t *abstract, unsigned int address, const unsigned char data[], unsigned int size);
 static dc_status_t oceanic_atom2_device_close (dc_device_t *abstract);
+static void oceanic_atom2_cache_invalidate (oceanic_atom2_device_t *device);
 
 static const oceanic_common_device_vtable_t oceanic_atom2_device_vtable = {
 	{
@@ -676,9 +684,7 @@ oceanic_atom2_packet (oceanic_atom2_device_t *device, const unsigned char comman
 	if (device_is_cancelled (abstract))
 		return DC_STATUS_CANCELLED;
 
-	if (device->delay) {
-		dc_iostream_sleep (device->iostream, device->delay);
-	}
+	device_pacing_wait (abstract, device->iostream);
 
 	// Send the command to the dive computer.
 	if (transport == DC_TRANSPORT_BLE) {
@@ -756,6 +762,8 @@ oceanic_atom2_packet (oceanic_atom2_device_t *device, const unsigned char comman
 
 	device->sequence++;
 
+	device_pacing_success (abstract);
+
 	return DC_STATUS_SUCCESS;
 }
 
@@ -780,8 +788,7 @@ oceanic_atom2_transfer (oceanic_atom2_device_t *device, const unsigned char comm
 			return rc;
 
 		// Increase the inter packet delay.
-		if (device->delay < MAXDELAY)
-			device->delay++;
+		device_pacing_failure ((dc_device_t *) device);
 
 		// Delay the next attempt.
 		dc_iostream_sleep (device->iostream, 100);
@@ -878,13 +885,12 @@ oceanic_atom2_device_open (dc_device_t **out, dc_context_t *context, dc_iostream
 
 	// Set the default values.
 	device->iostream = iostream;
-	device->delay = 0;
+	device_pacing_init ((dc_device_t *) device, iostream, 0, MAXDELAY);
 	device->extra = model == PROPLUSX || model == I770R;
 	device->sequence = 0;
 	device->bigpage = 1; // no big pages
-	device->cached_page = INVALID;
-	device->cached_highmem = INVALID;
 	memset(device->cache, 0, sizeof(device->cache));
+	oceanic_atom2_cache_invalidate (device);
 
 	// Get the correct baudrate.
 	unsigned int baudrate = 38400;
@@ -1059,6 +1065,57 @@ oceanic_atom2_device_version (dc_device_t *abstract, unsigned char data[], unsig
 }
 
 
+/*
+ * The logbook and profile ringbuffers are downloaded in an interleaved
+ * way, and the same pages are often requested again shortly afterwards
+ * (e.g. the page on the boundary between two dives). Therefore the most
+ * recently used pages are kept in a small cache, instead of only the
+ * last one.
+ */
+static void
+oceanic_atom2_cache_invalidate (oceanic_atom2_device_t *device)
+{
+	for (unsigned int i = 0; i < NPAGES; ++i) {
+		device->cache[i].page = INVALID;
+		device->cache[i].highmem = INVALID;
+		device->cache[i].stamp = 0;
+	}
+
+	device->stamp = 0;
+}
+
+static oceanic_atom2_page_t *
+oceanic_atom2_cache_lookup (oceanic_atom2_device_t *device, unsigned int page, unsigned int highmem)
+{
+	for (unsigned int i = 0; i < NPAGES; ++i) {
+		oceanic_atom2_page_t *cache = device->cache + i;
+		if (cache->page == page && cache->highmem == highmem) {
+			cache->stamp = ++device->stamp;
+			return cache;
+		}
+	}
+
+	return NULL;
+}
+
+static oceanic_atom2_page_t *
+oceanic_atom2_cache_evict (oceanic_atom2_device_t *device)
+{
+	// Pick the least recently used page.
+	oceanic_atom2_page_t *cache = device->cache;
+	for (unsigned int i = 1; i < NPAGES; ++i) {
+		if (device->cache[i].stamp < cache->stamp)
+			cache = device->cache + i;
+	}
+
+	// Invalidate the page until it has been read successfully.
+	cache->page = INVALID;
+	cache->highmem = INVALID;
+	cache->stamp = ++device->stamp;
+
+	return cache;
+}
+
 static dc_status_t
 oceanic_atom2_device_read (dc_device_t *abstract, unsigned int address, unsigned char data[], unsigned int size)
 {
@@ -1109,7 +1166,8 @@ oceanic_atom2_device_read (dc_device_t *abstract, unsigned int address, unsigned
 		// addresses back to their physical address.
 		unsigned int page = (address - highmem) / pagesize;
 
-		if (page != device->cached_page || highmem != device->cached_highmem) {
+		oceanic_atom2_page_t *cache = oceanic_atom2_cache_lookup (device, page, highmem);
+		if (cache == NULL) {
 			if (device->handshake_repeat && ++device->handshake_counter % REPEAT == 0) {
 				unsigned char version[PAGESIZE] = {0};
 				oceanic_atom2_device_version (abstract, version, sizeof (version));
@@ -1122,13 +1180,14 @@ oceanic_atom2_device_read (dc_device_t *abstract, unsigned int address, unsigned
 					(number >> 8) & 0xFF, // high
 					(number     ) & 0xFF, // low
 				};
-			dc_status_t rc = oceanic_atom2_transfer (device, command, sizeof (command), ACK, device->cache, pagesize, crc_size);
+			cache = oceanic_atom2_cache_evict (device);
+			dc_status_t rc = oceanic_atom2_transfer (device, command, sizeof (command), ACK, cache->data, pagesize, crc_size);
 			if (rc != DC_STATUS_SUCCESS)
 				return rc;
 
 			// Cache the page.
-			device->cached_page = page;
-			device->cached_highmem = highmem;
+			cache->page = page;
+			cache->highmem = highmem;
 		}
 
 		unsigned int offset = address % pagesize;
@@ -1136,7 +1195,7 @@ oceanic_atom2_device_read (dc_device_t *abstract, unsigned int address, unsigned
 		if (nbytes + length > size)
 			length = size - nbytes;
 
-		memcpy (data, device->cache + offset, length);
+		memcpy (data, cache->data + offset, length);
 
 		nbytes += length;
 		address += length;
@@ -1157,8 +1216,7 @@ oceanic_atom2_device_write (dc_device_t *abstract, unsigned int address, const u
 		return DC_STATUS_INVALIDARGS;
 
 	// Invalidate the cache.
-	device->cached_page = INVALID;
-	device->cached_highmem = INVALID;
+	oceanic_atom2_cache_invalidate (device);
 
 	unsigned int nbytes = 0;
 	while (nbytes < size) {
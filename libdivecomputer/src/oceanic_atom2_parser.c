@@ -46,11 +46,80 @@
 #define HEADER  1
 #define PROFILE 2
 
+typedef enum oceanic_atom2_tankswitch_t {
+	TANKSWITCH_MASK,     // 1 psi, single tank
+	TANKSWITCH_1PSI,     // 1 psi, one based tank index
+	TANKSWITCH_2PSI,     // 2 psi, one based tank index
+} oceanic_atom2_tankswitch_t;
+
+typedef enum oceanic_atom2_temperature_t {
+	TEMPERATURE_BYTE,    // Absolute value in a single byte
+	TEMPERATURE_BITS,    // Absolute value scattered over several bytes
+	TEMPERATURE_UINT16,  // Absolute value in 0.1 °F
+	TEMPERATURE_DELTA,   // Signed change relative to the previous sample
+} oceanic_atom2_temperature_t;
+
+typedef enum oceanic_atom2_pressure_t {
+	PRESSURE_NONE,
+	PRESSURE_UINT12,     // Absolute value in a 12 bit field
+	PRESSURE_5PSI,       // Absolute value in a 10 bit field, 5 psi units
+	PRESSURE_UINT16,     // Absolute value in a 16 bit field
+	PRESSURE_TANK,       // Absolute value, with the tank index in the sample
+	PRESSURE_DELTA,      // Pressure drop relative to the previous sample
+} oceanic_atom2_pressure_t;
+
+typedef enum oceanic_atom2_depth_t {
+	DEPTH_UINT12,
+	DEPTH_UINT16,
+	DEPTH_BYTE,
+} oceanic_atom2_depth_t;
+
+typedef enum oceanic_atom2_deco_t {
+	DECO_NONE,
+	DECO_PACKED,         // Stop depth and time packed in bit fields
+	DECO_NDL,            // Stop depth, with separate deco and NDL times
+} oceanic_atom2_deco_t;
+
+/*
+ * Sample layout of a model, resolved once when the parser is created
+ * so the sample loop does not need to compare the model number.
+ */
+typedef struct oceanic_atom2_parser_layout_t {
+	unsigned int samplesize;
+	unsigned int freedive_samplesize;
+	unsigned int decimal; // Depth and temperature in 1/10 instead of 1/16 units
+	unsigned int timestamp;
+	oceanic_atom2_tankswitch_t tankswitch;
+	unsigned int tankswitch_offset;
+	oceanic_atom2_temperature_t temperature;
+	unsigned int temperature_offset;
+	unsigned int sign_offset;
+	unsigned int sign_mask;
+	unsigned int sign_invert;
+	oceanic_atom2_pressure_t pressure;
+	unsigned int pressure_initial;
+	oceanic_atom2_depth_t depth;
+	unsigned int depth_offset;
+	unsigned int gasmix_mask;
+	unsigned int gasmix_shift;
+	oceanic_atom2_deco_t deco;
+	unsigned int decostop_offset;
+	unsigned int decostop_mask;
+	unsigned int decostop_shift;
+	unsigned int decotime_offset;
+	unsigned int decotime_mask;
+	unsigned int rbt_offset;
+	unsigned int rbt_mask;
+	unsigned int ppo2;
+	unsigned int bookmark;
+} oceanic_atom2_parser_layout_t;
+
 typedef struct oceanic_atom2_parser_t oceanic_atom2_parser_t;
 
 struct oceanic_atom2_parser_t {
 	dc_parser_t base;
 	unsigned int model;
+	oceanic_atom2_parser_layout_t layout;
 	unsigned int logbooksize;
 	unsigned int headersize;
 	unsigned int footersize;
@@ -69,6 +138,7 @@ struct oceanic_atom2_parser_t {
 static dc_status_t oceanic_atom2_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t oceanic_atom2_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t oceanic_atom2_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
+static dc_status_t oceanic_atom2_parser_summary (dc_parser_t *abstract, dc_summary_t *summary);
 
 static const dc_parser_vtable_t oceanic_atom2_parser_vtable = {
 	sizeof(oceanic_atom2_parser_t),
@@ -79,6 +149,7 @@ static const dc_parser_vtable_t oceanic_atom2_parser_vtable = {
 	oceanic_atom2_parser_get_datetime, /* datetime */
 	oceanic_atom2_parser_get_field, /* fields */
 	oceanic_atom2_parser_samples_foreach, /* samples_foreach */
+	oceanic_atom2_parser_summary, /* summary */
 	NULL /* destroy */
 };
 
@@ -88,6 +159,275 @@ is_freedive (unsigned int divemode, unsigned int model)
 	return divemode == FREEDIVE && model != DSX;
 }
 
+static void
+oceanic_atom2_parser_layout (oceanic_atom2_parser_layout_t *layout, unsigned int model)
+{
+	// Sample size.
+	if (model == F10A || model == F10B ||
+		model == F11A || model == F11B ||
+		model == MUNDIAL2 || model == MUNDIAL3) {
+		layout->freedive_samplesize = 2;
+	} else {
+		layout->freedive_samplesize = 4;
+	}
+	if (model == OC1A || model == OC1B ||
+		model == OC1C || model == OCI ||
+		model == TX1 || model == A300CS ||
+		model == VTX || model == I450T ||
+		model == I750TC || model == PROPLUSX ||
+		model == I770R || model == I470TC ||
+		model == SAGE || model == BEACON ||
+		model == GEOAIR || model == I330R ||
+		model == I330R_C) {
+		layout->samplesize = PAGESIZE;
+	} else if (model == DSX) {
+		layout->samplesize = 32;
+	} else {
+		layout->samplesize = PAGESIZE / 2;
+	}
+
+	layout->decimal = (model == I330R || model == I330R_C || model == DSX);
+	layout->timestamp = (model == I450T || model == I470TC);
+
+	// Tank switch (big endian pressure).
+	layout->tankswitch_offset = 4;
+	if (model == DATAMASK || model == COMPUMASK) {
+		layout->tankswitch = TANKSWITCH_MASK;
+	} else if (model == A300CS || model == VTX ||
+		model == I750TC || model == SAGE ||
+		model == BEACON) {
+		layout->tankswitch = TANKSWITCH_1PSI;
+	} else {
+		layout->tankswitch = TANKSWITCH_2PSI;
+		if (model == ATOM2 || model == EPICA || model == EPICB)
+			layout->tankswitch_offset = 3;
+	}
+
+	// Temperature (°F).
+	layout->temperature_offset = 0;
+	layout->sign_offset = 0;
+	layout->sign_mask = 0;
+	layout->sign_invert = 0;
+	if (model == GEO || model == ATOM1 ||
+		model == ELEMENT2 || model == MANTA ||
+		model == ZEN) {
+		layout->temperature = TEMPERATURE_BYTE;
+		layout->temperature_offset = 6;
+	} else if (model == TALIS) {
+		layout->temperature = TEMPERATURE_BYTE;
+		layout->temperature_offset = 7;
+	} else if (model == GEO20 || model == VEO20 ||
+		model == VEO30 || model == OC1A ||
+		model == OC1B || model == OC1C ||
+		model == OCI || model == A300 ||
+		model == I450T || model == I300 ||
+		model == I200 || model == I100 ||
+		model == I300C || model == I200C ||
+		model == GEO40 || model == VEO40 ||
+		model == I470TC || model == I200CV2 ||
+		model == GEOAIR || model == I100V2) {
+		layout->temperature = TEMPERATURE_BYTE;
+		layout->temperature_offset = 3;
+	} else if (model == OCS || model == TX1) {
+		layout->temperature = TEMPERATURE_BYTE;
+		layout->temperature_offset = 1;
+	} else if (model == VT4 || model == VT41 ||
+		model == ATOM3 || model == ATOM31 ||
+		model == A300AI || model == VISION ||
+		model == XPAIR) {
+		layout->temperature = TEMPERATURE_BITS;
+	} else if (model == A300CS || model == VTX ||
+		model == I750TC || model == PROPLUSX ||
+		model == I770R|| model == SAGE ||
+		model == BEACON) {
+		layout->temperature = TEMPERATURE_BYTE;
+		layout->temperature_offset = 11;
+	} else if (model == I330R || model == I330R_C || model == DSX) {
+		layout->temperature = TEMPERATURE_UINT16;
+		layout->temperature_offset = 10;
+	} else {
+		layout->temperature = TEMPERATURE_DELTA;
+		if (model == DG03 || model == PROPLUS3 ||
+			model == I550 || model == I550C ||
+			model == PROPLUS4 || model == WISDOM4) {
+			layout->sign_offset = 5;
+			layout->sign_mask = 0x04;
+			layout->sign_invert = 0xFF;
+		} else if (model == VOYAGER2G || model == AMPHOS ||
+			model == AMPHOSAIR || model == ZENAIR ||
+			model == AMPHOS2 || model == AMPHOSAIR2) {
+			layout->sign_offset = 5;
+			layout->sign_mask = 0x04;
+		} else if (model == ATOM2 || model == PROPLUS21 ||
+			model == EPICA || model == EPICB ||
+			model == ATMOSAI2 ||
+			model == WISDOM2 || model == WISDOM3) {
+			layout->sign_offset = 0;
+			layout->sign_mask = 0x80;
+		} else {
+			layout->sign_offset = 0;
+			layout->sign_mask = 0x80;
+			layout->sign_invert = 0xFF;
+		}
+	}
+
+	// Tank pressure (psi).
+	layout->pressure_initial = 2;
+	if (model == A300CS || model == VTX ||
+		model == I750TC)
+		layout->pressure_initial = 16;
+	if (model == VEO30 || model == OCS ||
+		model == ELEMENT2 || model == VEO20 ||
+		model == A300 || model == ZEN ||
+		model == GEO || model == GEO20 ||
+		model == MANTA || model == I300 ||
+		model == I200 || model == I100 ||
+		model == I300C || model == TALIS ||
+		model == I200C || model == I200CV2 ||
+		model == GEO40 || model == VEO40 ||
+		model == I330R || model == I330R_C ||
+		model == I100V2) {
+		layout->pressure = PRESSURE_NONE;
+	} else if (model == OC1A || model == OC1B ||
+		model == OC1C || model == OCI ||
+		model == I450T || model == I470TC ||
+		model == GEOAIR) {
+		layout->pressure = PRESSURE_UINT12;
+	} else if (model == VT4 || model == VT41||
+		model == ATOM3 || model == ATOM31 ||
+		model == ZENAIR ||model == A300AI ||
+		model == DG03 || model == PROPLUS3 ||
+		model == AMPHOSAIR || model == I550 ||
+		model == VISION || model == XPAIR ||
+		model == I550C || model == PROPLUS4 ||
+		model == WISDOM4 || model == AMPHOSAIR2) {
+		layout->pressure = PRESSURE_5PSI;
+	} else if (model == TX1 || model == A300CS ||
+		model == VTX || model == I750TC ||
+		model == PROPLUSX || model == I770R ||
+		model == SAGE || model == BEACON) {
+		layout->pressure = PRESSURE_UINT16;
+	} else if (model == DSX) {
+		layout->pressure = PRESSURE_TANK;
+	} else {
+		layout->pressure = PRESSURE_DELTA;
+	}
+
+	// Depth (1/16 ft).
+	if (model == GEO20 || model == VEO20 ||
+		model == VEO30 || model == OC1A ||
+		model == OC1B || model == OC1C ||
+		model == OCI || model == A300 ||
+		model == I450T || model == I300 ||
+		model == I200 || model == I100 ||
+		model == I300C || model == I200C ||
+		model == GEO40 || model == VEO40 ||
+		model == I470TC || model == I200CV2 ||
+		model == GEOAIR || model == I100V2) {
+		layout->depth = DEPTH_UINT12;
+		layout->depth_offset = 4;
+	} else if (model == I330R || model == I330R_C || model == DSX) {
+		layout->depth = DEPTH_UINT16;
+		layout->depth_offset = 2;
+	} else if (model == ATOM1) {
+		layout->depth = DEPTH_BYTE;
+		layout->depth_offset = 3;
+	} else {
+		layout->depth = DEPTH_UINT12;
+		layout->depth_offset = 2;
+	}
+
+	// Gas mix.
+	layout->gasmix_mask = 0;
+	layout->gasmix_shift = 0;
+	if (model == TX1) {
+		layout->gasmix_mask = 0x07;
+	} else if (model == DSX) {
+		layout->gasmix_mask = 0xF0;
+		layout->gasmix_shift = 4;
+	}
+
+	// NDL / Deco.
+	layout->deco = DECO_PACKED;
+	layout->decostop_mask = 0xF0;
+	layout->decostop_shift = 4;
+	if (model == A300CS || model == VTX ||
+		model == I750TC || model == SAGE ||
+		model == PROPLUSX || model == I770R ||
+		model == BEACON) {
+		layout->decostop_offset = 15;
+		layout->decostop_mask = 0x70;
+		layout->decotime_offset = 6;
+		layout->decotime_mask = 0x03FF;
+	} else if (model == ZEN || model == DG03) {
+		layout->decostop_offset = 5;
+		layout->decotime_offset = 4;
+		layout->decotime_mask = 0x0FFF;
+	} else if (model == TX1) {
+		layout->decostop_offset = 10;
+		layout->decostop_mask = 0xFF;
+		layout->decostop_shift = 0;
+		layout->decotime_offset = 6;
+		layout->decotime_mask = 0xFFFF;
+	} else if (model == ATOM31 || model == VISION ||
+		model == XPAIR || model == I550 ||
+		model == I550C || model == WISDOM4 ||
+		model == PROPLUS4 || model == ATMOSAI2) {
+		layout->decostop_offset = 5;
+		layout->decotime_offset = 4;
+		layout->decotime_mask = 0x03FF;
+	} else if (model == I200 || model == I300 ||
+		model == OC1A || model == OC1B ||
+		model == OC1C || model == OCI ||
+		model == I100 || model == I300C ||
+		model == I450T || model == I200C ||
+		model == GEO40 || model == VEO40 ||
+		model == I470TC || model == I200CV2 ||
+		model == GEOAIR || model == I100V2) {
+		layout->decostop_offset = 7;
+		layout->decotime_offset = 6;
+		layout->decotime_mask = 0x0FFF;
+	} else if (model == I330R || model == I330R_C || model == DSX) {
+		layout->deco = DECO_NDL;
+		layout->decostop_offset = 8;
+		layout->decostop_mask = 0xFF;
+		layout->decostop_shift = 0;
+		layout->decotime_offset = 6;
+		layout->decotime_mask = 0xFFFF;
+	} else {
+		layout->deco = DECO_NONE;
+		layout->decostop_offset = 0;
+		layout->decotime_offset = 0;
+		layout->decotime_mask = 0;
+	}
+
+	// Remaining bottom time.
+	layout->rbt_offset = 0;
+	layout->rbt_mask = 0;
+	if (model == ATOM31) {
+		layout->rbt_offset = 6;
+		layout->rbt_mask = 0x01FF;
+	} else if (model == I450T || model == OC1A ||
+		model == OC1B || model == OC1C ||
+		model == OCI || model == PROPLUSX ||
+		model == I770R || model == I470TC ||
+		model == GEOAIR) {
+		layout->rbt_offset = 8;
+		layout->rbt_mask = 0x01FF;
+	} else if (model == VISION || model == XPAIR ||
+		model == I550 || model == I550C ||
+		model == WISDOM4 || model == PROPLUS4 ||
+		model == ATMOSAI2) {
+		layout->rbt_offset = 6;
+		layout->rbt_mask = 0x03FF;
+	}
+
+	layout->ppo2 = (model == I330R || model == I330R_C);
+	layout->bookmark = (model == OC1A || model == OC1B ||
+		model == OC1C || model == OCI ||
+		model == GEOAIR);
+}
+
 dc_status_t
 oceanic_atom2_parser_create (dc_parser_t **out, dc_context_t *context, const unsigned char data[], size_t size, unsigned int model)
 {
@@ -105,6 +445,7 @@ oceanic_atom2_parser_create (dc_parser_t **out, dc_context_t *context, const uns
 
 	// Set the default values.
 	parser->model = model;
+	oceanic_atom2_parser_layout (&parser->layout, model);
 	parser->logbooksize = 0;
 	parser->headersize = 9 * PAGESIZE / 2;
 	parser->footersize = 2 * PAGESIZE / 2;
@@ -497,6 +838,15 @@ oceanic_atom2_parser_cache (oceanic_atom2_parser_t *parser)
 }
 
 
+static unsigned int
+oceanic_atom2_parser_header_divetime (oceanic_atom2_parser_t *parser)
+{
+	return parser->model == F10A || parser->model == F10B ||
+		parser->model == F11A || parser->model == F11B ||
+		parser->model == MUNDIAL2 || parser->model == MUNDIAL3;
+}
+
+
 static dc_status_t
 oceanic_atom2_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value)
 {
@@ -509,8 +859,10 @@ oceanic_atom2_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, uns
 	if (status != DC_STATUS_SUCCESS)
 		return status;
 
-	// Cache the profile data.
-	if (parser->cached < PROFILE) {
+	// Cache the profile data. Only the dive time of some models is
+	// not stored in the header.
+	if (type == DC_FIELD_DIVETIME && !oceanic_atom2_parser_header_divetime (parser) &&
+		parser->cached < PROFILE) {
 		sample_statistics_t statistics = SAMPLE_STATISTICS_INITIALIZER;
 		status = oceanic_atom2_parser_samples_foreach (
 			abstract, sample_statistics_cb, &statistics);
@@ -528,9 +880,7 @@ oceanic_atom2_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, uns
 	if (value) {
 		switch (type) {
 		case DC_FIELD_DIVETIME:
-			if (parser->model == F10A || parser->model == F10B ||
-				parser->model == F11A || parser->model == F11B ||
-				parser->model == MUNDIAL2 || parser->model == MUNDIAL3)
+			if (oceanic_atom2_parser_header_divetime (parser))
 				*((unsigned int *) value) = bcd2dec (data[2]) + bcd2dec (data[3]) * 60;
 			else
 				*((unsigned int *) value) = parser->divetime;
@@ -659,6 +1009,24 @@ oceanic_atom2_parser_vendor (oceanic_atom2_parser_t *parser, const unsigned char
 	}
 }
 
+static dc_status_t
+oceanic_atom2_parser_summary (dc_parser_t *abstract, dc_summary_t *summary)
+{
+	oceanic_atom2_parser_t *parser = (oceanic_atom2_parser_t *) abstract;
+
+	// Cache the header data.
+	dc_status_t status = oceanic_atom2_parser_cache (parser);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	unsigned int fields = ~0u;
+	if (!oceanic_atom2_parser_header_divetime (parser))
+		fields &= ~DC_FIELD_MASK (DC_FIELD_DIVETIME);
+
+	return dc_parser_summary_fill (abstract, summary, fields);
+}
+
+
 static dc_status_t
 oceanic_atom2_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata)
 {
@@ -696,44 +1064,19 @@ oceanic_atom2_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_
 		interval = intervals[idx];
 	}
 
-	unsigned int samplesize = PAGESIZE / 2;
-	if (is_freedive (parser->mode, parser->model)) {
-		if (parser->model == F10A || parser->model == F10B ||
-			parser->model == F11A || parser->model == F11B ||
-			parser->model == MUNDIAL2 || parser->model == MUNDIAL3) {
-			samplesize = 2;
-		} else {
-			samplesize = 4;
-		}
-	} else if (parser->model == OC1A || parser->model == OC1B ||
-		parser->model == OC1C || parser->model == OCI ||
-		parser->model == TX1 || parser->model == A300CS ||
-		parser->model == VTX || parser->model == I450T ||
-		parser->model == I750TC || parser->model == PROPLUSX ||
-		parser->model == I770R || parser->model == I470TC ||
-		parser->model == SAGE || parser->model == BEACON ||
-		parser->model == GEOAIR || parser->model == I330R ||
-		parser->model == I330R_C) {
-		samplesize = PAGESIZE;
-	} else if (parser->model == DSX) {
-		samplesize = 32;
+	const oceanic_atom2_parser_layout_t *layout = &parser->layout;
+	unsigned int freedive = is_freedive (parser->mode, parser->model);
+
+	unsigned int samplesize = layout->samplesize;
+	if (freedive) {
+		samplesize = layout->freedive_samplesize;
 	}
 
 	unsigned int have_temperature = 1, have_pressure = 1;
-	if (is_freedive (parser->mode, parser->model)) {
+	if (freedive) {
 		have_temperature = 0;
 		have_pressure = 0;
-	} else if (parser->model == VEO30 || parser->model == OCS ||
-		parser->model == ELEMENT2 || parser->model == VEO20 ||
-		parser->model == A300 || parser->model == ZEN ||
-		parser->model == GEO || parser->model == GEO20 ||
-		parser->model == MANTA || parser->model == I300 ||
-		parser->model == I200 || parser->model == I100 ||
-		parser->model == I300C || parser->model == TALIS ||
-		parser->model == I200C || parser->model == I200CV2 ||
-		parser->model == GEO40 || parser->model == VEO40 ||
-		parser->model == I330R || parser->model == I330R_C ||
-		parser->model == I100V2) {
+	} else if (layout->pressure == PRESSURE_NONE) {
 		have_pressure = 0;
 	}
 
@@ -747,11 +1090,7 @@ oceanic_atom2_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_
 	unsigned int tank = 1;
 	unsigned int pressure = 0;
 	if (have_pressure) {
-		unsigned int idx = 2;
-		if (parser->model == A300CS || parser->model == VTX ||
-			parser->model == I750TC)
-			idx = 16;
-		pressure = array_uint16_le(data + parser->header + idx);
+		pressure = array_uint16_le(data + parser->header + layout->pressure_initial);
 		if (pressure == 10000)
 			have_pressure = 0;
 	}
@@ -767,7 +1106,7 @@ oceanic_atom2_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_
 		dc_sample_value_t sample = {0};
 
 		// Ignore empty samples.
-		if ((!is_freedive (parser->mode, parser->model) &&
+		if ((!freedive &&
 			array_isequal (data + offset, samplesize, 0x00)) ||
 			array_isequal (data + offset, samplesize, 0xFF)) {
 			offset += samplesize;
@@ -781,7 +1120,7 @@ oceanic_atom2_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_
 
 		// Get the sample type.
 		unsigned int sampletype = data[offset + 0];
-		if (is_freedive (parser->mode, parser->model))
+		if (freedive)
 			sampletype = 0;
 
 		// The sample size is usually fixed, but some sample types have a
@@ -797,23 +1136,22 @@ oceanic_atom2_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_
 
 		// Check for a tank switch sample.
 		if (sampletype == 0xAA) {
-			if (parser->model == DATAMASK || parser->model == COMPUMASK) {
+			switch (layout->tankswitch) {
+			case TANKSWITCH_MASK:
 				// Tank pressure (1 psi) and number
 				tank = 1;
 				pressure = (((data[offset + 7] << 8) + data[offset + 6]) & 0x0FFF);
-			} else if (parser->model == A300CS || parser->model == VTX ||
-				parser->model == I750TC || parser->model == SAGE ||
-				parser->model == BEACON) {
+				break;
+			case TANKSWITCH_1PSI:
 				// Tank pressure (1 psi) and number (one based index)
 				tank = data[offset + 1] & 0x03;
 				pressure = ((data[offset + 7] << 8) + data[offset + 6]) & 0x0FFF;
-			} else {
+				break;
+			case TANKSWITCH_2PSI:
 				// Tank pressure (2 psi) and number (one based index)
 				tank = data[offset + 1] & 0x03;
-				if (parser->model == ATOM2 || parser->model == EPICA || parser->model == EPICB)
-					pressure = (((data[offset + 3] << 8) + data[offset + 4]) & 0x0FFF) * 2;
-				else
-					pressure = (((data[offset + 4] << 8) + data[offset + 5]) & 0x0FFF) * 2;
+				pressure = (array_uint16_be (data + offset + layout->tankswitch_offset) & 0x0FFF) * 2;
+				break;
 			}
 		} else if (sampletype == 0xBB) {
 			// The surface time is not always a nice multiple of the samplerate.
@@ -845,7 +1183,7 @@ oceanic_atom2_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_
 			extratime += surftime;
 		} else {
 			// Time.
-			if (parser->model == I450T || parser->model == I470TC) {
+			if (layout->timestamp) {
 				unsigned int minute = bcd2dec(data[offset + 0]);
 				unsigned int hour   = bcd2dec(data[offset + 1] & 0x0F);
 				unsigned int second = bcd2dec(data[offset + 2]);
@@ -873,60 +1211,24 @@ oceanic_atom2_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_
 
 			// Temperature (°F)
 			if (have_temperature) {
-				if (parser->model == GEO || parser->model == ATOM1 ||
-					parser->model == ELEMENT2 || parser->model == MANTA ||
-					parser->model == ZEN) {
-					temperature = data[offset + 6];
-				} else if (parser->model == TALIS) {
-					temperature = data[offset + 7];
-				} else if (parser->model == GEO20 || parser->model == VEO20 ||
-					parser->model == VEO30 || parser->model == OC1A ||
-					parser->model == OC1B || parser->model == OC1C ||
-					parser->model == OCI || parser->model == A300 ||
-					parser->model == I450T || parser->model == I300 ||
-					parser->model == I200 || parser->model == I100 ||
-					parser->model == I300C || parser->model == I200C ||
-					parser->model == GEO40 || parser->model == VEO40 ||
-					parser->model == I470TC || parser->model == I200CV2 ||
-					parser->model == GEOAIR || parser->model == I100V2) {
-					temperature = data[offset + 3];
-				} else if (parser->model == OCS || parser->model == TX1) {
-					temperature = data[offset + 1];
-				} else if (parser->model == VT4 || parser->model == VT41 ||
-					parser->model == ATOM3 || parser->model == ATOM31 ||
-					parser->model == A300AI || parser->model == VISION ||
-					parser->model == XPAIR) {
+				switch (layout->temperature) {
+				case TEMPERATURE_BYTE:
+					temperature = data[offset + layout->temperature_offset];
+					break;
+				case TEMPERATURE_BITS:
 					temperature = ((data[offset + 7] & 0xF0) >> 4) | ((data[offset + 7] & 0x0C) << 2) | ((data[offset + 5] & 0x0C) << 4);
-				} else if (parser->model == A300CS || parser->model == VTX ||
-					parser->model == I750TC || parser->model == PROPLUSX ||
-					parser->model == I770R|| parser->model == SAGE ||
-					parser->model == BEACON) {
-					temperature = data[offset + 11];
-				} else if (parser->model == I330R || parser->model == I330R_C || parser->model == DSX) {
-					temperature = array_uint16_le(data + offset + 10);
-				} else {
-					unsigned int sign;
-					if (parser->model == DG03 || parser->model == PROPLUS3 ||
-						parser->model == I550 || parser->model == I550C ||
-						parser->model == PROPLUS4 || parser->model == WISDOM4)
-						sign = (~data[offset + 5] & 0x04) >> 2;
-					else if (parser->model == VOYAGER2G || parser->model == AMPHOS ||
-						parser->model == AMPHOSAIR || parser->model == ZENAIR ||
-						parser->model == AMPHOS2 || parser->model == AMPHOSAIR2)
-						sign = (data[offset + 5] & 0x04) >> 2;
-					else if (parser->model == ATOM2 || parser->model == PROPLUS21 ||
-						parser->model == EPICA || parser->model == EPICB ||
-						parser->model == ATMOSAI2 ||
-						parser->model == WISDOM2 || parser->model == WISDOM3)
-						sign = (data[offset + 0] & 0x80) >> 7;
-					else
-						sign = (~data[offset + 0] & 0x80) >> 7;
-					if (sign)
+					break;
+				case TEMPERATURE_UINT16:
+					temperature = array_uint16_le(data + offset + layout->temperature_offset);
+					break;
+				case TEMPERATURE_DELTA:
+					if ((data[offset + layout->sign_offset] ^ layout->sign_invert) & layout->sign_mask)
 						temperature -= (data[offset + 7] & 0x0C) >> 2;
 					else
 						temperature += (data[offset + 7] & 0x0C) >> 2;
+					break;
 				}
-				if (parser->model == I330R || parser->model == I330R_C || parser->model == DSX) {
+				if (layout->decimal) {
 					sample.temperature = ((temperature / 10.0) - 32.0) * (5.0 / 9.0);
 				} else {
 					sample.temperature = (temperature - 32.0) * (5.0 / 9.0);
@@ -936,30 +1238,23 @@ oceanic_atom2_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_
 
 			// Tank Pressure (psi)
 			if (have_pressure) {
-				if (parser->model == OC1A || parser->model == OC1B ||
-					parser->model == OC1C || parser->model == OCI ||
-					parser->model == I450T || parser->model == I470TC ||
-					parser->model == GEOAIR)
+				switch (layout->pressure) {
+				case PRESSURE_UINT12:
 					pressure = (data[offset + 10] + (data[offset + 11] << 8)) & 0x0FFF;
-				else if (parser->model == VT4 || parser->model == VT41||
-					parser->model == ATOM3 || parser->model == ATOM31 ||
-					parser->model == ZENAIR ||parser->model == A300AI ||
-					parser->model == DG03 || parser->model == PROPLUS3 ||
-					parser->model == AMPHOSAIR || parser->model == I550 ||
-					parser->model == VISION || parser->model == XPAIR ||
-					parser->model == I550C || parser->model == PROPLUS4 ||
-					parser->model == WISDOM4 || parser->model == AMPHOSAIR2)
+					break;
+				case PRESSURE_5PSI:
 					pressure = (((data[offset + 0] & 0x03) << 8) + data[offset + 1]) * 5;
-				else if (parser->model == TX1 || parser->model == A300CS ||
-					parser->model == VTX || parser->model == I750TC ||
-					parser->model == PROPLUSX || parser->model == I770R ||
-					parser->model == SAGE || parser->model == BEACON)
+					break;
+				case PRESSURE_UINT16:
 					pressure = array_uint16_le (data + offset + 4);
-				else if (parser->model == DSX) {
+					break;
+				case PRESSURE_TANK:
 					pressure = array_uint16_le (data + offset + 14);
 					tank = (data[offset] & 0xF0) >> 4;
-				} else {
+					break;
+				default:
 					pressure -= data[offset + 1];
+					break;
 				}
 				if (tank) {
 					sample.pressure.tank = tank - 1;
@@ -970,26 +1265,15 @@ oceanic_atom2_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_
 
 			// Depth (1/16 ft)
 			unsigned int depth;
-			if (is_freedive (parser->mode, parser->model))
+			if (freedive)
 				depth = array_uint16_le (data + offset);
-			else if (parser->model == GEO20 || parser->model == VEO20 ||
-				parser->model == VEO30 || parser->model == OC1A ||
-				parser->model == OC1B || parser->model == OC1C ||
-				parser->model == OCI || parser->model == A300 ||
-				parser->model == I450T || parser->model == I300 ||
-				parser->model == I200 || parser->model == I100 ||
-				parser->model == I300C || parser->model == I200C ||
-				parser->model == GEO40 || parser->model == VEO40 ||
-				parser->model == I470TC || parser->model == I200CV2 ||
-				parser->model == GEOAIR || parser->model == I100V2)
-				depth = (data[offset + 4] + (data[offset + 5] << 8)) & 0x0FFF;
-			else if (parser->model == I330R || parser->model == I330R_C || parser->model == DSX)
-				depth = array_uint16_le (data + offset + 2);
-			else if (parser->model == ATOM1)
-				depth = data[offset + 3] * 16;
+			else if (layout->depth == DEPTH_UINT16)
+				depth = array_uint16_le (data + offset + layout->depth_offset);
+			else if (layout->depth == DEPTH_BYTE)
+				depth = data[offset + layout->depth_offset] * 16;
 			else
-				depth = (data[offset + 2] + (data[offset + 3] << 8)) & 0x0FFF;
-			if (parser->model == I330R || parser->model == I330R_C || parser->model == DSX) {
+				depth = array_uint16_le (data + offset + layout->depth_offset) & 0x0FFF;
+			if (layout->decimal) {
 				sample.depth = depth / 10.0 * FEET;
 			} else {
 				sample.depth = depth / 16.0 * FEET;
@@ -997,76 +1281,32 @@ oceanic_atom2_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_
 			if (callback) callback (DC_SAMPLE_DEPTH, &sample, userdata);
 
 			// Gas mix
-			unsigned int have_gasmix = 0;
-			unsigned int gasmix = 0;
-			if (parser->model == TX1) {
-				gasmix = data[offset] & 0x07;
-				have_gasmix = 1;
-			} else if (parser->model == DSX) {
-				gasmix = (data[offset] & 0xF0) >> 4;
-				have_gasmix = 1;
-			}
-			if (have_gasmix && gasmix != gasmix_previous && parser->ngasmixes > 0) {
-				if (gasmix < 1 || gasmix > parser->ngasmixes) {
-					ERROR (abstract->context, "Invalid gas mix index (%u).", gasmix);
-					return DC_STATUS_DATAFORMAT;
+			if (layout->gasmix_mask) {
+				unsigned int gasmix = (data[offset] & layout->gasmix_mask) >> layout->gasmix_shift;
+				if (gasmix != gasmix_previous && parser->ngasmixes > 0) {
+					if (gasmix < 1 || gasmix > parser->ngasmixes) {
+						ERROR (abstract->context, "Invalid gas mix index (%u).", gasmix);
+						return DC_STATUS_DATAFORMAT;
+					}
+					sample.gasmix = gasmix - 1;
+					if (callback) callback (DC_SAMPLE_GASMIX, &sample, userdata);
+					gasmix_previous = gasmix;
 				}
-				sample.gasmix = gasmix - 1;
-				if (callback) callback (DC_SAMPLE_GASMIX, &sample, userdata);
-				gasmix_previous = gasmix;
 			}
 
 			// NDL / Deco
-			unsigned int have_deco = 0;
-			unsigned int decostop = 0, decotime = 0;
-			if (parser->model == A300CS || parser->model == VTX ||
-				parser->model == I750TC || parser->model == SAGE ||
-				parser->model == PROPLUSX || parser->model == I770R ||
-				parser->model == BEACON) {
-				decostop = (data[offset + 15] & 0x70) >> 4;
-				decotime = array_uint16_le(data + offset + 6) & 0x03FF;
-				have_deco = 1;
-			} else if (parser->model == ZEN || parser->model == DG03) {
-				decostop = (data[offset + 5] & 0xF0) >> 4;
-				decotime = array_uint16_le(data + offset + 4) & 0x0FFF;
-				have_deco = 1;
-			} else if (parser->model == TX1) {
-				decostop = data[offset + 10];
-				decotime = array_uint16_le(data + offset + 6);
-				have_deco = 1;
-			} else if (parser->model == ATOM31 || parser->model == VISION ||
-				parser->model == XPAIR || parser->model == I550 ||
-				parser->model == I550C || parser->model == WISDOM4 ||
-				parser->model == PROPLUS4 || parser->model == ATMOSAI2) {
-				decostop = (data[offset + 5] & 0xF0) >> 4;
-				decotime = array_uint16_le(data + offset + 4) & 0x03FF;
-				have_deco = 1;
-			} else if (parser->model == I200 || parser->model == I300 ||
-				parser->model == OC1A || parser->model == OC1B ||
-				parser->model == OC1C || parser->model == OCI ||
-				parser->model == I100 || parser->model == I300C ||
-				parser->model == I450T || parser->model == I200C ||
-				parser->model == GEO40 || parser->model == VEO40 ||
-				parser->model == I470TC || parser->model == I200CV2 ||
-				parser->model == GEOAIR || parser->model == I100V2) {
-				decostop = (data[offset + 7] & 0xF0) >> 4;
-				decotime = array_uint16_le(data + offset + 6) & 0x0FFF;
-				have_deco = 1;
-			} else if (parser->model == I330R || parser->model == I330R_C || parser->model == DSX) {
-				decostop = data[offset + 8];
-				if (decostop) {
-					// Deco time
-					decotime = array_uint16_le(data + offset + 6);
-				} else {
+			if (layout->deco != DECO_NONE) {
+				unsigned int decostop = (data[offset + layout->decostop_offset] & layout->decostop_mask) >> layout->decostop_shift;
+				unsigned int decotime = 0;
+				if (layout->deco == DECO_NDL && decostop == 0) {
 					// NDL
 					decotime = array_uint16_le(data + offset + 4);
+				} else {
+					decotime = array_uint16_le(data + offset + layout->decotime_offset) & layout->decotime_mask;
 				}
-				have_deco = 1;
-			}
-			if (have_deco) {
 				if (decostop) {
 					sample.deco.type = DC_DECO_DECOSTOP;
-					if (parser->model == I330R || parser->model == I330R_C || parser->model == DSX) {
+					if (layout->decimal) {
 						sample.deco.depth = decostop * FEET;
 					} else {
 						sample.deco.depth = decostop * 10 * FEET;
@@ -1080,45 +1320,21 @@ oceanic_atom2_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_
 				if (callback) callback (DC_SAMPLE_DECO, &sample, userdata);
 			}
 
-			unsigned int have_rbt = 0;
-			unsigned int rbt = 0;
-			if (parser->model == ATOM31) {
-				rbt = array_uint16_le(data + offset + 6) & 0x01FF;
-				have_rbt = 1;
-			} else if (parser->model == I450T || parser->model == OC1A ||
-				parser->model == OC1B || parser->model == OC1C ||
-				parser->model == OCI || parser->model == PROPLUSX ||
-				parser->model == I770R || parser->model == I470TC ||
-				parser->model == GEOAIR) {
-				rbt = array_uint16_le(data + offset + 8) & 0x01FF;
-				have_rbt = 1;
-			} else if (parser->model == VISION || parser->model == XPAIR ||
-				parser->model == I550 || parser->model == I550C ||
-				parser->model == WISDOM4 || parser->model == PROPLUS4 ||
-				parser->model == ATMOSAI2) {
-				rbt = array_uint16_le(data + offset + 6) & 0x03FF;
-				have_rbt = 1;
-			}
-			if (have_rbt) {
-				sample.rbt = rbt;
+			// Remaining bottom time
+			if (layout->rbt_mask) {
+				sample.rbt = array_uint16_le(data + offset + layout->rbt_offset) & layout->rbt_mask;
 				if (callback) callback (DC_SAMPLE_RBT, &sample, userdata);
 			}
 
 			// PPO2
-			if (parser->model == I330R || parser->model == I330R_C) {
+			if (layout->ppo2) {
 				sample.ppo2.sensor = DC_SENSOR_NONE;
 				sample.ppo2.value = data[offset + 9] / 100.0;
 				if (callback) callback (DC_SAMPLE_PPO2, &sample, userdata);
 			}
 
 			// Bookmarks
-			unsigned int have_bookmark = 0;
-			if (parser->model == OC1A || parser->model == OC1B ||
-				parser->model == OC1C || parser->model == OCI ||
-				parser->model == GEOAIR) {
-				have_bookmark = data[offset + 12] & 0x80;
-			}
-			if (have_bookmark) {
+			if (layout->bookmark && (data[offset + 12] & 0x80)) {
 				sample.event.type = SAMPLE_EVENT_BOOKMARK;
 				sample.event.time = 0;
 				sample.event.flags = 0;
@@ -45,6 +45,7 @@ struct oceanic_vtpro_parser_t {
 static dc_status_t oceanic_vtpro_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t oceanic_vtpro_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t oceanic_vtpro_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
+static dc_status_t oceanic_vtpro_parser_summary (dc_parser_t *abstract, dc_summary_t *summary);
 
 static const dc_parser_vtable_t oceanic_vtpro_parser_vtable = {
 	sizeof(oceanic_vtpro_parser_t),
@@ -55,6 +56,7 @@ static const dc_parser_vtable_t oceanic_vtpro_parser_vtable = {
 	oceanic_vtpro_parser_get_datetime, /* datetime */
 	oceanic_vtpro_parser_get_field, /* fields */
 	oceanic_vtpro_parser_samples_foreach, /* samples_foreach */
+	oceanic_vtpro_parser_summary, /* summary */
 	NULL /* destroy */
 };
 
@@ -143,7 +145,8 @@ oceanic_vtpro_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, uns
 	if (size < 7 * PAGESIZE / 2)
 		return DC_STATUS_DATAFORMAT;
 
-	if (!parser->cached) {
+	// Only the dive time is not stored in the header.
+	if (type == DC_FIELD_DIVETIME && !parser->cached) {
 		sample_statistics_t statistics = SAMPLE_STATISTICS_INITIALIZER;
 		dc_status_t rc = oceanic_vtpro_parser_samples_foreach (
 			abstract, sample_statistics_cb, &statistics);
@@ -216,6 +219,13 @@ oceanic_vtpro_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, uns
 }
 
 
+static dc_status_t
+oceanic_vtpro_parser_summary (dc_parser_t *abstract, dc_summary_t *summary)
+{
+	return dc_parser_summary_fill (abstract, summary, ~DC_FIELD_MASK (DC_FIELD_DIVETIME));
+}
+
+
 static dc_status_t
 oceanic_vtpro_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata)
 {
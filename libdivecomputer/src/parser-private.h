@@ -43,8 +43,15 @@ struct dc_parser_t {
 	dc_context_t *context;
 	unsigned char *data;
 	unsigned int size;
+	// Sample types requested by the application, and the subset
+	// enabled for the samples walk that is currently in progress.
+	unsigned int samplemask;
+	unsigned int enabled;
 };
 
+// Backends may use this to skip decoding samples nobody asked for.
+#define SAMPLE_ENABLED(parser,type) (((parser)->enabled & DC_SAMPLE_MASK(type)) != 0)
+
 struct dc_parser_vtable_t {
 	size_t size;
 
@@ -62,6 +69,8 @@ struct dc_parser_vtable_t {
 
 	dc_status_t (*samples_foreach) (dc_parser_t *parser, dc_sample_callback_t callback, void *userdata);
 
+	dc_status_t (*summary) (dc_parser_t *parser, dc_summary_t *summary);
+
 	dc_status_t (*destroy) (dc_parser_t *parser);
 };
 
@@ -74,16 +83,29 @@ dc_parser_deallocate (dc_parser_t *parser);
 int
 dc_parser_isinstance (dc_parser_t *parser, const dc_parser_vtable_t *vtable);
 
+dc_status_t
+dc_parser_new_internal (dc_parser_t **parser, dc_context_t *context, const unsigned char data[], size_t size, dc_family_t family, unsigned int model);
+
+typedef struct sample_derived_t sample_derived_t;
+
 typedef struct sample_statistics_t {
 	unsigned int divetime;
 	double maxdepth;
+	// Optional derived statistics (see dc_parser_get_statistics).
+	sample_derived_t *derived;
 } sample_statistics_t;
 
-#define SAMPLE_STATISTICS_INITIALIZER {0, 0.0}
+#define SAMPLE_STATISTICS_INITIALIZER {0, 0.0, NULL}
+
+dc_status_t
+dc_parser_summary_fill (dc_parser_t *parser, dc_summary_t *summary, unsigned int fields);
 
 void
 sample_statistics_cb (dc_sample_type_t type, const dc_sample_value_t *value, void *userdata);
 
+void
+sample_derived_process (sample_derived_t *derived, dc_sample_type_t type, const dc_sample_value_t *value);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -73,7 +73,7 @@
 
 #define REACTPROWHITE 0x4354
 
-static dc_status_t
+dc_status_t
 dc_parser_new_internal (dc_parser_t **out, dc_context_t *context, const unsigned char data[], size_t size, dc_family_t family, unsigned int model)
 {
 	dc_status_t rc = DC_STATUS_SUCCESS;
@@ -271,6 +271,8 @@ dc_parser_allocate (dc_context_t *context, const dc_parser_vtable_t *vtable, con
 	// Initialize the base class.
 	parser->vtable = vtable;
 	parser->context = context;
+	parser->samplemask = DC_SAMPLE_MASK_ALL;
+	parser->enabled = DC_SAMPLE_MASK_ALL;
 
 	if (size) {
 		// Allocate memory for the data.
@@ -361,6 +363,21 @@ dc_parser_set_density (dc_parser_t *parser, double density)
 }
 
 
+dc_status_t
+dc_parser_set_sample_mask (dc_parser_t *parser, unsigned int mask)
+{
+	if (parser == NULL)
+		return DC_STATUS_UNSUPPORTED;
+
+	if (mask & ~DC_SAMPLE_MASK_ALL)
+		return DC_STATUS_INVALIDARGS;
+
+	parser->samplemask = mask;
+
+	return DC_STATUS_SUCCESS;
+}
+
+
 dc_status_t
 dc_parser_get_datetime (dc_parser_t *parser, dc_datetime_t *datetime)
 {
@@ -382,7 +399,141 @@ dc_parser_get_field (dc_parser_t *parser, dc_field_type_t type, unsigned int fla
 	if (parser->vtable->field == NULL)
 		return DC_STATUS_UNSUPPORTED;
 
-	return parser->vtable->field (parser, type, flags, value);
+	// Fields derived from the samples always need all of them, even when
+	// requested from within a masked samples callback.
+	unsigned int enabled = parser->enabled;
+	parser->enabled = DC_SAMPLE_MASK_ALL;
+
+	dc_status_t status = parser->vtable->field (parser, type, flags, value);
+
+	parser->enabled = enabled;
+
+	return status;
+}
+
+
+dc_status_t
+dc_parser_summary_fill (dc_parser_t *parser, dc_summary_t *summary, unsigned int fields)
+{
+	for (unsigned int i = DC_FIELD_DIVETIME; i <= DC_FIELD_LOCATION; ++i) {
+		dc_field_type_t type = (dc_field_type_t) i;
+		unsigned int mask = DC_FIELD_MASK (type);
+
+		if ((fields & mask) == 0 || (summary->fields & mask))
+			continue;
+
+		void *value = NULL;
+		switch (type) {
+		case DC_FIELD_DIVETIME:
+			value = &summary->divetime;
+			break;
+		case DC_FIELD_MAXDEPTH:
+			value = &summary->maxdepth;
+			break;
+		case DC_FIELD_AVGDEPTH:
+			value = &summary->avgdepth;
+			break;
+		case DC_FIELD_GASMIX_COUNT:
+			value = &summary->gasmix_count;
+			break;
+		case DC_FIELD_SALINITY:
+			value = &summary->salinity;
+			break;
+		case DC_FIELD_ATMOSPHERIC:
+			value = &summary->atmospheric;
+			break;
+		case DC_FIELD_TEMPERATURE_SURFACE:
+			value = &summary->temperature_surface;
+			break;
+		case DC_FIELD_TEMPERATURE_MINIMUM:
+			value = &summary->temperature_minimum;
+			break;
+		case DC_FIELD_TEMPERATURE_MAXIMUM:
+			value = &summary->temperature_maximum;
+			break;
+		case DC_FIELD_TANK_COUNT:
+			value = &summary->tank_count;
+			break;
+		case DC_FIELD_DIVEMODE:
+			value = &summary->divemode;
+			break;
+		case DC_FIELD_DECOMODEL:
+			value = &summary->decomodel;
+			break;
+		case DC_FIELD_LOCATION:
+			value = &summary->location;
+			break;
+		default:
+			// Indexed fields are not part of the summary.
+			continue;
+		}
+
+		dc_status_t status = parser->vtable->field (parser, type, 0, value);
+		if (status == DC_STATUS_SUCCESS) {
+			summary->fields |= mask;
+		} else if (status != DC_STATUS_UNSUPPORTED) {
+			return status;
+		}
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
+
+dc_status_t
+dc_parser_get_summary (dc_parser_t *parser, dc_summary_t *summary, unsigned int fields)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+
+	if (parser == NULL)
+		return DC_STATUS_UNSUPPORTED;
+
+	if (summary == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	if (parser->vtable->field == NULL)
+		return DC_STATUS_UNSUPPORTED;
+
+	memset (summary, 0, sizeof (*summary));
+
+	unsigned int enabled = parser->enabled;
+	parser->enabled = DC_SAMPLE_MASK_ALL;
+
+	// The backend fills in the fields that are available without
+	// decoding the samples. Only the requested fields it did not
+	// provide are retrieved the regular way, which may need a full
+	// walk of the samples. Without a summary function, the cost of
+	// the fields is unknown, and all of them are retrieved.
+	if (parser->vtable->summary) {
+		status = parser->vtable->summary (parser, summary);
+	} else {
+		fields = ~0u;
+	}
+
+	if (status == DC_STATUS_SUCCESS) {
+		status = dc_parser_summary_fill (parser, summary, fields);
+	}
+
+	parser->enabled = enabled;
+
+	return status;
+}
+
+
+typedef struct sample_filter_t {
+	dc_sample_callback_t callback;
+	void *userdata;
+	unsigned int mask;
+} sample_filter_t;
+
+static void
+sample_filter_cb (dc_sample_type_t type, const dc_sample_value_t *value, void *userdata)
+{
+	sample_filter_t *filter = (sample_filter_t *) userdata;
+
+	if (filter->mask & DC_SAMPLE_MASK(type)) {
+		filter->callback (type, value, filter->userdata);
+	}
 }
 
 
@@ -395,7 +546,20 @@ dc_parser_samples_foreach (dc_parser_t *parser, dc_sample_callback_t callback, v
 	if (parser->vtable->samples_foreach == NULL)
 		return DC_STATUS_UNSUPPORTED;
 
-	return parser->vtable->samples_foreach (parser, callback, userdata);
+	if (callback == NULL || parser->samplemask == DC_SAMPLE_MASK_ALL)
+		return parser->vtable->samples_foreach (parser, callback, userdata);
+
+	// Backends are not required to honour the mask, so the samples are
+	// filtered here as well. The mask is only enabled for the duration
+	// of this walk, the internal walks of the backends are unaffected.
+	sample_filter_t filter = {callback, userdata, parser->samplemask};
+	parser->enabled = parser->samplemask;
+
+	dc_status_t status = parser->vtable->samples_foreach (parser, sample_filter_cb, &filter);
+
+	parser->enabled = DC_SAMPLE_MASK_ALL;
+
+	return status;
 }
 
 
@@ -433,4 +597,8 @@ sample_statistics_cb (dc_sample_type_t type, const dc_sample_value_t *value, voi
 	default:
 		break;
 	}
+
+	if (statistics->derived) {
+		sample_derived_process (statistics->derived, type, value);
+	}
 }
\ No newline at end of file
@@ -0,0 +1,327 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 LibDCSwift contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#include <stdlib.h>
+#include <math.h>
+
+#include "context-private.h"
+#include "parser-private.h"
+
+/*
+ * The profile is decimated while the samples are decoded, without
+ * storing the full profile. A first (cheap) walk over the time samples
+ * counts the points, which fixes the bucket boundaries. The second walk
+ * delivers the points one by one. A profile point is created for every
+ * time sample, with the depth of the last depth sample.
+ */
+
+typedef struct profile_t {
+	dc_decimation_t decimation;
+	// Output buffer.
+	dc_profile_point_t *points;
+	unsigned int maxpoints;
+	unsigned int npoints;
+	// Total number of points, and index of the next point.
+	unsigned int count;
+	unsigned int index;
+	// Number of buckets, and index of the bucket being filled.
+	unsigned int nbuckets;
+	unsigned int bucket;
+	// Point being decoded.
+	dc_profile_point_t pending;
+	unsigned int havetime;
+	// LTTB: the last selected point, the points of the previous bucket
+	// (waiting for the average of the next one) and the current bucket.
+	dc_profile_point_t selected;
+	dc_profile_point_t *buffer;
+	dc_profile_point_t *previous, *current;
+	unsigned int nprevious, ncurrent;
+	// MINMAX: the extremes of the current bucket.
+	dc_profile_point_t min, max;
+	unsigned int imin, imax;
+	unsigned int nbucket;
+} profile_t;
+
+static void
+profile_count_cb (dc_sample_type_t type, const dc_sample_value_t DC_ATTR_UNUSED *value, void *userdata)
+{
+	unsigned int *count = (unsigned int *) userdata;
+
+	if (type == DC_SAMPLE_TIME)
+		(*count)++;
+}
+
+static void
+profile_append (profile_t *profile, const dc_profile_point_t *point)
+{
+	if (profile->npoints < profile->maxpoints) {
+		profile->points[profile->npoints++] = *point;
+	}
+}
+
+/*
+ * Bucket boundaries. Bucket i contains the points with an index in the
+ * range [boundary(i), boundary(i + 1)).
+ */
+static unsigned int
+profile_lttb_boundary (const profile_t *profile, unsigned int i)
+{
+	// The first and last point are not part of any bucket.
+	return 1 + (unsigned long long) i * (profile->count - 2) / profile->nbuckets;
+}
+
+static unsigned int
+profile_minmax_boundary (const profile_t *profile, unsigned int i)
+{
+	return (unsigned long long) i * profile->count / profile->nbuckets;
+}
+
+static void
+profile_lttb_select (profile_t *profile, const dc_profile_point_t *points, unsigned int n, double time, double depth)
+{
+	const dc_profile_point_t *a = &profile->selected;
+
+	// Select the point forming the largest triangle with the previously
+	// selected point and the average point of the next bucket.
+	unsigned int idx = 0;
+	double max = -1.0;
+	for (unsigned int i = 0; i < n; ++i) {
+		double area = fabs (
+			((double) a->time - time) * (points[i].depth - a->depth) -
+			((double) a->time - points[i].time) * (depth - a->depth));
+		if (area > max) {
+			max = area;
+			idx = i;
+		}
+	}
+
+	profile->selected = points[idx];
+	profile_append (profile, &profile->selected);
+}
+
+static void
+profile_lttb_next (profile_t *profile)
+{
+	// Select a point from the previous bucket, now that the current
+	// bucket is complete.
+	if (profile->nprevious) {
+		double time = 0.0, depth = 0.0;
+		for (unsigned int i = 0; i < profile->ncurrent; ++i) {
+			time += profile->current[i].time;
+			depth += profile->current[i].depth;
+		}
+
+		profile_lttb_select (profile, profile->previous, profile->nprevious,
+			time / profile->ncurrent, depth / profile->ncurrent);
+	}
+
+	dc_profile_point_t *points = profile->previous;
+	profile->previous = profile->current;
+	profile->nprevious = profile->ncurrent;
+	profile->current = points;
+	profile->ncurrent = 0;
+	profile->bucket++;
+}
+
+static void
+profile_lttb (profile_t *profile, const dc_profile_point_t *point, unsigned int index)
+{
+	if (index == 0) {
+		profile->selected = *point;
+		profile_append (profile, point);
+	} else if (index == profile->count - 1) {
+		// The last point acts as the next bucket of the last bucket.
+		profile_lttb_next (profile);
+		profile_lttb_select (profile, profile->previous, profile->nprevious,
+			point->time, point->depth);
+		profile_append (profile, point);
+	} else {
+		if (index >= profile_lttb_boundary (profile, profile->bucket + 1)) {
+			profile_lttb_next (profile);
+		}
+		profile->current[profile->ncurrent++] = *point;
+	}
+}
+
+static void
+profile_minmax_flush (profile_t *profile)
+{
+	if (profile->nbucket == 0)
+		return;
+
+	// Emit the extremes in chronological order.
+	if (profile->imin < profile->imax) {
+		profile_append (profile, &profile->min);
+		profile_append (profile, &profile->max);
+	} else if (profile->imin > profile->imax) {
+		profile_append (profile, &profile->max);
+		profile_append (profile, &profile->min);
+	} else {
+		profile_append (profile, &profile->min);
+	}
+
+	profile->nbucket = 0;
+}
+
+static void
+profile_minmax (profile_t *profile, const dc_profile_point_t *point, unsigned int index)
+{
+	if (index >= profile_minmax_boundary (profile, profile->bucket + 1)) {
+		profile_minmax_flush (profile);
+		profile->bucket++;
+	}
+
+	if (profile->nbucket == 0 || point->depth < profile->min.depth) {
+		profile->min = *point;
+		profile->imin = index;
+	}
+	if (profile->nbucket == 0 || point->depth > profile->max.depth) {
+		profile->max = *point;
+		profile->imax = index;
+	}
+	profile->nbucket++;
+}
+
+static void
+profile_push (profile_t *profile, const dc_profile_point_t *point)
+{
+	unsigned int index = profile->index;
+
+	// Ignore any points that were not counted.
+	if (index >= profile->count)
+		return;
+
+	profile->index++;
+
+	if (profile->count <= profile->maxpoints) {
+		profile_append (profile, point);
+	} else if (profile->decimation == DC_DECIMATION_LTTB) {
+		profile_lttb (profile, point, index);
+	} else {
+		profile_minmax (profile, point, index);
+	}
+}
+
+static void
+profile_sample_cb (dc_sample_type_t type, const dc_sample_value_t *value, void *userdata)
+{
+	profile_t *profile = (profile_t *) userdata;
+
+	switch (type) {
+	case DC_SAMPLE_TIME:
+		if (profile->havetime) {
+			profile_push (profile, &profile->pending);
+		}
+		profile->pending.time = value->time;
+		profile->havetime = 1;
+		break;
+	case DC_SAMPLE_DEPTH:
+		profile->pending.depth = value->depth;
+		break;
+	default:
+		break;
+	}
+}
+
+dc_status_t
+dc_parser_get_profile (dc_parser_t *parser, dc_decimation_t decimation, dc_profile_point_t points[], unsigned int maxpoints, unsigned int *npoints)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	profile_t profile = {0};
+
+	if (parser == NULL)
+		return DC_STATUS_UNSUPPORTED;
+
+	if (points == NULL || npoints == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	if (decimation == DC_DECIMATION_LTTB) {
+		// The first and last point, and at least one bucket.
+		if (maxpoints < 3)
+			return DC_STATUS_INVALIDARGS;
+	} else if (decimation == DC_DECIMATION_MINMAX) {
+		if (maxpoints < 2)
+			return DC_STATUS_INVALIDARGS;
+	} else {
+		return DC_STATUS_INVALIDARGS;
+	}
+
+	*npoints = 0;
+
+	unsigned int samplemask = parser->samplemask;
+
+	// Count the points.
+	parser->samplemask = DC_SAMPLE_MASK (DC_SAMPLE_TIME);
+	status = dc_parser_samples_foreach (parser, profile_count_cb, &profile.count);
+	if (status != DC_STATUS_SUCCESS)
+		goto error_restore;
+
+	profile.decimation = decimation;
+	profile.points = points;
+	profile.maxpoints = maxpoints;
+
+	if (profile.count > maxpoints) {
+		if (decimation == DC_DECIMATION_LTTB) {
+			profile.nbuckets = maxpoints - 2;
+
+			// Two buckets of the largest size.
+			unsigned int size = (profile.count - 2 + profile.nbuckets - 1) / profile.nbuckets;
+			profile.buffer = (dc_profile_point_t *) malloc (2 * size * sizeof (dc_profile_point_t));
+			if (profile.buffer == NULL) {
+				ERROR (parser->context, "Failed to allocate memory.");
+				status = DC_STATUS_NOMEMORY;
+				goto error_restore;
+			}
+			profile.previous = profile.buffer;
+			profile.current = profile.buffer + size;
+		} else {
+			profile.nbuckets = maxpoints / 2;
+		}
+	}
+
+	// Decimate the profile.
+	parser->samplemask = DC_SAMPLE_MASK (DC_SAMPLE_TIME) | DC_SAMPLE_MASK (DC_SAMPLE_DEPTH);
+	status = dc_parser_samples_foreach (parser, profile_sample_cb, &profile);
+	if (status != DC_STATUS_SUCCESS)
+		goto error_free;
+
+	if (profile.havetime) {
+		profile_push (&profile, &profile.pending);
+	}
+
+	if (profile.index != profile.count) {
+		ERROR (parser->context, "Unexpected number of profile points (%u %u).", profile.index, profile.count);
+		status = DC_STATUS_DATAFORMAT;
+		goto error_free;
+	}
+
+	if (profile.count > maxpoints && decimation == DC_DECIMATION_MINMAX) {
+		profile_minmax_flush (&profile);
+	}
+
+	*npoints = profile.npoints;
+
+error_free:
+	free (profile.buffer);
+error_restore:
+	parser->samplemask = samplemask;
+	return status;
+}
@@ -641,6 +641,21 @@ reefnet_sensusultra_parse (reefnet_sensusultra_device_t *device,
 }
 
 
+dc_status_t
+reefnet_sensusultra_extract_dives (dc_device_t *abstract, const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata)
+{
+	reefnet_sensusultra_device_t *device = (reefnet_sensusultra_device_t*) abstract;
+
+	if (abstract && !ISINSTANCE (abstract))
+		return DC_STATUS_INVALIDARGS;
+
+	unsigned int remaining = size;
+	unsigned int previous = size;
+
+	return reefnet_sensusultra_parse (device, data, &remaining, &previous, NULL, callback, userdata);
+}
+
+
 static dc_status_t
 reefnet_sensusultra_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback, void *userdata)
 {
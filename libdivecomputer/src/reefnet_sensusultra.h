@@ -38,6 +38,9 @@ reefnet_sensusultra_device_open (dc_device_t **device, dc_context_t *context, dc
 dc_status_t
 reefnet_sensusultra_parser_create (dc_parser_t **parser, dc_context_t *context, const unsigned char data[], size_t size);
 
+dc_status_t
+reefnet_sensusultra_extract_dives (dc_device_t *device, const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
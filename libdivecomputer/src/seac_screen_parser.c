@@ -61,6 +61,7 @@ static const dc_parser_vtable_t seac_screen_parser_vtable = {
 	seac_screen_parser_get_datetime, /* datetime */
 	seac_screen_parser_get_field, /* fields */
 	seac_screen_parser_samples_foreach, /* samples_foreach */
+	NULL, /* summary */
 	NULL /* destroy */
 };
 
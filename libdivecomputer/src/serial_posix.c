@@ -30,7 +30,8 @@
 #include <fcntl.h>	// fcntl
 #include <termios.h>	// tcgetattr, tcsetattr, cfsetispeed, cfsetospeed, tcflush, tcsendbreak
 #include <sys/ioctl.h>	// ioctl
-#include <sys/select.h>	// select
+#include <sys/uio.h>	// readv
+#include <poll.h>	// poll
 #ifdef HAVE_LINUX_SERIAL_H
 #include <linux/serial.h>
 #endif
@@ -62,6 +63,8 @@
 
 #define DIRNAME "/dev"
 
+#define SZ_RBUF 4096
+
 static dc_status_t dc_serial_iterator_next (dc_iterator_t *iterator, void *item);
 static dc_status_t dc_serial_iterator_free (dc_iterator_t *iterator);
 
@@ -105,6 +108,14 @@ typedef struct dc_serial_t {
 	 * serial port is closed.
 	 */
 	struct termios tty;
+	/*
+	 * Read-ahead buffer. Every read drains all the data that is
+	 * already available, such that the next reads can be served
+	 * without any system calls.
+	 */
+	unsigned char rbuf[SZ_RBUF];
+	size_t roffset;
+	size_t rsize;
 } dc_serial_t;
 
 static const dc_iterator_vtable_t dc_serial_iterator_vtable = {
@@ -281,6 +292,10 @@ dc_serial_open (dc_iostream_t **out, dc_context_t *context, const char *name)
 	// Default to blocking reads.
 	device->timeout = -1;
 
+	// Empty the read-ahead buffer.
+	device->roffset = 0;
+	device->rsize = 0;
+
 	// Create a high resolution timer.
 	status = dc_timer_new (&device->timer);
 	if (status != DC_STATUS_SUCCESS) {
@@ -665,33 +680,22 @@ dc_serial_set_latency (dc_iostream_t *abstract, unsigned int milliseconds)
 }
 
 static dc_status_t
-dc_serial_poll (dc_iostream_t *abstract, int timeout)
+dc_serial_wait (dc_serial_t *device, int events, int timeout)
 {
-	dc_serial_t *device = (dc_serial_t *) abstract;
 	int rc = 0;
 
 	do {
-		fd_set fds;
-		FD_ZERO (&fds);
-		FD_SET (device->fd, &fds);
-
-		struct timeval tv, *ptv = NULL;
-		if (timeout > 0) {
-			tv.tv_sec  = (timeout / 1000);
-			tv.tv_usec = (timeout % 1000) * 1000;
-			ptv = &tv;
-		} else if (timeout == 0) {
-			tv.tv_sec  = 0;
-			tv.tv_usec = 0;
-			ptv = &tv;
-		}
+		struct pollfd pfd;
+		pfd.fd = device->fd;
+		pfd.events = events;
+		pfd.revents = 0;
 
-		rc = select (device->fd + 1, &fds, NULL, NULL, ptv);
+		rc = poll (&pfd, 1, timeout);
 	} while (rc < 0 && errno == EINTR);
 
 	if (rc < 0) {
 		int errcode = errno;
-		SYSERROR (abstract->context, errcode);
+		SYSERROR (device->base.context, errcode);
 		return syserror (errcode);
 	} else if (rc == 0) {
 		return DC_STATUS_TIMEOUT;
@@ -700,6 +704,17 @@ dc_serial_poll (dc_iostream_t *abstract, int timeout)
 	}
 }
 
+static dc_status_t
+dc_serial_poll (dc_iostream_t *abstract, int timeout)
+{
+	dc_serial_t *device = (dc_serial_t *) abstract;
+
+	if (device->rsize)
+		return DC_STATUS_SUCCESS;
+
+	return dc_serial_wait (device, POLLIN, timeout);
+}
+
 static dc_status_t
 dc_serial_read (dc_iostream_t *abstract, void *data, size_t size, size_t *actual)
 {
@@ -710,15 +725,50 @@ dc_serial_read (dc_iostream_t *abstract, void *data, size_t size, size_t *actual
 	// The absolute target time.
 	dc_usecs_t target = 0;
 
+	// Take the data from the read-ahead buffer first.
+	if (device->rsize) {
+		nbytes = device->rsize < size ? device->rsize : size;
+		memcpy (data, device->rbuf + device->roffset, nbytes);
+		device->roffset += nbytes;
+		device->rsize -= nbytes;
+	}
+
 	int init = 1;
 	while (nbytes < size) {
-		fd_set fds;
-		FD_ZERO (&fds);
-		FD_SET (device->fd, &fds);
+		// Read all the data that is already available. Anything beyond
+		// the requested size ends up in the (empty) read-ahead buffer.
+		struct iovec iov[2];
+		iov[0].iov_base = (char *) data + nbytes;
+		iov[0].iov_len = size - nbytes;
+		iov[1].iov_base = device->rbuf;
+		iov[1].iov_len = sizeof (device->rbuf);
+
+		ssize_t n = readv (device->fd, iov, 2);
+		if (n < 0) {
+			int errcode = errno;
+			if (errcode == EINTR)
+				continue; // Retry.
+			if (errcode != EAGAIN) {
+				SYSERROR (abstract->context, errcode);
+				status = syserror (errcode);
+				goto out;
+			}
+		} else if (n == 0) {
+			 break; // EOF.
+		} else {
+			if ((size_t) n > size - nbytes) {
+				device->roffset = 0;
+				device->rsize = n - (size - nbytes);
+				n = size - nbytes;
+			}
+			nbytes += n;
+			continue;
+		}
 
-		struct timeval tv, *ptv = NULL;
+		// No data available yet.
+		int timeout = -1;
 		if (device->timeout > 0) {
-			dc_usecs_t timeout = 0;
+			dc_usecs_t remaining = 0;
 
 			dc_usecs_t now = 0;
 			status = dc_timer_now (device->timer, &now);
@@ -728,52 +778,29 @@ dc_serial_read (dc_iostream_t *abstract, void *data, size_t size, size_t *actual
 
 			if (init) {
 				// Calculate the initial timeout.
-				timeout = (dc_usecs_t) device->timeout * 1000;
+				remaining = (dc_usecs_t) device->timeout * 1000;
 				// Calculate the target time.
-				target = now + timeout;
+				target = now + remaining;
 				init = 0;
 			} else {
 				// Calculate the remaining timeout.
 				if (now < target) {
-					timeout = target - now;
+					remaining = target - now;
 				} else {
-					timeout = 0;
+					remaining = 0;
 				}
 			}
-			tv.tv_sec  = timeout / 1000000;
-			tv.tv_usec = timeout % 1000000;
-			ptv = &tv;
+			timeout = (remaining + 999) / 1000;
 		} else if (device->timeout == 0) {
-			tv.tv_sec  = 0;
-			tv.tv_usec = 0;
-			ptv = &tv;
+			timeout = 0;
 		}
 
-		int rc = select (device->fd + 1, &fds, NULL, NULL, ptv);
-		if (rc < 0) {
-			int errcode = errno;
-			if (errcode == EINTR)
-				continue; // Retry.
-			SYSERROR (abstract->context, errcode);
-			status = syserror (errcode);
-			goto out;
-		} else if (rc == 0) {
+		status = dc_serial_wait (device, POLLIN, timeout);
+		if (status == DC_STATUS_TIMEOUT) {
 			break; // Timeout.
-		}
-
-		ssize_t n = read (device->fd, (char *) data + nbytes, size - nbytes);
-		if (n < 0) {
-			int errcode = errno;
-			if (errcode == EINTR || errcode == EAGAIN)
-				continue; // Retry.
-			SYSERROR (abstract->context, errcode);
-			status = syserror (errcode);
+		} else if (status != DC_STATUS_SUCCESS) {
 			goto out;
-		} else if (n == 0) {
-			 break; // EOF.
 		}
-
-		nbytes += n;
 	}
 
 	if (nbytes != size) {
@@ -795,27 +822,18 @@ dc_serial_write (dc_iostream_t *abstract, const void *data, size_t size, size_t
 	size_t nbytes = 0;
 
 	while (nbytes < size) {
-		fd_set fds;
-		FD_ZERO (&fds);
-		FD_SET (device->fd, &fds);
-
-		int rc = select (device->fd + 1, NULL, &fds, NULL, NULL);
-		if (rc < 0) {
-			int errcode = errno;
-			if (errcode == EINTR)
-				continue; // Retry.
-			SYSERROR (abstract->context, errcode);
-			status = syserror (errcode);
-			goto out;
-		} else if (rc == 0) {
-			break; // Timeout.
-		}
-
 		ssize_t n = write (device->fd, (const char *) data + nbytes, size - nbytes);
 		if (n < 0) {
 			int errcode = errno;
-			if (errcode == EINTR || errcode == EAGAIN)
+			if (errcode == EINTR)
+				continue; // Retry.
+			if (errcode == EAGAIN) {
+				// Wait until the output queue has room again.
+				status = dc_serial_wait (device, POLLOUT, -1);
+				if (status != DC_STATUS_SUCCESS)
+					goto out;
 				continue; // Retry.
+			}
 			SYSERROR (abstract->context, errcode);
 			status = syserror (errcode);
 			goto out;
@@ -866,6 +884,11 @@ dc_serial_purge (dc_iostream_t *abstract, dc_direction_t direction)
 
 	int flags = 0;
 
+	if (direction & DC_DIRECTION_INPUT) {
+		device->roffset = 0;
+		device->rsize = 0;
+	}
+
 	switch (direction) {
 	case DC_DIRECTION_INPUT:
 		flags = TCIFLUSH;
@@ -958,7 +981,7 @@ dc_serial_get_available (dc_iostream_t *abstract, size_t *value)
 	}
 
 	if (value)
-		*value = bytes;
+		*value = device->rsize + bytes;
 
 	return DC_STATUS_SUCCESS;
 }
@@ -74,7 +74,7 @@ shearwater_common_setup (shearwater_common_device_t *device, dc_context_t *conte
 
 
 static int
-shearwater_common_decompress_lre (unsigned char *data, unsigned int size, dc_buffer_t *buffer, unsigned int *isfinal)
+shearwater_common_decompress_lre (const unsigned char *data, unsigned int size, dc_buffer_t *buffer, unsigned int *isfinal)
 {
 	// The RLE decompression algorithm does interpret the binary data as a
 	// stream of 9 bit values. Therefore, the total number of bits needs to be
@@ -131,6 +131,27 @@ shearwater_common_decompress_xor (unsigned char *data, unsigned int size)
 	return 0;
 }
 
+dc_status_t
+shearwater_common_decompress (dc_context_t *context, const unsigned char data[], unsigned int size, dc_buffer_t *buffer)
+{
+	if (buffer == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	dc_buffer_clear (buffer);
+
+	if (shearwater_common_decompress_lre (data, size, buffer, NULL) != 0) {
+		ERROR (context, "Decompression error (LRE phase).");
+		return DC_STATUS_DATAFORMAT;
+	}
+
+	if (shearwater_common_decompress_xor (dc_buffer_get_data (buffer), dc_buffer_get_size (buffer)) != 0) {
+		ERROR (context, "Decompression error (XOR phase).");
+		return DC_STATUS_DATAFORMAT;
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
 static dc_status_t
 shearwater_common_slip_write (shearwater_common_device_t *device, const unsigned char data[], unsigned int size)
 {
@@ -71,6 +71,13 @@ shearwater_common_transfer (shearwater_common_device_t *device, const unsigned c
 dc_status_t
 shearwater_common_download (shearwater_common_device_t *device, dc_buffer_t *buffer, unsigned int address, unsigned int size, unsigned int compression, dc_event_progress_t *progress);
 
+/*
+ * Decompress a complete dive, in the compressed format used for the
+ * transfer (LRE followed by XOR), into the buffer.
+ */
+dc_status_t
+shearwater_common_decompress (dc_context_t *context, const unsigned char data[], unsigned int size, dc_buffer_t *buffer);
+
 dc_status_t
 shearwater_common_rdbi (shearwater_common_device_t *device, unsigned int id, unsigned char data[], unsigned int size);
 
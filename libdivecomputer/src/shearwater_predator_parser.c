@@ -156,6 +156,7 @@ struct shearwater_predator_parser_t {
 static dc_status_t shearwater_predator_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t shearwater_predator_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t shearwater_predator_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
+static dc_status_t shearwater_predator_parser_summary (dc_parser_t *abstract, dc_summary_t *summary);
 
 static dc_status_t shearwater_predator_parser_cache (shearwater_predator_parser_t *parser);
 
@@ -168,6 +169,7 @@ static const dc_parser_vtable_t shearwater_predator_parser_vtable = {
 	shearwater_predator_parser_get_datetime, /* datetime */
 	shearwater_predator_parser_get_field, /* fields */
 	shearwater_predator_parser_samples_foreach, /* samples_foreach */
+	shearwater_predator_parser_summary, /* summary */
 	NULL /* destroy */
 };
 
@@ -180,6 +182,7 @@ static const dc_parser_vtable_t shearwater_petrel_parser_vtable = {
 	shearwater_predator_parser_get_datetime, /* datetime */
 	shearwater_predator_parser_get_field, /* fields */
 	shearwater_predator_parser_samples_foreach, /* samples_foreach */
+	shearwater_predator_parser_summary, /* summary */
 	NULL /* destroy */
 };
 
@@ -861,6 +864,22 @@ shearwater_predator_parser_get_field (dc_parser_t *abstract, dc_field_type_t typ
 }
 
 
+static dc_status_t
+shearwater_predator_parser_summary (dc_parser_t *abstract, dc_summary_t *summary)
+{
+	shearwater_predator_parser_t *parser = (shearwater_predator_parser_t *) abstract;
+
+	// The records are walked once to locate the opening and closing
+	// records, and to collect the gas mixes and tanks. All fields are
+	// available from the cached data afterwards.
+	dc_status_t rc = shearwater_predator_parser_cache (parser);
+	if (rc != DC_STATUS_SUCCESS)
+		return rc;
+
+	return dc_parser_summary_fill (abstract, summary, ~0u);
+}
+
+
 static dc_status_t
 shearwater_predator_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata)
 {
@@ -884,6 +903,18 @@ shearwater_predator_parser_samples_foreach (dc_parser_t *abstract, dc_sample_cal
 		interval = array_uint16_be (data + parser->opening[5] + 23);
 	}
 
+	// Sample types to decode.
+	unsigned int temperature_enabled = SAMPLE_ENABLED (abstract, DC_SAMPLE_TEMPERATURE);
+	unsigned int ppo2_enabled = SAMPLE_ENABLED (abstract, DC_SAMPLE_PPO2);
+	unsigned int setpoint_enabled = SAMPLE_ENABLED (abstract, DC_SAMPLE_SETPOINT);
+	unsigned int cns_enabled = SAMPLE_ENABLED (abstract, DC_SAMPLE_CNS);
+	unsigned int deco_enabled = SAMPLE_ENABLED (abstract, DC_SAMPLE_DECO);
+	unsigned int pressure_enabled = SAMPLE_ENABLED (abstract, DC_SAMPLE_PRESSURE);
+	unsigned int rbt_enabled = SAMPLE_ENABLED (abstract, DC_SAMPLE_RBT);
+	unsigned int events_enabled =
+		SAMPLE_ENABLED (abstract, DC_SAMPLE_BEARING) ||
+		SAMPLE_ENABLED (abstract, DC_SAMPLE_EVENT);
+
 	unsigned int pnf = parser->pnf;
 	unsigned int offset = parser->headersize;
 	unsigned int length = size - parser->footersize;
@@ -914,19 +945,21 @@ shearwater_predator_parser_samples_foreach (dc_parser_t *abstract, dc_sample_cal
 			if (callback) callback (DC_SAMPLE_DEPTH, &sample, userdata);
 
 			// Temperature (°C or °F).
-			int temperature = (signed char) data[offset + pnf + 13];
-			if (temperature < 0) {
-				// Fix negative temperatures.
-				temperature += 102;
-				if (temperature > 0) {
-					temperature = 0;
+			if (temperature_enabled) {
+				int temperature = (signed char) data[offset + pnf + 13];
+				if (temperature < 0) {
+					// Fix negative temperatures.
+					temperature += 102;
+					if (temperature > 0) {
+						temperature = 0;
+					}
 				}
+				if (parser->units == IMPERIAL)
+					sample.temperature = (temperature - 32.0) * (5.0 / 9.0);
+				else
+					sample.temperature = temperature;
+				if (callback) callback (DC_SAMPLE_TEMPERATURE, &sample, userdata);
 			}
-			if (parser->units == IMPERIAL)
-				sample.temperature = (temperature - 32.0) * (5.0 / 9.0);
-			else
-				sample.temperature = temperature;
-			if (callback) callback (DC_SAMPLE_TEMPERATURE, &sample, userdata);
 
 			// Status flags.
 			unsigned int status = data[offset + pnf + 11];
@@ -934,7 +967,7 @@ shearwater_predator_parser_samples_foreach (dc_parser_t *abstract, dc_sample_cal
 
 			if (ccr) {
 				// PPO2
-				if ((status & PPO2_EXTERNAL) == 0) {
+				if (ppo2_enabled && (status & PPO2_EXTERNAL) == 0) {
 					sample.ppo2.sensor = DC_SENSOR_NONE;
 					sample.ppo2.value = data[offset + pnf + 6] / 100.0;
 					if (callback) callback (DC_SAMPLE_PPO2, &sample, userdata);
@@ -953,21 +986,23 @@ shearwater_predator_parser_samples_foreach (dc_parser_t *abstract, dc_sample_cal
 				}
 
 				// Setpoint
-				if (parser->petrel) {
-					sample.setpoint = data[offset + pnf + 18] / 100.0;
-				} else {
-					// this will only ever be called for the actual Predator, so no adjustment needed for PNF
-					if (status & SETPOINT_HIGH) {
-						sample.setpoint = data[18] / 100.0;
+				if (setpoint_enabled) {
+					if (parser->petrel) {
+						sample.setpoint = data[offset + pnf + 18] / 100.0;
 					} else {
-						sample.setpoint = data[17] / 100.0;
+						// this will only ever be called for the actual Predator, so no adjustment needed for PNF
+						if (status & SETPOINT_HIGH) {
+							sample.setpoint = data[18] / 100.0;
+						} else {
+							sample.setpoint = data[17] / 100.0;
+						}
 					}
+					if (callback) callback (DC_SAMPLE_SETPOINT, &sample, userdata);
 				}
-				if (callback) callback (DC_SAMPLE_SETPOINT, &sample, userdata);
 			}
 
 			// CNS
-			if (parser->petrel) {
+			if (cns_enabled && parser->petrel) {
 				sample.cns = data[offset + pnf + 22] / 100.0;
 				if (callback) callback (DC_SAMPLE_CNS, &sample, userdata);
 			}
@@ -991,24 +1026,26 @@ shearwater_predator_parser_samples_foreach (dc_parser_t *abstract, dc_sample_cal
 			}
 
 			// Deco stop / NDL.
-			unsigned int decostop = array_uint16_be (data + offset + pnf + 2);
-			if (decostop) {
-				sample.deco.type = DC_DECO_DECOSTOP;
-				if (parser->units == IMPERIAL)
-					sample.deco.depth = decostop * FEET;
-				else
-					sample.deco.depth = decostop;
-			} else {
-				sample.deco.type = DC_DECO_NDL;
-				sample.deco.depth = 0.0;
+			if (deco_enabled) {
+				unsigned int decostop = array_uint16_be (data + offset + pnf + 2);
+				if (decostop) {
+					sample.deco.type = DC_DECO_DECOSTOP;
+					if (parser->units == IMPERIAL)
+						sample.deco.depth = decostop * FEET;
+					else
+						sample.deco.depth = decostop;
+				} else {
+					sample.deco.type = DC_DECO_NDL;
+					sample.deco.depth = 0.0;
+				}
+				sample.deco.time = data[offset + pnf + 9] * 60;
+				sample.deco.tts = array_uint16_be (data + offset + pnf + 4) * 60;
+				if (callback) callback (DC_SAMPLE_DECO, &sample, userdata);
 			}
-			sample.deco.time = data[offset + pnf + 9] * 60;
-			sample.deco.tts = array_uint16_be (data + offset + pnf + 4) * 60;
-			if (callback) callback (DC_SAMPLE_DECO, &sample, userdata);
 
 			// for logversion 7 and newer (introduced for Perdix AI)
 			// detect tank pressure
-			if (parser->logversion >= 7) {
+			if (pressure_enabled && parser->logversion >= 7) {
 				const unsigned int idx[2] = {27, 19};
 				for (unsigned int i = 0; i < 2; ++i) {
 					// Tank pressure
@@ -1031,7 +1068,9 @@ shearwater_predator_parser_samples_foreach (dc_parser_t *abstract, dc_sample_cal
 						}
 					}
 				}
+			}
 
+			if (rbt_enabled && parser->logversion >= 7) {
 				// Gas time remaining in minutes
 				// Values above 0xF0 are special codes:
 				//    0xFF Not paired
@@ -1044,7 +1083,7 @@ shearwater_predator_parser_samples_foreach (dc_parser_t *abstract, dc_sample_cal
 					if (callback) callback (DC_SAMPLE_RBT, &sample, userdata);
 				}
 			}
-		} else if (type == LOG_RECORD_DIVE_SAMPLE_EXT) {
+		} else if (type == LOG_RECORD_DIVE_SAMPLE_EXT && pressure_enabled) {
 			// Tank pressure
 			if (parser->logversion >= 13) {
 				for (unsigned int i = 0; i < 2; ++i) {
@@ -1095,11 +1134,13 @@ shearwater_predator_parser_samples_foreach (dc_parser_t *abstract, dc_sample_cal
 				if (callback) callback (DC_SAMPLE_DEPTH, &sample, userdata);
 
 				// Temperature (1/10 °C).
-				int temperature = (signed short) array_uint16_be (data + idx + 3);
-				sample.temperature = temperature / 10.0;
-				if (callback) callback (DC_SAMPLE_TEMPERATURE, &sample, userdata);
+				if (temperature_enabled) {
+					int temperature = (signed short) array_uint16_be (data + idx + 3);
+					sample.temperature = temperature / 10.0;
+					if (callback) callback (DC_SAMPLE_TEMPERATURE, &sample, userdata);
+				}
 			}
-		} else if (type == LOG_RECORD_INFO_EVENT) {
+		} else if (type == LOG_RECORD_INFO_EVENT && events_enabled) {
 			unsigned int event = data[offset + 1];
 			unsigned int DC_ATTR_UNUSED timestamp = array_uint32_be (data + offset + 4);
 			unsigned int w1 = array_uint32_be (data + offset + 8);
@@ -19,6 +19,8 @@
  * MA 02110-1301 USA
  */
 
+#include <string.h>
+
 #include "socket.h"
 #include "platform.h"
 
@@ -96,6 +98,11 @@ dc_socket_open (dc_iostream_t *abstract, int family, int type, int protocol)
 	// Default to blocking reads.
 	device->timeout = -1;
 
+	// Empty the internal buffers.
+	device->roffset = 0;
+	device->rsize = 0;
+	device->wsize = 0;
+
 	// Initialize the socket library.
 	status = dc_socket_init (abstract->context);
 	if (status != DC_STATUS_SUCCESS) {
@@ -139,6 +146,12 @@ dc_socket_close (dc_iostream_t *abstract)
 	dc_socket_t *socket = (dc_socket_t *) abstract;
 	dc_status_t rc = DC_STATUS_SUCCESS;
 
+	// Send any pending data.
+	rc = dc_socket_flush (abstract);
+	if (rc != DC_STATUS_SUCCESS) {
+		dc_status_set_error(&status, rc);
+	}
+
 	// Terminate all send and receive operations.
 	shutdown (socket->fd, 0);
 
@@ -182,33 +195,12 @@ dc_socket_set_timeout (dc_iostream_t *abstract, int timeout)
 	return DC_STATUS_SUCCESS;
 }
 
-dc_status_t
-dc_socket_get_available (dc_iostream_t *abstract, size_t *value)
-{
-	dc_socket_t *socket = (dc_socket_t *) abstract;
-
-#ifdef _WIN32
-	unsigned long bytes = 0;
-#else
-	int bytes = 0;
-#endif
-
-	if (S_IOCTL (socket->fd, FIONREAD, &bytes) != 0) {
-		s_errcode_t errcode = S_ERRNO;
-		SYSERROR (abstract->context, errcode);
-		return dc_socket_syserror(errcode);
-	}
-
-	if (value)
-		*value = bytes;
-
-	return DC_STATUS_SUCCESS;
-}
-
-dc_status_t
-dc_socket_poll (dc_iostream_t *abstract, int timeout)
+/*
+ * Wait until the socket is ready for reading (or writing).
+ */
+static dc_status_t
+dc_socket_wait (dc_socket_t *socket, int timeout, int output)
 {
-	dc_socket_t *socket = (dc_socket_t *) abstract;
 	int rc = 0;
 
 	do {
@@ -227,12 +219,12 @@ dc_socket_poll (dc_iostream_t *abstract, int timeout)
 			ptv = &tv;
 		}
 
-		rc = select (socket->fd + 1, &fds, NULL, NULL, ptv);
+		rc = select (socket->fd + 1, output ? NULL : &fds, output ? &fds : NULL, NULL, ptv);
 	} while (rc < 0 && S_ERRNO == S_EINTR);
 
 	if (rc < 0) {
 		s_errcode_t errcode = S_ERRNO;
-		SYSERROR (abstract->context, errcode);
+		SYSERROR (socket->base.context, errcode);
 		return dc_socket_syserror(errcode);
 	} else if (rc == 0) {
 		return DC_STATUS_TIMEOUT;
@@ -241,58 +233,147 @@ dc_socket_poll (dc_iostream_t *abstract, int timeout)
 	}
 }
 
-dc_status_t
-dc_socket_read (dc_iostream_t *abstract, void *data, size_t size, size_t *actual)
+/*
+ * Receive the data that is already available, without blocking. The
+ * data is scattered over the caller's buffer and the (empty) read-ahead
+ * buffer, such that a single system call also prefetches the data for
+ * the next reads. Returns DC_STATUS_TIMEOUT if no data is available
+ * yet. An actual size of zero indicates the end of the stream.
+ */
+static dc_status_t
+dc_socket_recv (dc_socket_t *socket, unsigned char *data, size_t size, size_t *actual)
+{
+	s_ssize_t n = 0;
+
+#ifdef _WIN32
+	dc_status_t status = dc_socket_wait (socket, 0, 0);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	n = recv (socket->fd, (char *) socket->rbuf, sizeof (socket->rbuf), 0);
+#else
+	struct iovec iov[2];
+	iov[0].iov_base = data;
+	iov[0].iov_len = size;
+	iov[1].iov_base = socket->rbuf;
+	iov[1].iov_len = sizeof (socket->rbuf);
+
+	struct msghdr msg;
+	memset (&msg, 0, sizeof (msg));
+	msg.msg_iov = iov;
+	msg.msg_iovlen = 2;
+
+	do {
+		n = recvmsg (socket->fd, &msg, MSG_DONTWAIT);
+	} while (n < 0 && S_ERRNO == S_EINTR);
+#endif
+	if (n < 0) {
+		s_errcode_t errcode = S_ERRNO;
+		if (errcode == S_EAGAIN)
+			return DC_STATUS_TIMEOUT;
+		SYSERROR (socket->base.context, errcode);
+		return dc_socket_syserror(errcode);
+	}
+
+#ifdef _WIN32
+	socket->roffset = 0;
+	socket->rsize = n;
+	n = (size_t) n < size ? (size_t) n : size;
+	memcpy (data, socket->rbuf, n);
+	socket->roffset += n;
+	socket->rsize -= n;
+#else
+	if ((size_t) n > size) {
+		socket->roffset = 0;
+		socket->rsize = n - size;
+		n = size;
+	}
+#endif
+
+	*actual = n;
+
+	return DC_STATUS_SUCCESS;
+}
+
+/*
+ * Send the pending data, followed by the new data, with as few system
+ * calls as possible.
+ */
+static dc_status_t
+dc_socket_send (dc_socket_t *socket, const unsigned char *data, size_t size, size_t *actual)
 {
 	dc_status_t status = DC_STATUS_SUCCESS;
-	dc_socket_t *socket = (dc_socket_t *) abstract;
+	size_t npending = 0;
 	size_t nbytes = 0;
 
-	while (nbytes < size) {
-		fd_set fds;
-		FD_ZERO (&fds);
-		FD_SET (socket->fd, &fds);
-
-		struct timeval tvt;
-		if (socket->timeout > 0) {
-			tvt.tv_sec  = (socket->timeout / 1000);
-			tvt.tv_usec = (socket->timeout % 1000) * 1000;
-		} else if (socket->timeout == 0) {
-			timerclear (&tvt);
+	while (npending < socket->wsize || nbytes < size) {
+#ifdef _WIN32
+		const unsigned char *buffer = data + nbytes;
+		size_t length = size - nbytes;
+		if (npending < socket->wsize) {
+			buffer = socket->wbuf + npending;
+			length = socket->wsize - npending;
 		}
 
-		int rc = select (socket->fd + 1, &fds, NULL, NULL, socket->timeout >= 0 ? &tvt : NULL);
-		if (rc < 0) {
-			s_errcode_t errcode = S_ERRNO;
-			if (errcode == S_EINTR)
-				continue; // Retry.
-			SYSERROR (abstract->context, errcode);
-			status = dc_socket_syserror(errcode);
-			goto out;
-		} else if (rc == 0) {
-			break; // Timeout.
+		s_ssize_t n = send (socket->fd, (const char *) buffer, length, MSG_NOSIGNAL);
+#else
+		struct iovec iov[2];
+		int iovcnt = 0;
+		if (npending < socket->wsize) {
+			iov[iovcnt].iov_base = socket->wbuf + npending;
+			iov[iovcnt].iov_len = socket->wsize - npending;
+			iovcnt++;
 		}
+		if (nbytes < size) {
+			iov[iovcnt].iov_base = (unsigned char *) data + nbytes;
+			iov[iovcnt].iov_len = size - nbytes;
+			iovcnt++;
+		}
+
+		struct msghdr msg;
+		memset (&msg, 0, sizeof (msg));
+		msg.msg_iov = iov;
+		msg.msg_iovlen = iovcnt;
 
-		s_ssize_t n = recv (socket->fd, (char *) data + nbytes, size - nbytes, 0);
+		s_ssize_t n = sendmsg (socket->fd, &msg, MSG_NOSIGNAL);
+#endif
 		if (n < 0) {
 			s_errcode_t errcode = S_ERRNO;
-			if (errcode == S_EINTR || errcode == S_EAGAIN)
+			if (errcode == S_EINTR)
+				continue; // Retry.
+			if (errcode == S_EAGAIN) {
+				status = dc_socket_wait (socket, -1, 1);
+				if (status != DC_STATUS_SUCCESS)
+					goto out;
 				continue; // Retry.
-			SYSERROR (abstract->context, errcode);
+			}
+			SYSERROR (socket->base.context, errcode);
 			status = dc_socket_syserror(errcode);
 			goto out;
 		} else if (n == 0) {
-			break; // EOF reached.
+			break; // EOF.
 		}
 
-		nbytes += n;
+		// The pending data is always sent first.
+		size_t count = n;
+		size_t pending = socket->wsize - npending;
+		if (count > pending) {
+			npending += pending;
+			nbytes += count - pending;
+		} else {
+			npending += count;
+		}
 	}
 
-	if (nbytes != size) {
+	if (npending != socket->wsize || nbytes != size) {
 		status = DC_STATUS_TIMEOUT;
 	}
 
 out:
+	// Remove the data that has been sent.
+	memmove (socket->wbuf, socket->wbuf + npending, socket->wsize - npending);
+	socket->wsize -= npending;
+
 	if (actual)
 		*actual = nbytes;
 
@@ -300,39 +381,79 @@ out:
 }
 
 dc_status_t
-dc_socket_write (dc_iostream_t *abstract, const void *data, size_t size, size_t *actual)
+dc_socket_get_available (dc_iostream_t *abstract, size_t *value)
+{
+	dc_socket_t *socket = (dc_socket_t *) abstract;
+
+#ifdef _WIN32
+	unsigned long bytes = 0;
+#else
+	int bytes = 0;
+#endif
+
+	if (S_IOCTL (socket->fd, FIONREAD, &bytes) != 0) {
+		s_errcode_t errcode = S_ERRNO;
+		SYSERROR (abstract->context, errcode);
+		return dc_socket_syserror(errcode);
+	}
+
+	if (value)
+		*value = socket->rsize + bytes;
+
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+dc_socket_poll (dc_iostream_t *abstract, int timeout)
+{
+	dc_socket_t *socket = (dc_socket_t *) abstract;
+
+	if (socket->rsize)
+		return DC_STATUS_SUCCESS;
+
+	dc_status_t status = dc_socket_flush (abstract);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	return dc_socket_wait (socket, timeout, 0);
+}
+
+dc_status_t
+dc_socket_read (dc_iostream_t *abstract, void *data, size_t size, size_t *actual)
 {
 	dc_status_t status = DC_STATUS_SUCCESS;
 	dc_socket_t *socket = (dc_socket_t *) abstract;
 	size_t nbytes = 0;
 
-	while (nbytes < size) {
-		fd_set fds;
-		FD_ZERO (&fds);
-		FD_SET (socket->fd, &fds);
-
-		int rc = select (socket->fd + 1, NULL, &fds, NULL, NULL);
-		if (rc < 0) {
-			s_errcode_t errcode = S_ERRNO;
-			if (errcode == S_EINTR)
-				continue; // Retry.
-			SYSERROR (abstract->context, errcode);
-			status = dc_socket_syserror(errcode);
-			goto out;
-		} else if (rc == 0) {
-			break; // Timeout.
-		}
+	// The device can't answer before it received all pending data.
+	status = dc_socket_flush (abstract);
+	if (status != DC_STATUS_SUCCESS)
+		goto out;
+
+	// Take the data from the read-ahead buffer first.
+	if (socket->rsize) {
+		nbytes = socket->rsize < size ? socket->rsize : size;
+		memcpy (data, socket->rbuf + socket->roffset, nbytes);
+		socket->roffset += nbytes;
+		socket->rsize -= nbytes;
+	}
 
-		s_ssize_t n = send (socket->fd, (const char *) data + nbytes, size - nbytes, MSG_NOSIGNAL);
-		if (n < 0) {
-			s_errcode_t errcode = S_ERRNO;
-			if (errcode == S_EINTR || errcode == S_EAGAIN)
-				continue; // Retry.
-			SYSERROR (abstract->context, errcode);
-			status = dc_socket_syserror(errcode);
+	while (nbytes < size) {
+		size_t n = 0;
+		status = dc_socket_recv (socket, (unsigned char *) data + nbytes, size - nbytes, &n);
+		if (status == DC_STATUS_TIMEOUT) {
+			// Wait for more data to arrive.
+			status = dc_socket_wait (socket, socket->timeout, 0);
+			if (status == DC_STATUS_TIMEOUT) {
+				break; // Timeout.
+			} else if (status != DC_STATUS_SUCCESS) {
+				goto out;
+			}
+			continue;
+		} else if (status != DC_STATUS_SUCCESS) {
 			goto out;
 		} else if (n == 0) {
-			break; // EOF.
+			break; // EOF reached.
 		}
 
 		nbytes += n;
@@ -349,15 +470,65 @@ out:
 	return status;
 }
 
+dc_status_t
+dc_socket_write (dc_iostream_t *abstract, const void *data, size_t size, size_t *actual)
+{
+	dc_socket_t *socket = (dc_socket_t *) abstract;
+
+	// Coalesce small writes.
+	if (size <= sizeof (socket->wbuf) - socket->wsize) {
+		memcpy (socket->wbuf + socket->wsize, data, size);
+		socket->wsize += size;
+		if (actual)
+			*actual = size;
+		return DC_STATUS_SUCCESS;
+	}
+
+	return dc_socket_send (socket, (const unsigned char *) data, size, actual);
+}
+
 dc_status_t
 dc_socket_ioctl (dc_iostream_t *abstract, unsigned int request, void *data, size_t size)
 {
 	return DC_STATUS_UNSUPPORTED;
 }
 
+dc_status_t
+dc_socket_flush (dc_iostream_t *abstract)
+{
+	dc_socket_t *socket = (dc_socket_t *) abstract;
+
+	if (socket->wsize == 0)
+		return DC_STATUS_SUCCESS;
+
+	return dc_socket_send (socket, NULL, 0, NULL);
+}
+
+dc_status_t
+dc_socket_purge (dc_iostream_t *abstract, dc_direction_t direction)
+{
+	dc_socket_t *socket = (dc_socket_t *) abstract;
+
+	if (direction & DC_DIRECTION_INPUT) {
+		socket->roffset = 0;
+		socket->rsize = 0;
+	}
+
+	// Discard the pending output, without sending it.
+	if (direction & DC_DIRECTION_OUTPUT) {
+		socket->wsize = 0;
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
 dc_status_t
 dc_socket_sleep (dc_iostream_t *abstract, unsigned int timeout)
 {
+	dc_status_t status = dc_socket_flush (abstract);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
 	if (dc_platform_sleep (timeout) != 0) {
 		s_errcode_t errcode = S_ERRNO;
 		SYSERROR (abstract->context, errcode);
@@ -34,6 +34,7 @@
 #include <sys/socket.h> // socket, getsockopt
 #include <sys/select.h> // select
 #include <sys/ioctl.h>  // ioctl
+#include <sys/uio.h>    // iovec
 #include <sys/time.h>
 #include <time.h>
 #endif
@@ -79,10 +80,27 @@ typedef socklen_t s_socklen_t;
 extern "C" {
 #endif /* __cplusplus */
 
+#define DC_SOCKET_RBUF 4096
+#define DC_SOCKET_WBUF 1024
+
 typedef struct dc_socket_t {
 	dc_iostream_t base;
 	s_socket_t fd;
 	int timeout;
+	/*
+	 * Read-ahead buffer. Every receive call also fills this buffer with
+	 * whatever else is already available, such that the next small read
+	 * doesn't need a system call.
+	 */
+	unsigned char rbuf[DC_SOCKET_RBUF];
+	size_t roffset;
+	size_t rsize;
+	/*
+	 * Pending output. Small writes are coalesced, and sent (together
+	 * with the next write) before waiting for any incoming data.
+	 */
+	unsigned char wbuf[DC_SOCKET_WBUF];
+	size_t wsize;
 } dc_socket_t;
 
 dc_status_t
@@ -121,6 +139,12 @@ dc_socket_write (dc_iostream_t *iostream, const void *data, size_t size, size_t
 dc_status_t
 dc_socket_ioctl (dc_iostream_t *iostream, unsigned int request, void *data, size_t size);
 
+dc_status_t
+dc_socket_flush (dc_iostream_t *iostream);
+
+dc_status_t
+dc_socket_purge (dc_iostream_t *iostream, dc_direction_t direction);
+
 dc_status_t
 dc_socket_sleep (dc_iostream_t *abstract, unsigned int timeout);
 
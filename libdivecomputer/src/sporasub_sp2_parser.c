@@ -50,6 +50,7 @@ static const dc_parser_vtable_t sporasub_sp2_parser_vtable = {
 	sporasub_sp2_parser_get_datetime, /* datetime */
 	sporasub_sp2_parser_get_field, /* fields */
 	sporasub_sp2_parser_samples_foreach, /* samples_foreach */
+	NULL, /* summary */
 	NULL /* destroy */
 };
 
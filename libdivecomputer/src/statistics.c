@@ -0,0 +1,287 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 LibDCSwift contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#include <string.h>
+
+#include <libdivecomputer/units.h>
+
+#include "context-private.h"
+#include "parser-private.h"
+
+/*
+ * The statistics are accumulated while the samples are decoded, on top
+ * of the basic statistics of sample_statistics_cb. A profile point is
+ * completed at the next time sample (or the end of the dive), with the
+ * depth of the last depth sample. Every segment between two consecutive
+ * points, starting from the surface at time zero, contributes to the
+ * average depth, the histograms and the integral of the ambient
+ * pressure over time, which is used for the gas consumption.
+ */
+
+typedef struct sample_tank_t {
+	unsigned int count;
+	unsigned int begintime, endtime;
+	double beginpressure, endpressure;
+	// Integral of the ambient pressure at the first and last sample.
+	double beginintegral, endintegral;
+} sample_tank_t;
+
+struct sample_derived_t {
+	dc_statistics_t *statistics;
+	// Ambient pressure.
+	double atmospheric;
+	double hydrostatic;
+	// Point being decoded, and the last completed point.
+	unsigned int time;
+	double depth;
+	unsigned int havetime;
+	unsigned int lasttime;
+	double lastdepth;
+	// Integrals over time (milliseconds) of the depth and the ambient
+	// pressure, up to the last completed point.
+	double depthtime;
+	double pressuretime;
+	// Number of temperature samples.
+	unsigned int ntemperatures;
+	// Tanks with a pressure sample in the point being decoded.
+	unsigned int pending;
+	sample_tank_t tank[DC_STATISTICS_TANKS];
+};
+
+static unsigned int
+statistics_bin (double value, double step, unsigned int nbins)
+{
+	double bin = value / step;
+	if (bin < 0.0)
+		return 0;
+	if (bin >= nbins - 1)
+		return nbins - 1;
+	return (unsigned int) bin;
+}
+
+static void
+statistics_segment (sample_derived_t *derived)
+{
+	dc_statistics_t *statistics = derived->statistics;
+
+	if (derived->time <= derived->lasttime)
+		return;
+
+	double dt = derived->time - derived->lasttime;
+	double delta = derived->depth - derived->lastdepth;
+	double mean = (derived->depth + derived->lastdepth) / 2.0;
+	double seconds = dt / 1000.0;
+
+	derived->depthtime += mean * dt;
+	derived->pressuretime += (derived->atmospheric + mean * derived->hydrostatic) * dt;
+
+	statistics->depth[statistics_bin (mean, DC_STATISTICS_DEPTH_STEP, DC_STATISTICS_DEPTH_BINS)] += seconds;
+
+	double rate = delta * 60000.0 / dt;
+	if (rate > 0.0) {
+		statistics->descent[statistics_bin (rate, DC_STATISTICS_RATE_STEP, DC_STATISTICS_RATE_BINS)] += seconds;
+		if (statistics->maxdescent < rate)
+			statistics->maxdescent = rate;
+	} else if (rate < 0.0) {
+		statistics->ascent[statistics_bin (-rate, DC_STATISTICS_RATE_STEP, DC_STATISTICS_RATE_BINS)] += seconds;
+		if (statistics->maxascent < -rate)
+			statistics->maxascent = -rate;
+	}
+}
+
+static void
+statistics_point (sample_derived_t *derived)
+{
+	statistics_segment (derived);
+
+	if (derived->time > derived->lasttime) {
+		derived->lasttime = derived->time;
+		derived->lastdepth = derived->depth;
+	}
+
+	// The pressure samples of this point are now at a known position in
+	// the ambient pressure integral.
+	for (unsigned int i = 0; derived->pending; ++i) {
+		if (derived->pending & (1u << i)) {
+			sample_tank_t *tank = &derived->tank[i];
+			if (tank->count == 1) {
+				tank->begintime = derived->lasttime;
+				tank->beginintegral = derived->pressuretime;
+			}
+			tank->endtime = derived->lasttime;
+			tank->endintegral = derived->pressuretime;
+			derived->pending &= ~(1u << i);
+		}
+	}
+}
+
+void
+sample_derived_process (sample_derived_t *derived, dc_sample_type_t type, const dc_sample_value_t *value)
+{
+	dc_statistics_t *statistics = derived->statistics;
+
+	switch (type) {
+	case DC_SAMPLE_TIME:
+		if (derived->havetime) {
+			statistics_point (derived);
+		}
+		derived->time = value->time;
+		derived->havetime = 1;
+		break;
+	case DC_SAMPLE_DEPTH:
+		derived->depth = value->depth;
+		break;
+	case DC_SAMPLE_TEMPERATURE:
+		if (derived->ntemperatures == 0 || statistics->temperature_minimum > value->temperature)
+			statistics->temperature_minimum = value->temperature;
+		if (derived->ntemperatures == 0 || statistics->temperature_maximum < value->temperature)
+			statistics->temperature_maximum = value->temperature;
+		derived->ntemperatures++;
+		break;
+	case DC_SAMPLE_PRESSURE:
+		if (value->pressure.tank < DC_STATISTICS_TANKS) {
+			sample_tank_t *tank = &derived->tank[value->pressure.tank];
+			if (tank->count == 0) {
+				tank->beginpressure = value->pressure.value;
+			}
+			tank->endpressure = value->pressure.value;
+			tank->count++;
+			derived->pending |= 1u << value->pressure.tank;
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+dc_status_t
+dc_parser_get_statistics (dc_parser_t *parser, dc_statistics_t *statistics)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	sample_derived_t derived;
+	sample_statistics_t basic = SAMPLE_STATISTICS_INITIALIZER;
+
+	if (parser == NULL)
+		return DC_STATUS_UNSUPPORTED;
+
+	if (statistics == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	memset (statistics, 0, sizeof (*statistics));
+	memset (&derived, 0, sizeof (derived));
+
+	// Surface pressure and water density.
+	double atmospheric = 0.0;
+	if (dc_parser_get_field (parser, DC_FIELD_ATMOSPHERIC, 0, &atmospheric) == DC_STATUS_SUCCESS &&
+		atmospheric > 0.0) {
+		derived.atmospheric = atmospheric;
+	} else {
+		derived.atmospheric = ATM / BAR;
+	}
+
+	double density = DEF_DENSITY_SALT;
+	dc_salinity_t salinity = {DC_WATER_SALT, 0.0};
+	if (dc_parser_get_field (parser, DC_FIELD_SALINITY, 0, &salinity) == DC_STATUS_SUCCESS &&
+		salinity.density > 0.0) {
+		density = salinity.density;
+	} else if (salinity.type == DC_WATER_FRESH) {
+		density = DEF_DENSITY_FRESH;
+	}
+	derived.hydrostatic = density * GRAVITY / BAR;
+
+	// The tank volumes, for the RMV.
+	double volume[DC_STATISTICS_TANKS] = {0};
+	unsigned int ntanks = 0;
+	if (dc_parser_get_field (parser, DC_FIELD_TANK_COUNT, 0, &ntanks) == DC_STATUS_SUCCESS) {
+		for (unsigned int i = 0; i < ntanks && i < DC_STATISTICS_TANKS; ++i) {
+			dc_tank_t tank;
+			if (dc_parser_get_field (parser, DC_FIELD_TANK, i, &tank) == DC_STATUS_SUCCESS &&
+				tank.type != DC_TANKVOLUME_NONE) {
+				volume[i] = tank.volume;
+			}
+		}
+	}
+
+	// Walk all the samples, regardless of the sample mask.
+	unsigned int samplemask = parser->samplemask;
+	unsigned int enabled = parser->enabled;
+	parser->samplemask = DC_SAMPLE_MASK_ALL;
+	parser->enabled = DC_SAMPLE_MASK_ALL;
+
+	derived.statistics = statistics;
+	basic.derived = &derived;
+	status = dc_parser_samples_foreach (parser, sample_statistics_cb, &basic);
+
+	parser->samplemask = samplemask;
+	parser->enabled = enabled;
+
+	if (status != DC_STATUS_SUCCESS) {
+		memset (statistics, 0, sizeof (*statistics));
+		return status;
+	}
+
+	if (derived.havetime) {
+		statistics_point (&derived);
+
+		statistics->fields |= DC_FIELD_MASK (DC_FIELD_DIVETIME) |
+			DC_FIELD_MASK (DC_FIELD_MAXDEPTH) |
+			DC_FIELD_MASK (DC_FIELD_AVGDEPTH);
+		statistics->divetime = basic.divetime;
+		statistics->maxdepth = basic.maxdepth;
+		if (derived.lasttime) {
+			statistics->avgdepth = derived.depthtime / derived.lasttime;
+		}
+	}
+
+	if (derived.ntemperatures) {
+		statistics->fields |= DC_FIELD_MASK (DC_FIELD_TEMPERATURE_MINIMUM) |
+			DC_FIELD_MASK (DC_FIELD_TEMPERATURE_MAXIMUM);
+	}
+
+	for (unsigned int i = 0; i < DC_STATISTICS_TANKS; ++i) {
+		const sample_tank_t *tank = &derived.tank[i];
+		dc_consumption_t *consumption = &statistics->tank[i];
+
+		if (tank->count == 0)
+			continue;
+
+		statistics->tank_count = i + 1;
+
+		consumption->beginpressure = tank->beginpressure;
+		consumption->endpressure = tank->endpressure;
+		consumption->duration = (tank->endtime - tank->begintime) / 1000.0;
+
+		// Pressure drop per minute, divided by the average ambient
+		// pressure relative to the surface.
+		double drop = tank->beginpressure - tank->endpressure;
+		double integral = tank->endintegral - tank->beginintegral;
+		if (drop > 0.0 && integral > 0.0) {
+			consumption->sac = drop * derived.atmospheric * 60000.0 / integral;
+			consumption->rmv = consumption->sac * volume[i] / derived.atmospheric;
+		}
+	}
+
+	if (statistics->tank_count) {
+		statistics->fields |= DC_FIELD_MASK (DC_FIELD_TANK_COUNT);
+	}
+
+	return status;
+}
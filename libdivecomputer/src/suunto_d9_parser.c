@@ -68,11 +68,43 @@
 #define DECOSTOP     (1 << 1)
 #define DEEPSTOP     (1 << 2)
 
+typedef enum suunto_d9_initial_t {
+	INITIAL_NONE,
+	INITIAL_INDEX,       // Gas mix index
+	INITIAL_CCR,         // Gas mix index, with the CCR mixes listed first
+} suunto_d9_initial_t;
+
+typedef struct suunto_d9_parser_layout_t {
+	unsigned int datetime;
+	unsigned int datetime_ymd;      // Date stored before the time
+	unsigned int divetime;
+	unsigned int divetime_factor;   // 60 for minutes, 1 for seconds
+	unsigned int conservatism;
+	unsigned int conservatism_bias;
+	unsigned int interval;
+	unsigned int extrablock;        // Optional block in front of the profile
+	unsigned int gaschange_ppo2;    // Gas change events include a setpoint
+	unsigned int gaschange_ppo2_id; // Idem, only for this logbook id
+	unsigned int gasmode;
+	unsigned int gasmix;
+	unsigned int gasmix_v2;
+	unsigned int id_v2;             // Logbook id of the newer layout
+	unsigned int gasmix_count;
+	unsigned int gasmix_count_id;   // Number of mixes depends on the id
+	unsigned int ccr_count;
+	unsigned int gasmix_records;    // 6 byte gas mix records with helium
+	unsigned int config;            // Only without gas mix records
+	suunto_d9_initial_t initial;
+	unsigned int initial_offset;
+	unsigned int initial_offset_v2;
+} suunto_d9_parser_layout_t;
+
 typedef struct suunto_d9_parser_t suunto_d9_parser_t;
 
 struct suunto_d9_parser_t {
 	dc_parser_t base;
 	unsigned int model;
+	const suunto_d9_parser_layout_t *layout;
 	// Cached fields.
 	unsigned int cached;
 	unsigned int id;
@@ -83,6 +115,7 @@ struct suunto_d9_parser_t {
 	unsigned int helium[NGASMIXES];
 	unsigned int gasmix;
 	unsigned int config;
+	unsigned int gaschange_ppo2;
 };
 
 typedef struct sample_info_t {
@@ -105,9 +138,155 @@ static const dc_parser_vtable_t suunto_d9_parser_vtable = {
 	suunto_d9_parser_get_datetime, /* datetime */
 	suunto_d9_parser_get_field, /* fields */
 	suunto_d9_parser_samples_foreach, /* samples_foreach */
+	NULL, /* summary */
 	NULL /* destroy */
 };
 
+static const suunto_d9_parser_layout_t suunto_d9_parser_layout = {
+	.datetime = 0x11,
+	.divetime = 0x0B,
+	.divetime_factor = 60,
+	.conservatism = 0x1E,
+	.interval = 0x18,
+	.gasmode = 0x19,
+	.gasmix = 0x21,
+	.gasmix_v2 = 0x21,
+	.gasmix_count = 3,
+	.config = 0x3A,
+};
+
+static const suunto_d9_parser_layout_t suunto_d4_parser_layout = {
+	.datetime = 0x11,
+	.divetime = 0x0B,
+	.divetime_factor = 1,
+	.conservatism = 0x1E,
+	.interval = 0x18,
+	.gasmode = 0x19,
+	.gasmix = 0x21,
+	.gasmix_v2 = 0x21,
+	.gasmix_count = 3,
+	.config = 0x3B,
+};
+
+static const suunto_d9_parser_layout_t suunto_helo2_parser_layout = {
+	.datetime = 0x17,
+	.divetime = 0x0D,
+	.divetime_factor = 60,
+	.conservatism = 0x23,
+	.conservatism_bias = 2,
+	.interval = 0x1E,
+	.extrablock = 1,
+	.gasmode = 0x1F,
+	.gasmix = 0x54,
+	.gasmix_v2 = 0x54,
+	.gasmix_count = 8,
+	.gasmix_records = 1,
+	.initial = INITIAL_INDEX,
+	.initial_offset = 0x26,
+	.initial_offset_v2 = 0x26,
+};
+
+static const suunto_d9_parser_layout_t suunto_d4i_parser_layout = {
+	.datetime = 0x13,
+	.datetime_ymd = 1,
+	.divetime = 0x0D,
+	.divetime_factor = 1,
+	.conservatism = 0x21,
+	.conservatism_bias = 2,
+	.interval = 0x1E,
+	.gasmode = 0x1D,
+	.gasmix = 0x5F,
+	.gasmix_v2 = 0x67,
+	.id_v2 = ID_D4I_V2,
+	.gasmix_count = 1,
+	.gasmix_records = 1,
+	.initial = INITIAL_INDEX,
+	.initial_offset = 0x28,
+	.initial_offset_v2 = 0x2D,
+};
+
+static const suunto_d9_parser_layout_t suunto_d6i_parser_layout = {
+	.datetime = 0x13,
+	.datetime_ymd = 1,
+	.divetime = 0x0D,
+	.divetime_factor = 1,
+	.conservatism = 0x21,
+	.conservatism_bias = 2,
+	.interval = 0x1E,
+	.gaschange_ppo2_id = ID_D6I_V2,
+	.gasmode = 0x1D,
+	.gasmix = 0x5F,
+	.gasmix_v2 = 0x67,
+	.id_v2 = ID_D6I_V2,
+	.gasmix_count = 2,
+	.gasmix_count_id = 1,
+	.gasmix_records = 1,
+	.initial = INITIAL_INDEX,
+	.initial_offset = 0x28,
+	.initial_offset_v2 = 0x2D,
+};
+
+static const suunto_d9_parser_layout_t suunto_vypernovo_parser_layout = {
+	.datetime = 0x13,
+	.datetime_ymd = 1,
+	.divetime = 0x0D,
+	.divetime_factor = 1,
+	.conservatism = 0x21,
+	.conservatism_bias = 2,
+	.interval = 0x1E,
+	.gaschange_ppo2 = 1,
+	.gasmode = 0x1D,
+	.gasmix = 0x5F,
+	.gasmix_v2 = 0x67,
+	.id_v2 = ID_D6I_V2,
+	.gasmix_count = 2,
+	.gasmix_count_id = 1,
+	.gasmix_records = 1,
+	.initial = INITIAL_INDEX,
+	.initial_offset = 0x28,
+	.initial_offset_v2 = 0x2D,
+};
+
+static const suunto_d9_parser_layout_t suunto_d9tx_parser_layout = {
+	.datetime = 0x13,
+	.datetime_ymd = 1,
+	.divetime = 0x0D,
+	.divetime_factor = 1,
+	.conservatism = 0x21,
+	.conservatism_bias = 2,
+	.interval = 0x1E,
+	.gasmode = 0x1D,
+	.gasmix = 0x87,
+	.gasmix_v2 = 0x87,
+	.id_v2 = ID_D6I_V2,
+	.gasmix_count = 8,
+	.gasmix_records = 1,
+	.initial = INITIAL_INDEX,
+	.initial_offset = 0x28,
+	.initial_offset_v2 = 0x2D,
+};
+
+static const suunto_d9_parser_layout_t suunto_dx_parser_layout = {
+	.datetime = 0x17,
+	.datetime_ymd = 1,
+	.divetime = 0x0D,
+	.divetime_factor = 1,
+	.conservatism = 0x25,
+	.conservatism_bias = 2,
+	.interval = 0x22,
+	.gaschange_ppo2 = 1,
+	.gasmode = 0x21,
+	.gasmix = 0xC1,
+	.gasmix_v2 = 0xC3,
+	.id_v2 = ID_DX_V2,
+	.gasmix_count = 11,
+	.ccr_count = 3,
+	.gasmix_records = 1,
+	.initial = INITIAL_CCR,
+	.initial_offset = 0x31,
+	.initial_offset_v2 = 0x31,
+};
+
 static unsigned int
 suunto_d9_parser_find_gasmix (suunto_d9_parser_t *parser, unsigned int o2, unsigned int he)
 {
@@ -132,59 +311,25 @@ suunto_d9_parser_cache (suunto_d9_parser_t *parser)
 		return DC_STATUS_SUCCESS;
 	}
 
+	const suunto_d9_parser_layout_t *layout = parser->layout;
+
 	// Get the logbook id tag.
 	unsigned int id = array_uint32_le (data + 1);
+	unsigned int v2 = layout->id_v2 && id == layout->id_v2;
 
 	// Gasmix information.
-	unsigned int gasmode_offset = 0x19;
-	unsigned int gasmix_offset = 0x21;
-	unsigned int gasmix_count = 3;
-	unsigned int ccr_count = 0;
-	if (parser->model == HELO2) {
-		gasmode_offset = 0x1F;
-		gasmix_offset = 0x54;
-		gasmix_count = 8;
-	} else if (parser->model == D4i || parser->model == ZOOPNOVO_A ||
-		parser->model == ZOOPNOVO_B || parser->model == D4F) {
-		gasmode_offset = 0x1D;
-		if (id == ID_D4I_V2)
-			gasmix_offset = 0x67;
-		else
-			gasmix_offset = 0x5F;
-		gasmix_count = 1;
-	} else if (parser->model == D6i || parser->model == VYPERNOVO) {
-		gasmode_offset = 0x1D;
-		if (id == ID_D6I_V2)
-			gasmix_offset = 0x67;
-		else
-			gasmix_offset = 0x5F;
-		if (id == ID_D6I_V1_MIX3 || id == ID_D6I_V2)
-			gasmix_count = 3;
-		else
-			gasmix_count = 2;
-	} else if (parser->model == D9tx) {
-		gasmode_offset = 0x1D;
-		gasmix_offset = 0x87;
-		gasmix_count = 8;
-	} else if (parser->model == DX) {
-		gasmode_offset = 0x21;
-		if (id == ID_DX_V2)
-			gasmix_offset = 0xC3;
-		else
-			gasmix_offset = 0xC1;
-		gasmix_count = 11;
-		ccr_count = 3;
+	unsigned int gasmode_offset = layout->gasmode;
+	unsigned int gasmix_offset = v2 ? layout->gasmix_v2 : layout->gasmix;
+	unsigned int gasmix_count = layout->gasmix_count;
+	unsigned int ccr_count = layout->ccr_count;
+	if (layout->gasmix_count_id &&
+		(id == ID_D6I_V1_MIX3 || id == ID_D6I_V2)) {
+		gasmix_count = 3;
 	}
 
 	// Offset to the configuration data.
-	unsigned int config = 0x3A;
-	if (parser->model == D4) {
-		config += 1;
-	} else if (parser->model == HELO2 || parser->model == D4i ||
-		parser->model == D6i || parser->model == D9tx ||
-		parser->model == DX || parser->model == ZOOPNOVO_A ||
-		parser->model == ZOOPNOVO_B || parser->model == VYPERNOVO ||
-		parser->model == D4F) {
+	unsigned int config = layout->config;
+	if (layout->gasmix_records) {
 		config = gasmix_offset + gasmix_count * 6;
 	}
 	if (config + 1 > size)
@@ -205,11 +350,7 @@ suunto_d9_parser_cache (suunto_d9_parser_t *parser)
 		parser->ngasmixes = 0;
 		parser->nccr = ccr_count;
 		for (unsigned int i = 0; i < gasmix_count; ++i) {
-			if (parser->model == HELO2 || parser->model == D4i ||
-				parser->model == D6i || parser->model == D9tx ||
-				parser->model == DX || parser->model == ZOOPNOVO_A ||
-				parser->model == ZOOPNOVO_B || parser->model == VYPERNOVO ||
-				parser->model == D4F) {
+			if (layout->gasmix_records) {
 				parser->oxygen[i] = data[gasmix_offset + 6 * i + 1];
 				parser->helium[i] = data[gasmix_offset + 6 * i + 2];
 			} else {
@@ -223,25 +364,18 @@ suunto_d9_parser_cache (suunto_d9_parser_t *parser)
 		}
 
 		// Initial gasmix.
-		if (parser->model == HELO2) {
-			parser->gasmix = data[0x26];
-		} else if (parser->model == D4i || parser->model == D6i ||
-			parser->model == D9tx || parser->model == ZOOPNOVO_A ||
-			parser->model == ZOOPNOVO_B || parser->model == VYPERNOVO ||
-			parser->model == D4F) {
-			if (id == ID_D4I_V2 || id == ID_D6I_V2) {
-				parser->gasmix = data[0x2D];
-			} else {
-				parser->gasmix = data[0x28];
-			}
-		} else if (parser->model == DX) {
-			parser->gasmix = data[0x31] & 0x7F;
-			if ((data[0x31] & 0x80) == 0) {
+		if (layout->initial == INITIAL_INDEX) {
+			parser->gasmix = data[v2 ? layout->initial_offset_v2 : layout->initial_offset];
+		} else if (layout->initial == INITIAL_CCR) {
+			parser->gasmix = data[layout->initial_offset] & 0x7F;
+			if ((data[layout->initial_offset] & 0x80) == 0) {
 				parser->gasmix += parser->nccr;
 			}
 		}
 	}
 	parser->config = config;
+	parser->gaschange_ppo2 = layout->gaschange_ppo2 ||
+		(layout->gaschange_ppo2_id && id == layout->gaschange_ppo2_id);
 	parser->id = id;
 	parser->cached = 1;
 
@@ -265,6 +399,35 @@ suunto_d9_parser_create (dc_parser_t **out, dc_context_t *context, const unsigne
 
 	// Set the default values.
 	parser->model = model;
+	switch (model) {
+	case D4:
+		parser->layout = &suunto_d4_parser_layout;
+		break;
+	case HELO2:
+		parser->layout = &suunto_helo2_parser_layout;
+		break;
+	case D4i:
+	case ZOOPNOVO_A:
+	case ZOOPNOVO_B:
+	case D4F:
+		parser->layout = &suunto_d4i_parser_layout;
+		break;
+	case D6i:
+		parser->layout = &suunto_d6i_parser_layout;
+		break;
+	case VYPERNOVO:
+		parser->layout = &suunto_vypernovo_parser_layout;
+		break;
+	case D9tx:
+		parser->layout = &suunto_d9tx_parser_layout;
+		break;
+	case DX:
+		parser->layout = &suunto_dx_parser_layout;
+		break;
+	default:
+		parser->layout = &suunto_d9_parser_layout;
+		break;
+	}
 	parser->cached = 0;
 	parser->id = 0;
 	parser->mode = AIR;
@@ -276,6 +439,7 @@ suunto_d9_parser_create (dc_parser_t **out, dc_context_t *context, const unsigne
 	}
 	parser->gasmix = 0;
 	parser->config = 0;
+	parser->gaschange_ppo2 = 0;
 
 	*out = (dc_parser_t*) parser;
 
@@ -288,14 +452,7 @@ suunto_d9_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime)
 {
 	suunto_d9_parser_t *parser = (suunto_d9_parser_t*) abstract;
 
-	unsigned int offset = 0x11;
-	if (parser->model == HELO2 || parser->model == DX)
-		offset = 0x17;
-	else if (parser->model == D4i || parser->model == D6i ||
-		parser->model == D9tx || parser->model == ZOOPNOVO_A ||
-		parser->model == ZOOPNOVO_B || parser->model == VYPERNOVO ||
-		parser->model == D4F)
-		offset = 0x13;
+	unsigned int offset = parser->layout->datetime;
 
 	if (abstract->size < offset + 7)
 		return DC_STATUS_DATAFORMAT;
@@ -303,10 +460,7 @@ suunto_d9_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime)
 	const unsigned char *p = abstract->data + offset;
 
 	if (datetime) {
-		if (parser->model == D4i || parser->model == D6i ||
-			parser->model == D9tx || parser->model == DX ||
-			parser->model == ZOOPNOVO_A || parser->model == ZOOPNOVO_B ||
-			parser->model == VYPERNOVO || parser->model == D4F) {
+		if (parser->layout->datetime_ymd) {
 			datetime->year   = p[0] + (p[1] << 8);
 			datetime->month  = p[2];
 			datetime->day    = p[3];
@@ -345,17 +499,7 @@ suunto_d9_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigne
 	if (value) {
 		switch (type) {
 		case DC_FIELD_DIVETIME:
-			if (parser->model == D4)
-				*((unsigned int *) value) = array_uint16_le (data + 0x0B);
-			else if (parser->model == D4i || parser->model == D6i ||
-				parser->model == D9tx || parser->model == DX ||
-				parser->model == ZOOPNOVO_A || parser->model == ZOOPNOVO_B ||
-				parser->model == VYPERNOVO || parser->model == D4F)
-				*((unsigned int *) value) = array_uint16_le (data + 0x0D);
-			else if (parser->model == HELO2)
-				*((unsigned int *) value) = array_uint16_le (data + 0x0D) * 60;
-			else
-				*((unsigned int *) value) = array_uint16_le (data + 0x0B) * 60;
+			*((unsigned int *) value) = array_uint16_le (data + parser->layout->divetime) * parser->layout->divetime_factor;
 			break;
 		case DC_FIELD_MAXDEPTH:
 			*((double *) value) = array_uint16_le (data + 0x09) / 100.0;
@@ -391,17 +535,7 @@ suunto_d9_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigne
 			break;
 		case DC_FIELD_DECOMODEL:
 			decomodel->type = DC_DECOMODEL_RGBM;
-			if (parser->model == D4i ||parser->model == D6i ||
-				parser->model == D9tx || parser->model == ZOOPNOVO_A ||
-				parser->model == ZOOPNOVO_B || parser->model == VYPERNOVO ||
-				parser->model == D4F)
-				decomodel->conservatism = data[0x21] - 2;
-			else if (parser->model == HELO2)
-				decomodel->conservatism = data[0x23] - 2;
-			else if (parser->model == DX)
-				decomodel->conservatism = data[0x25] - 2;
-			else
-				decomodel->conservatism = data[0x1E];
+			decomodel->conservatism = data[parser->layout->conservatism] - (int) parser->layout->conservatism_bias;
 			break;
 		default:
 			return DC_STATUS_UNSUPPORTED;
@@ -465,7 +599,7 @@ suunto_d9_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t ca
 
 	// HelO2 dives can have an additional data block.
 	const unsigned char sequence[] = {0x01, 0x00, 0x00};
-	if (parser->model == HELO2 && memcmp (data + profile, sequence, sizeof (sequence)) != 0)
+	if (parser->layout->extrablock && memcmp (data + profile, sequence, sizeof (sequence)) != 0)
 		profile += 12;
 	if (profile + 5 > size) {
 		ERROR (abstract->context, "Buffer overflow detected!");
@@ -473,15 +607,7 @@ suunto_d9_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t ca
 	}
 
 	// Sample recording interval.
-	unsigned int interval_sample_offset = 0x18;
-	if (parser->model == HELO2 || parser->model == D4i ||
-		parser->model == D6i || parser->model == D9tx ||
-		parser->model == ZOOPNOVO_A || parser->model == ZOOPNOVO_B ||
-		parser->model == VYPERNOVO || parser->model == D4F)
-		interval_sample_offset = 0x1E;
-	else if (parser->model == DX)
-		interval_sample_offset = 0x22;
-	unsigned int interval_sample = data[interval_sample_offset];
+	unsigned int interval_sample = data[parser->layout->interval];
 	if (interval_sample == 0) {
 		ERROR (abstract->context, "Invalid sample interval.");
 		return DC_STATUS_DATAFORMAT;
@@ -730,8 +856,7 @@ suunto_d9_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t ca
 					offset += 2;
 					break;
 				case 0x06: // Gas Change
-					if (parser->model == DX || parser->model == VYPERNOVO ||
-						(parser->model == D6i && parser->id == ID_D6I_V2)) {
+					if (parser->gaschange_ppo2) {
 						length = 5;
 					} else {
 						length = 4;
@@ -743,8 +868,7 @@ suunto_d9_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t ca
 					type = data[offset + 0];
 					he = data[offset + 1];
 					o2 = data[offset + 2];
-					if (parser->model == DX || parser->model == VYPERNOVO ||
-						(parser->model == D6i && parser->id == ID_D6I_V2)) {
+					if (parser->gaschange_ppo2) {
 						ppo2 = data[offset + 3];
 						seconds = data[offset + 4];
 					} else {
@@ -56,6 +56,7 @@ static const dc_parser_vtable_t suunto_eon_parser_vtable = {
 	suunto_eon_parser_get_datetime, /* datetime */
 	suunto_eon_parser_get_field, /* fields */
 	suunto_eon_parser_samples_foreach, /* samples_foreach */
+	NULL, /* summary */
 	NULL /* destroy */
 };
 
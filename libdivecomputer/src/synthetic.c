@@ -0,0 +1,1011 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 LibDCSwift contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#include <string.h>
+#include <math.h>
+
+#include <libdivecomputer/synthetic.h>
+#include <libdivecomputer/units.h>
+
+#include "context-private.h"
+#include "shearwater_common.h"
+#include "array.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define MAXTANKS 8
+
+// Dive profile.
+#define DESCENT   18.0  // m/min
+#define ASCENT     9.0  // m/min
+#define STOPDEPTH  5.0  // m
+#define STOPTIME   180  // s
+#define PERIOD    1200  // s
+#define NOISE      0.1  // m
+
+// Gas consumption.
+#define SAC       20.0  // l/min
+#define VOLUME    12.0  // l
+#define FILL     200.0  // bar
+#define RESERVE   20.0  // bar
+
+// Environment.
+#define ATMOSPHERIC 1013 // mbar
+#define DENSITY     1025 // kg/m³
+#define SURFACE     24.0 // °C
+#define BOTTOM      14.0 // °C
+#define GFLOW       30
+#define GFHIGH      70
+
+// 2024-06-01 10:00:00 UTC
+#define TIMESTAMP 1717236000
+#define EPOCH2000 946684800
+
+// Shearwater
+#define SW_PREDATOR 2
+#define SW_PETREL   3
+#define SW_OC       0x10
+#define SW_OC_TEC   1
+#define SW_AI_OFF   0
+#define SW_AI_ON    5
+#define SW_LOGVERSION 13
+#define SW_SZ_BLOCK  0x80
+#define SW_SZ_SAMPLE 0x10
+#define SW_SZ_RECORD 0x20
+
+// Heinrichs Weikamp
+#define OSTC3       0x0A
+#define OSTC3_SZ_HEADER 256
+#define OSTC3_TEMPERATURE 0
+#define OSTC3_DECO        1
+#define OSTC3_TANK        6
+
+// Suunto
+#define EONSTEEL    0
+
+// Uwatec
+#define GALILEO     0x11
+#define GALILEO_SZ_HEADER 152
+#define GALILEO_INTERVAL  4
+#define GALILEO_NTANKS    3
+#define GALILEO_SALINITY  0x00100000
+
+static const unsigned int oxygen[MAXTANKS] = {21, 32, 28, 36, 25, 30, 34, 40};
+
+typedef struct synthetic_t {
+	// Random number generator (xorshift32).
+	unsigned int state;
+	// Parameters.
+	unsigned int duration;
+	unsigned int interval;
+	unsigned int nsamples;
+	unsigned int ntanks;
+	double maxdepth;
+	double probability;
+	// Phases of the dive (seconds).
+	double descent;
+	double ascent;
+	double arrival;
+	double departure;
+	// Current sample.
+	unsigned int index;
+	unsigned int time;
+	double depth;
+	double temperature;
+	unsigned int tank;
+	unsigned int gaschange;
+	unsigned int event;
+	double pressure[MAXTANKS];
+	double beginpressure[MAXTANKS];
+	// Totals, for the header fields.
+	double deepest;
+	double depthtime;
+	double coldest;
+	double warmest;
+	unsigned int nevents;
+} synthetic_t;
+
+static unsigned int
+synthetic_random (synthetic_t *s)
+{
+	unsigned int x = s->state;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	s->state = x;
+	return x;
+}
+
+static double
+synthetic_uniform (synthetic_t *s)
+{
+	return synthetic_random (s) / 4294967296.0;
+}
+
+static double
+synthetic_bottom (const synthetic_t *s, double t)
+{
+	return s->maxdepth * (0.85 + 0.15 * cos (2.0 * M_PI * (t - s->descent) / PERIOD));
+}
+
+static double
+synthetic_profile (const synthetic_t *s, double t)
+{
+	if (t >= s->duration)
+		return 0.0;
+
+	if (t < s->descent)
+		return s->maxdepth * t / s->descent;
+
+	if (t < s->ascent)
+		return synthetic_bottom (s, t);
+
+	double depth = synthetic_bottom (s, s->ascent);
+	if (depth <= STOPDEPTH || s->departure <= s->arrival) {
+		return depth * (s->duration - t) / (s->duration - s->ascent);
+	}
+
+	if (t < s->arrival)
+		return depth + (STOPDEPTH - depth) * (t - s->ascent) / (s->arrival - s->ascent);
+
+	if (t < s->departure)
+		return STOPDEPTH;
+
+	return STOPDEPTH * (s->duration - t) / (s->duration - s->departure);
+}
+
+static void
+synthetic_init (synthetic_t *s, const dc_synthetic_t *params, unsigned int interval, unsigned int maxtanks)
+{
+	memset (s, 0, sizeof (*s));
+
+	s->state = params->seed ? params->seed : 0x2545F491;
+	s->duration = params->duration;
+	s->interval = interval;
+	s->nsamples = params->duration / interval;
+	s->ntanks = params->ntanks < maxtanks ? params->ntanks : maxtanks;
+	s->maxdepth = params->maxdepth;
+	s->probability = params->events * interval / 3600.0;
+
+	// The phases of the dive, shortened proportionally when the dive is
+	// too short for the descent and the ascent.
+	double descent = s->maxdepth / DESCENT * 60.0;
+	double ascent = (s->maxdepth - STOPDEPTH) / ASCENT * 60.0;
+	double stop = STOPTIME;
+	double surface = STOPDEPTH / ASCENT * 60.0;
+	if (s->maxdepth <= STOPDEPTH) {
+		ascent = s->maxdepth / ASCENT * 60.0;
+		stop = surface = 0.0;
+	}
+	double total = descent + ascent + stop + surface;
+	double scale = total > s->duration ? s->duration / total : 1.0;
+	s->descent = descent * scale;
+	s->ascent = s->duration - (ascent + stop + surface) * scale;
+	s->arrival = s->ascent + ascent * scale;
+	s->departure = s->arrival + stop * scale;
+
+	for (unsigned int i = 0; i < s->ntanks; ++i) {
+		s->pressure[i] = s->beginpressure[i] = FILL + floor (synthetic_uniform (s) * 30.0);
+	}
+
+	s->coldest = s->warmest = SURFACE;
+}
+
+static int
+synthetic_next (synthetic_t *s)
+{
+	if (s->index >= s->nsamples)
+		return 0;
+
+	s->index++;
+	s->time = s->index * s->interval;
+
+	// Depth.
+	double depth = synthetic_profile (s, s->time);
+	if (depth > 0.5) {
+		depth += (synthetic_uniform (s) - 0.5) * 2.0 * NOISE;
+	}
+	if (depth < 0.0)
+		depth = 0.0;
+
+	// Water temperature, with a thermocline down to 30 meters.
+	double temperature = SURFACE - (SURFACE - BOTTOM) * (depth < 30.0 ? depth : 30.0) / 30.0;
+
+	// The tanks are used one after the other.
+	unsigned int tank = 0;
+	if (s->ntanks) {
+		tank = (unsigned long long) s->time * s->ntanks / (s->duration + 1);
+		double consumption = SAC * (1.0 + (s->depth + depth) / 20.0) / VOLUME * s->interval / 60.0;
+		if (s->pressure[tank] - consumption > RESERVE) {
+			s->pressure[tank] -= consumption;
+		}
+	}
+	s->gaschange = s->index > 1 && tank != s->tank;
+	s->tank = tank;
+
+	// Bookmark.
+	s->event = synthetic_uniform (s) < s->probability;
+	if (s->event)
+		s->nevents++;
+
+	// Totals.
+	if (s->deepest < depth)
+		s->deepest = depth;
+	if (s->coldest > temperature)
+		s->coldest = temperature;
+	if (s->warmest < temperature)
+		s->warmest = temperature;
+	s->depthtime += (s->depth + depth) / 2.0 * s->interval;
+
+	s->depth = depth;
+	s->temperature = temperature;
+
+	return 1;
+}
+
+static unsigned int
+synthetic_round (double value, unsigned int max)
+{
+	if (value <= 0.0)
+		return 0;
+	if (value >= max)
+		return max;
+	return (unsigned int) (value + 0.5);
+}
+
+static double
+synthetic_ambient (const synthetic_t *s)
+{
+	return ATMOSPHERIC / 1000.0 + s->depth * DENSITY * GRAVITY / BAR;
+}
+
+/*
+ * Shearwater
+ *
+ * The Predator stores a 128 byte opening block, the samples (16 bytes)
+ * and a 128 byte closing block. The Petrel Native Format (PNF) consists
+ * of 32 byte records, with the record type in the first byte. The
+ * sample layout is identical, but shifted by one byte.
+ */
+
+static unsigned int
+synthetic_shearwater_pressure (const synthetic_t *s, unsigned int tank)
+{
+	if (tank >= s->ntanks)
+		return 0xFFFF;
+
+	// Units of 2 psi.
+	return synthetic_round (s->pressure[tank] * BAR / PSI / 2.0, 0x0FFF);
+}
+
+static void
+synthetic_shearwater_sample (const synthetic_t *s, unsigned char data[], unsigned int pnf)
+{
+	unsigned int o2 = oxygen[s->tank];
+	array_uint16_be_set (data + pnf + 0, synthetic_round (s->depth * 10.0, 0xFFFF));
+	data[pnf + 6] = synthetic_round (o2 * synthetic_ambient (s), 0xFF);
+	data[pnf + 7] = o2;
+	data[pnf + 9] = 99;
+	data[pnf + 11] = SW_OC;
+	data[pnf + 13] = (signed char) floor (s->temperature + 0.5);
+	if (pnf) {
+		array_uint16_be_set (data + pnf + 19, synthetic_shearwater_pressure (s, 1));
+		data[pnf + 21] = s->ntanks ? 0xFD : 0xFF;
+		array_uint16_be_set (data + pnf + 27, synthetic_shearwater_pressure (s, 0));
+	}
+}
+
+static dc_status_t
+synthetic_shearwater_predator (synthetic_t *s, dc_buffer_t *buffer)
+{
+	unsigned char opening[SW_SZ_BLOCK] = {0};
+	opening[0] = opening[1] = 0xFF;
+	opening[4] = GFLOW;
+	opening[5] = GFHIGH;
+	array_uint32_be_set (opening + 12, TIMESTAMP);
+	opening[20] = oxygen[0];
+	array_uint16_be_set (opening + 47, ATMOSPHERIC);
+	array_uint16_be_set (opening + 83, DENSITY);
+	opening[127] = 6;
+	if (!dc_buffer_append (buffer, opening, sizeof (opening)))
+		return DC_STATUS_NOMEMORY;
+
+	while (synthetic_next (s)) {
+		unsigned char sample[SW_SZ_SAMPLE] = {0};
+		synthetic_shearwater_sample (s, sample, 0);
+		if (!dc_buffer_append (buffer, sample, sizeof (sample)))
+			return DC_STATUS_NOMEMORY;
+	}
+
+	unsigned char closing[SW_SZ_BLOCK] = {0};
+	closing[0] = 0xFF;
+	closing[1] = 0xFE;
+	array_uint16_be_set (closing + 4, synthetic_round (s->deepest, 0xFFFF));
+	array_uint16_be_set (closing + 6, synthetic_round (s->time / 60.0, 0xFFFF));
+	if (!dc_buffer_append (buffer, closing, sizeof (closing)))
+		return DC_STATUS_NOMEMORY;
+
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+synthetic_shearwater_petrel (synthetic_t *s, dc_buffer_t *buffer)
+{
+	unsigned char opening[8][SW_SZ_RECORD] = {{0}};
+	for (unsigned int i = 0; i < 8; ++i) {
+		opening[i][0] = 0x10 + i;
+	}
+
+	unsigned int ngases = s->ntanks ? s->ntanks : 1;
+
+	opening[0][4] = GFLOW;
+	opening[0][5] = GFHIGH;
+	array_uint32_be_set (opening[0] + 12, TIMESTAMP);
+	for (unsigned int i = 0; i < ngases; ++i) {
+		opening[0][20 + i] = oxygen[i];
+	}
+	array_uint16_be_set (opening[1] + 16, ATMOSPHERIC);
+	array_uint16_be_set (opening[3] + 3, DENSITY);
+	opening[4][1] = SW_OC_TEC;
+	opening[4][16] = SW_LOGVERSION;
+	array_uint16_be_set (opening[4] + 17, (1 << ngases) - 1);
+	opening[4][28] = s->ntanks ? SW_AI_ON : SW_AI_OFF;
+	array_uint16_be_set (opening[5] + 23, s->interval * 1000);
+	opening[6][19] = s->ntanks > 0;
+	opening[6][22] = s->ntanks > 1;
+	opening[7][1]  = s->ntanks > 2;
+	opening[7][11] = s->ntanks > 3;
+	if (!dc_buffer_append (buffer, opening[0], sizeof (opening)))
+		return DC_STATUS_NOMEMORY;
+
+	while (synthetic_next (s)) {
+		unsigned char sample[SW_SZ_RECORD] = {0};
+		sample[0] = 0x01;
+		synthetic_shearwater_sample (s, sample, 1);
+		if (!dc_buffer_append (buffer, sample, sizeof (sample)))
+			return DC_STATUS_NOMEMORY;
+
+		if (s->ntanks > 2) {
+			unsigned char extended[SW_SZ_RECORD] = {0};
+			extended[0] = 0xE1;
+			array_uint16_be_set (extended + 1, synthetic_shearwater_pressure (s, 2));
+			array_uint16_be_set (extended + 3, synthetic_shearwater_pressure (s, 3));
+			if (!dc_buffer_append (buffer, extended, sizeof (extended)))
+				return DC_STATUS_NOMEMORY;
+		}
+
+		if (s->event) {
+			unsigned char info[SW_SZ_RECORD] = {0};
+			info[0] = 0x30;
+			info[1] = 38; // Tag log
+			array_uint32_be_set (info + 4, TIMESTAMP + s->time);
+			array_uint32_be_set (info + 8, 0xFFFFFFFF);
+			array_uint32_be_set (info + 12, s->nevents);
+			if (!dc_buffer_append (buffer, info, sizeof (info)))
+				return DC_STATUS_NOMEMORY;
+		}
+	}
+
+	unsigned char closing[8][SW_SZ_RECORD] = {{0}};
+	for (unsigned int i = 0; i < 8; ++i) {
+		closing[i][0] = 0x20 + i;
+	}
+	array_uint16_be_set (closing[0] + 4, synthetic_round (s->deepest * 10.0, 0xFFFF));
+	array_uint24_be_set (closing[0] + 6, s->time);
+	if (!dc_buffer_append (buffer, closing[0], sizeof (closing)))
+		return DC_STATUS_NOMEMORY;
+
+	unsigned char final[SW_SZ_RECORD] = {0};
+	final[0] = 0xFF;
+	final[13] = SW_PETREL;
+	if (!dc_buffer_append (buffer, final, sizeof (final)))
+		return DC_STATUS_NOMEMORY;
+
+	return DC_STATUS_SUCCESS;
+}
+
+/*
+ * The dive computer XORs every byte with the byte 32 positions earlier,
+ * and compresses the result into a stream of 9 bit values: a byte with
+ * the 9th bit set, or a run of (up to 255) zero bytes. A zero value ends
+ * the stream, which is padded to a multiple of 9 bytes.
+ */
+
+typedef struct synthetic_bitstream_t {
+	dc_buffer_t *buffer;
+	unsigned int value;
+	unsigned int nbits;
+	unsigned int size;
+} synthetic_bitstream_t;
+
+static int
+synthetic_bitstream_write (synthetic_bitstream_t *stream, unsigned int value)
+{
+	stream->value = (stream->value << 9) | value;
+	stream->nbits += 9;
+	while (stream->nbits >= 8) {
+		unsigned char byte = (stream->value >> (stream->nbits - 8)) & 0xFF;
+		if (!dc_buffer_append (stream->buffer, &byte, 1))
+			return 0;
+		stream->nbits -= 8;
+		stream->size++;
+	}
+	stream->value &= (1 << stream->nbits) - 1;
+
+	return 1;
+}
+
+static dc_status_t
+synthetic_shearwater_lre (synthetic_t *s, dc_buffer_t *buffer)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+
+	dc_buffer_t *raw = dc_buffer_new (0);
+	if (raw == NULL)
+		return DC_STATUS_NOMEMORY;
+
+	status = synthetic_shearwater_petrel (s, raw);
+	if (status != DC_STATUS_SUCCESS)
+		goto error_free;
+
+	unsigned char *data = dc_buffer_get_data (raw);
+	size_t size = dc_buffer_get_size (raw);
+
+	// In reverse order, to XOR with the original bytes.
+	for (size_t i = size; i-- > 32; ) {
+		data[i] ^= data[i - 32];
+	}
+
+	synthetic_bitstream_t stream = {buffer, 0, 0, 0};
+	size_t i = 0;
+	while (i < size) {
+		unsigned int value = 0;
+		if (data[i]) {
+			value = 0x100 | data[i];
+			i++;
+		} else {
+			while (i < size && data[i] == 0 && value < 0xFF) {
+				value++;
+				i++;
+			}
+		}
+		if (!synthetic_bitstream_write (&stream, value)) {
+			status = DC_STATUS_NOMEMORY;
+			goto error_free;
+		}
+	}
+
+	// End of stream, and padding.
+	do {
+		if (!synthetic_bitstream_write (&stream, 0)) {
+			status = DC_STATUS_NOMEMORY;
+			goto error_free;
+		}
+	} while (stream.nbits != 0 || stream.size % 9 != 0);
+
+error_free:
+	dc_buffer_free (raw);
+	return status;
+}
+
+/*
+ * Heinrichs Weikamp
+ *
+ * The hwOS dives have a 256 byte header, followed by the profile. Each
+ * sample contains the depth, an optional event byte, and the extended
+ * sample data configured in the profile header.
+ */
+
+static dc_status_t
+synthetic_hw_ostc3 (synthetic_t *s, dc_buffer_t *buffer)
+{
+	unsigned int ngases = s->ntanks ? s->ntanks : 1;
+
+	unsigned char header[OSTC3_SZ_HEADER] = {0};
+	header[0] = header[1] = 0xFA;
+	header[8] = 0x24;
+	header[12] = 24; // 2024-06-01 10:00
+	header[13] = 6;
+	header[14] = 1;
+	header[15] = 10;
+	header[16] = 0;
+	array_uint16_le_set (header + 24, ATMOSPHERIC);
+	for (unsigned int i = 0; i < ngases; ++i) {
+		header[28 + 4 * i + 0] = oxygen[i];
+		header[28 + 4 * i + 3] = i == 0 ? 1 : 2;
+	}
+	array_uint16_be_set (header + 48, 0x030A); // Firmware v3.10
+	header[70] = 2; // 1020 kg/m³
+	header[77] = GFLOW;
+	header[78] = GFHIGH;
+	header[79] = 1; // ZHL-16 GF
+	header[254] = header[255] = 0xFB;
+	if (!dc_buffer_append (buffer, header, sizeof (header)))
+		return DC_STATUS_NOMEMORY;
+
+	const unsigned char config[][3] = {
+		{OSTC3_TEMPERATURE, 2, 6},
+		{OSTC3_DECO,        2, 6},
+		{OSTC3_TANK,        2, 1},
+	};
+	unsigned int nconfig = s->ntanks ? 3 : 2;
+
+	unsigned char profile[5] = {0};
+	profile[3] = s->interval;
+	profile[4] = nconfig;
+	if (!dc_buffer_append (buffer, profile, sizeof (profile)) ||
+		!dc_buffer_append (buffer, config[0], 3 * nconfig))
+		return DC_STATUS_NOMEMORY;
+
+	while (synthetic_next (s)) {
+		unsigned char sample[16] = {0};
+		unsigned int length = 0;
+
+		array_uint16_le_set (sample, synthetic_round (s->depth * 100.0, 0xFFFF));
+
+		unsigned char *extended = sample + 3;
+		if (s->event || s->gaschange) {
+			extended[length++] = (s->event ? 0x06 : 0x00) | (s->gaschange ? 0x20 : 0x00);
+			if (s->gaschange) {
+				extended[length++] = s->tank + 1;
+			}
+		}
+
+		for (unsigned int i = 0; i < nconfig; ++i) {
+			if (s->index % config[i][2] != 0)
+				continue;
+
+			switch (config[i][0]) {
+			case OSTC3_TEMPERATURE:
+				array_uint16_le_set (extended + length, synthetic_round (s->temperature * 10.0, 0xFFFF));
+				break;
+			case OSTC3_DECO:
+				extended[length + 0] = 0;
+				extended[length + 1] = 99;
+				break;
+			case OSTC3_TANK:
+				array_uint16_le_set (extended + length, synthetic_round (s->pressure[s->tank], 0xFFFF));
+				break;
+			}
+			length += config[i][1];
+		}
+
+		sample[2] = length | (s->event || s->gaschange ? 0x80 : 0x00);
+		if (!dc_buffer_append (buffer, sample, 3 + length))
+			return DC_STATUS_NOMEMORY;
+	}
+
+	const unsigned char end[] = {0xFD, 0xFD};
+	if (!dc_buffer_append (buffer, end, sizeof (end)))
+		return DC_STATUS_NOMEMORY;
+
+	// Update the header with the totals.
+	unsigned char *data = dc_buffer_get_data (buffer);
+	unsigned int length = dc_buffer_get_size (buffer) - OSTC3_SZ_HEADER + 3;
+	array_uint24_le_set (data + 9, length);
+	array_uint24_le_set (data + OSTC3_SZ_HEADER, length);
+	array_uint16_le_set (data + 17, synthetic_round (s->deepest * 100.0, 0xFFFF));
+	array_uint16_le_set (data + 19, synthetic_round (s->time / 60, 0xFFFF));
+	data[21] = s->time % 60;
+	array_uint16_le_set (data + 22, (signed short) floor (s->coldest * 10.0 + 0.5));
+	if (s->time) {
+		array_uint16_le_set (data + 73, synthetic_round (s->depthtime / s->time * 100.0, 0xFFFF));
+	}
+	array_uint16_le_set (data + 75, synthetic_round (s->time, 0xFFFF));
+
+	return DC_STATUS_SUCCESS;
+}
+
+/*
+ * Suunto
+ *
+ * The EON Steel stores the dive as an SBEM file: self-describing entries
+ * with a type descriptor (a path and a format), followed by data records
+ * that refer to one of the descriptors. Group descriptors combine several
+ * sample types into a single record.
+ */
+
+enum {
+	ES_TIME = 1,
+	ES_DEPTH,
+	ES_TEMPERATURE,
+	ES_SAMPLE,
+	ES_GASNUMBER,
+	ES_PRESSURE,
+	ES_CYLINDER,
+	ES_GASSWITCH,
+	ES_NOTIFY,
+	ES_NOTIFY_ACTIVE,
+	ES_SURFACEPRESSURE,
+	ES_DIVEMODE,
+	ES_GAS_STATE,
+	ES_GAS_OXYGEN,
+	ES_GAS_HELIUM,
+	ES_GAS_TANKSIZE,
+	ES_GAS_FILLPRESSURE,
+	ES_MAXDEPTH,
+};
+
+static const struct {
+	unsigned int id;
+	const char *text;
+} synthetic_eonsteel_types[] = {
+	{ES_TIME,             "<PTH>sml.DeviceLog.Samples+Sample.Time\n<FRM>duint16,precision=3"},
+	{ES_DEPTH,            "<PTH>sml.DeviceLog.Samples.Sample.Depth\n<FRM>uint16,precision=2,nillable=65535"},
+	{ES_TEMPERATURE,      "<PTH>sml.DeviceLog.Samples.Sample.Temperature\n<FRM>int16,precision=1,nillable=-3000"},
+	{ES_SAMPLE,           "<GRP>1,2,3"},
+	{ES_GASNUMBER,        "<PTH>sml.DeviceLog.Samples.Sample.Cylinders+Cylinder.GasNumber\n<FRM>uint8"},
+	{ES_PRESSURE,         "<PTH>sml.DeviceLog.Samples.Sample.Cylinders.Cylinder.Pressure\n<FRM>uint16,precision=0,nillable=65535"},
+	{ES_CYLINDER,         "<GRP>5,6"},
+	{ES_GASSWITCH,        "<PTH>sml.DeviceLog.Samples.Sample.Events.GasSwitch.GasNumber\n<FRM>uint16"},
+	{ES_NOTIFY,           "<PTH>sml.DeviceLog.Samples.Sample.Events+Notify.Type\n<FRM>enum:0=NoFly Time,1=Depth,2=Surface Time,3=Tissue Level,4=Deco,5=Deco Window,6=Safety Stop Ahead,7=Safety Stop"},
+	{ES_NOTIFY_ACTIVE,    "<PTH>sml.DeviceLog.Samples.Sample.Events.Notify.Active\n<FRM>bool"},
+	{ES_SURFACEPRESSURE,  "<PTH>sml.DeviceLog.Header.Diving.SurfacePressure\n<FRM>uint32"},
+	{ES_DIVEMODE,         "<PTH>sml.DeviceLog.Header.Diving.DiveMode\n<FRM>utf8"},
+	{ES_GAS_STATE,        "<PTH>sml.DeviceLog.Header.Diving.Gases+Gas.State\n<FRM>enum:0=Off,1=Primary,3=Diluent,4=Oxygen"},
+	{ES_GAS_OXYGEN,       "<PTH>sml.DeviceLog.Header.Diving.Gases.Gas.Oxygen\n<FRM>uint8,precision=2"},
+	{ES_GAS_HELIUM,       "<PTH>sml.DeviceLog.Header.Diving.Gases.Gas.Helium\n<FRM>uint8,precision=2"},
+	{ES_GAS_TANKSIZE,     "<PTH>sml.DeviceLog.Header.Diving.Gases.Gas.TankSize\n<FRM>float32,precision=5"},
+	{ES_GAS_FILLPRESSURE, "<PTH>sml.DeviceLog.Header.Diving.Gases.Gas.TankFillPressure\n<FRM>float32,precision=0"},
+	{ES_MAXDEPTH,         "<PTH>sml.DeviceLog.Header.Depth.Max\n<FRM>float32,precision=2"},
+};
+
+static int
+synthetic_eonsteel_record (dc_buffer_t *buffer, unsigned int type, const unsigned char data[], unsigned int size)
+{
+	unsigned char header[2] = {type, size};
+	return dc_buffer_append (buffer, header, sizeof (header)) &&
+		dc_buffer_append (buffer, data, size);
+}
+
+static int
+synthetic_eonsteel_float (dc_buffer_t *buffer, unsigned int type, float value)
+{
+	union {
+		unsigned int val;
+		float value;
+	} u;
+
+	unsigned char data[4];
+	u.value = value;
+	array_uint32_le_set (data, u.val);
+	return synthetic_eonsteel_record (buffer, type, data, sizeof (data));
+}
+
+static dc_status_t
+synthetic_suunto_eonsteel (synthetic_t *s, dc_buffer_t *buffer)
+{
+	unsigned char header[12] = {0};
+	array_uint32_le_set (header, TIMESTAMP);
+	memcpy (header + 4, "SBEM", 4);
+	if (!dc_buffer_append (buffer, header, sizeof (header)))
+		return DC_STATUS_NOMEMORY;
+
+	// Type descriptors. The data records follow the last descriptor.
+	for (unsigned int i = 0; i < C_ARRAY_SIZE (synthetic_eonsteel_types); ++i) {
+		unsigned int length = strlen (synthetic_eonsteel_types[i].text) + 1;
+		unsigned char entry[4] = {0, 2 + length};
+		array_uint16_le_set (entry + 2, synthetic_eonsteel_types[i].id);
+		if (!dc_buffer_append (buffer, entry, sizeof (entry)) ||
+			!dc_buffer_append (buffer, (const unsigned char *) synthetic_eonsteel_types[i].text, length))
+			return DC_STATUS_NOMEMORY;
+	}
+
+	unsigned int notify = 0;
+	while (synthetic_next (s)) {
+		unsigned char sample[6];
+		array_uint16_le_set (sample + 0, s->interval * 1000);
+		array_uint16_le_set (sample + 2, synthetic_round (s->depth * 100.0, 0xFFFE));
+		array_uint16_le_set (sample + 4, (signed short) floor (s->temperature * 10.0 + 0.5));
+		if (!synthetic_eonsteel_record (buffer, ES_SAMPLE, sample, sizeof (sample)))
+			return DC_STATUS_NOMEMORY;
+
+		for (unsigned int i = 0; i < s->ntanks; ++i) {
+			unsigned char cylinder[3];
+			cylinder[0] = i + 1;
+			array_uint16_le_set (cylinder + 1, synthetic_round (s->pressure[i] * 100.0, 0xFFFE));
+			if (!synthetic_eonsteel_record (buffer, ES_CYLINDER, cylinder, sizeof (cylinder)))
+				return DC_STATUS_NOMEMORY;
+		}
+
+		if (s->gaschange) {
+			unsigned char gasswitch[2];
+			array_uint16_le_set (gasswitch, s->tank + 1);
+			if (!synthetic_eonsteel_record (buffer, ES_GASSWITCH, gasswitch, sizeof (gasswitch)))
+				return DC_STATUS_NOMEMORY;
+		}
+
+		// The notification ends at the next sample. The type and state are
+		// separate records, because the enumeration values are only known
+		// to the type descriptor.
+		if (s->event || notify) {
+			const unsigned char type = 7; // Safety Stop
+			const unsigned char active = s->event;
+			if (!synthetic_eonsteel_record (buffer, ES_NOTIFY, &type, 1) ||
+				!synthetic_eonsteel_record (buffer, ES_NOTIFY_ACTIVE, &active, 1))
+				return DC_STATUS_NOMEMORY;
+			notify = s->event;
+		}
+	}
+
+	// Header fields.
+	unsigned char value[4];
+	array_uint32_le_set (value, ATMOSPHERIC * 100);
+	if (!synthetic_eonsteel_record (buffer, ES_SURFACEPRESSURE, value, 4) ||
+		!synthetic_eonsteel_record (buffer, ES_DIVEMODE, (const unsigned char *) "Air", 4))
+		return DC_STATUS_NOMEMORY;
+
+	unsigned int ngases = s->ntanks ? s->ntanks : 1;
+	for (unsigned int i = 0; i < ngases; ++i) {
+		const unsigned char state = 1, helium = 0;
+		const unsigned char o2 = oxygen[i];
+		if (!synthetic_eonsteel_record (buffer, ES_GAS_STATE, &state, 1) ||
+			!synthetic_eonsteel_record (buffer, ES_GAS_OXYGEN, &o2, 1) ||
+			!synthetic_eonsteel_record (buffer, ES_GAS_HELIUM, &helium, 1))
+			return DC_STATUS_NOMEMORY;
+		if (i < s->ntanks) {
+			if (!synthetic_eonsteel_float (buffer, ES_GAS_TANKSIZE, VOLUME) ||
+				!synthetic_eonsteel_float (buffer, ES_GAS_FILLPRESSURE, s->beginpressure[i]))
+				return DC_STATUS_NOMEMORY;
+		}
+	}
+
+	if (!synthetic_eonsteel_float (buffer, ES_MAXDEPTH, s->deepest))
+		return DC_STATUS_NOMEMORY;
+
+	return DC_STATUS_SUCCESS;
+}
+
+/*
+ * Uwatec
+ *
+ * The Galileo samples are a bitstream, where the leading bits of each
+ * sample identify the type, and the remaining bits contain either an
+ * absolute value or a delta. Every depth sample completes a sample, at
+ * a fixed 4 second interval. The first depth is the surface pressure,
+ * which is used as the reference for all other depths.
+ */
+
+static int
+synthetic_uwatec_absolute (dc_buffer_t *buffer, unsigned int type, unsigned int value)
+{
+	const unsigned char data[3] = {type, (value >> 8) & 0xFF, value & 0xFF};
+	return dc_buffer_append (buffer, data, sizeof (data));
+}
+
+static int
+synthetic_uwatec_delta (dc_buffer_t *buffer, unsigned int type, unsigned int mask, int delta)
+{
+	const unsigned char data = type | (delta & mask);
+	return dc_buffer_append (buffer, &data, 1);
+}
+
+static dc_status_t
+synthetic_uwatec_galileo (synthetic_t *s, dc_buffer_t *buffer)
+{
+	unsigned int ngases = s->ntanks ? s->ntanks : 1;
+
+	unsigned char header[GALILEO_SZ_HEADER] = {0};
+	header[0] = header[1] = 0xA5;
+	header[2] = header[3] = 0x5A;
+	array_uint32_le_set (header + 8, (TIMESTAMP - EPOCH2000) * 2);
+	for (unsigned int i = 0; i < ngases; ++i) {
+		array_uint16_le_set (header + 44 + 2 * i, oxygen[i]);
+	}
+	array_uint16_le_set (header + 32, synthetic_round (SURFACE * 10.0, 0xFFFF));
+	array_uint32_le_set (header + 92, GALILEO_SALINITY);
+	if (!dc_buffer_append (buffer, header, sizeof (header)))
+		return DC_STATUS_NOMEMORY;
+
+	// Depth in units of 2 mbar, relative to the surface pressure.
+	const unsigned int calibration = ATMOSPHERIC / 2;
+	const double scale = DENSITY * 10.0 / (2.0 * BAR / 1000.0);
+
+	// The first sample, at the surface.
+	int temperature = synthetic_round (SURFACE * 2.5, 0x7FFF);
+	unsigned int pressure = synthetic_round (s->pressure[0] * 4.0, 0xFFFF);
+	unsigned int depth = calibration;
+	unsigned int bookmark = 0;
+	if (!synthetic_uwatec_absolute (buffer, 0xF3, temperature) ||
+		(s->ntanks && !synthetic_uwatec_absolute (buffer, 0xF4, pressure)) ||
+		!synthetic_uwatec_absolute (buffer, 0xF1, depth))
+		return DC_STATUS_NOMEMORY;
+
+	while (synthetic_next (s)) {
+		int ok = 1;
+
+		if (s->ntanks) {
+			unsigned int value = synthetic_round (s->pressure[s->tank] * 4.0, 0xFFFF);
+			int delta = (int) value - (int) pressure;
+			if (s->gaschange || delta < -8 || delta > 7) {
+				ok &= synthetic_uwatec_absolute (buffer, 0xF4 + s->tank, value);
+			} else if (delta) {
+				ok &= synthetic_uwatec_delta (buffer, 0xA0, 0x0F, delta);
+			}
+			pressure = value;
+		}
+
+		int value = (int) floor (s->temperature * 2.5 + 0.5);
+		int delta = value - temperature;
+		if (delta < -8 || delta > 7) {
+			ok &= synthetic_uwatec_absolute (buffer, 0xF3, value & 0xFFFF);
+		} else if (delta) {
+			ok &= synthetic_uwatec_delta (buffer, 0xB0, 0x0F, delta);
+		}
+		temperature = value;
+
+		// The bookmark remains active until it's cleared again.
+		if (s->event != bookmark) {
+			ok &= synthetic_uwatec_delta (buffer, 0xE0, 0x0F, s->event ? 0x08 : 0x00);
+			bookmark = s->event;
+		}
+
+		unsigned int current = calibration + synthetic_round (s->depth * scale, 0xFFFF - calibration);
+		delta = (int) current - (int) depth;
+		if (delta < -64 || delta > 63) {
+			ok &= synthetic_uwatec_absolute (buffer, 0xF1, current);
+		} else {
+			ok &= synthetic_uwatec_delta (buffer, 0x00, 0x7F, delta);
+		}
+		depth = current;
+
+		if (!ok)
+			return DC_STATUS_NOMEMORY;
+	}
+
+	// Update the header with the totals.
+	unsigned char *data = dc_buffer_get_data (buffer);
+	array_uint32_le_set (data + 4, dc_buffer_get_size (buffer));
+	array_uint16_le_set (data + 22, synthetic_round (s->deepest * DENSITY / 10.0, 0xFFFF));
+	array_uint16_le_set (data + 26, synthetic_round ((s->time + 59) / 60, 0xFFFF));
+	array_uint16_le_set (data + 28, (signed short) floor (s->warmest * 10.0 + 0.5));
+	array_uint16_le_set (data + 30, (signed short) floor (s->coldest * 10.0 + 0.5));
+	for (unsigned int i = 0; i < s->ntanks; ++i) {
+		array_uint16_le_set (data + 50 + 2 * i, synthetic_round (s->pressure[i] * 128.0, 0xFFFE));
+		array_uint16_le_set (data + 50 + 2 * (i + GALILEO_NTANKS), synthetic_round (s->beginpressure[i] * 128.0, 0xFFFE));
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+dc_synthetic_get_family (dc_synthetic_format_t format, dc_family_t *family, unsigned int *model)
+{
+	dc_family_t f = DC_FAMILY_NULL;
+	unsigned int m = 0;
+
+	switch (format) {
+	case DC_SYNTHETIC_SHEARWATER_PREDATOR:
+		f = DC_FAMILY_SHEARWATER_PREDATOR;
+		m = SW_PREDATOR;
+		break;
+	case DC_SYNTHETIC_SHEARWATER_PETREL:
+	case DC_SYNTHETIC_SHEARWATER_LRE:
+		f = DC_FAMILY_SHEARWATER_PETREL;
+		m = SW_PETREL;
+		break;
+	case DC_SYNTHETIC_HW_OSTC3:
+		f = DC_FAMILY_HW_OSTC3;
+		m = OSTC3;
+		break;
+	case DC_SYNTHETIC_SUUNTO_EONSTEEL:
+		f = DC_FAMILY_SUUNTO_EONSTEEL;
+		m = EONSTEEL;
+		break;
+	case DC_SYNTHETIC_UWATEC_GALILEO:
+		f = DC_FAMILY_UWATEC_SMART;
+		m = GALILEO;
+		break;
+	default:
+		return DC_STATUS_INVALIDARGS;
+	}
+
+	if (family)
+		*family = f;
+	if (model)
+		*model = m;
+
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+dc_synthetic_generate (dc_context_t *context, dc_synthetic_format_t format, const dc_synthetic_t *params, dc_buffer_t *buffer)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	synthetic_t s;
+
+	if (params == NULL || buffer == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	if (params->duration == 0 || params->interval == 0 || params->interval > 60 ||
+		params->maxdepth <= 0.0 || params->maxdepth > 250.0 || params->events < 0.0) {
+		ERROR (context, "Invalid synthetic dive parameters.");
+		return DC_STATUS_INVALIDARGS;
+	}
+
+	dc_buffer_clear (buffer);
+
+	switch (format) {
+	case DC_SYNTHETIC_SHEARWATER_PREDATOR:
+		synthetic_init (&s, params, 10, 0);
+		status = synthetic_shearwater_predator (&s, buffer);
+		break;
+	case DC_SYNTHETIC_SHEARWATER_PETREL:
+		synthetic_init (&s, params, params->interval, 4);
+		status = synthetic_shearwater_petrel (&s, buffer);
+		break;
+	case DC_SYNTHETIC_SHEARWATER_LRE:
+		synthetic_init (&s, params, params->interval, 4);
+		status = synthetic_shearwater_lre (&s, buffer);
+		break;
+	case DC_SYNTHETIC_HW_OSTC3:
+		synthetic_init (&s, params, params->interval, 5);
+		status = synthetic_hw_ostc3 (&s, buffer);
+		break;
+	case DC_SYNTHETIC_SUUNTO_EONSTEEL:
+		synthetic_init (&s, params, params->interval, MAXTANKS);
+		status = synthetic_suunto_eonsteel (&s, buffer);
+		break;
+	case DC_SYNTHETIC_UWATEC_GALILEO:
+		synthetic_init (&s, params, GALILEO_INTERVAL, GALILEO_NTANKS);
+		status = synthetic_uwatec_galileo (&s, buffer);
+		break;
+	default:
+		return DC_STATUS_INVALIDARGS;
+	}
+
+	if (status != DC_STATUS_SUCCESS) {
+		ERROR (context, "Failed to allocate memory.");
+		dc_buffer_clear (buffer);
+	}
+
+	return status;
+}
+
+dc_status_t
+dc_synthetic_decompress (dc_context_t *context, dc_synthetic_format_t format, const unsigned char data[], unsigned int size, dc_buffer_t *buffer)
+{
+	if (data == NULL || buffer == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	switch (format) {
+	case DC_SYNTHETIC_SHEARWATER_LRE:
+		return shearwater_common_decompress (context, data, size, buffer);
+	case DC_SYNTHETIC_SHEARWATER_PREDATOR:
+	case DC_SYNTHETIC_SHEARWATER_PETREL:
+	case DC_SYNTHETIC_HW_OSTC3:
+	case DC_SYNTHETIC_SUUNTO_EONSTEEL:
+	case DC_SYNTHETIC_UWATEC_GALILEO:
+		break;
+	default:
+		return DC_STATUS_INVALIDARGS;
+	}
+
+	dc_buffer_clear (buffer);
+	if (!dc_buffer_append (buffer, data, size)) {
+		ERROR (context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	return DC_STATUS_SUCCESS;
+}
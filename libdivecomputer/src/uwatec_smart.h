@@ -37,6 +37,9 @@ uwatec_smart_device_open (dc_device_t **device, dc_context_t *context, dc_iostre
 dc_status_t
 uwatec_smart_parser_create (dc_parser_t **parser, dc_context_t *context, const unsigned char data[], size_t size, unsigned int model);
 
+dc_status_t
+uwatec_smart_extract_dives (dc_device_t *device, const unsigned char data[], unsigned int size, dc_dive_callback_t callback, void *userdata);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */